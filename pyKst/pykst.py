@@ -85,6 +85,11 @@ class Client:
   def unsetPaused(self):
     """ Equivalent to unchecking "Range>Pause" from the menubar inside kst if "Range>Pause" is checked, otherwise no action. """
     self.send("unsetPaused()")
+  def getUpdateProfile(self):
+    """ Returns where the time went in the last few updates, one line per object which took a noticeable time:
+    update serial, stage (update, datasource or paint), name, type and microseconds.  Each update starts with a 'cycle'
+    line giving the number of deferred loops and the total time, and ends with a 'quick' line totalling the rest. """
+    return self.send("getUpdateProfile()")
   def tabCount(self):
     """ Get the number of tabs open in the current document. """
     return self.send("tabCount()")
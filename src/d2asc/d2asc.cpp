@@ -17,6 +17,7 @@
 
 #include <stdlib.h> // atoi
 #include <qsettings.h>
+#include <QVector>
 
 #include "datavector.h"
 #include "datacollection.h"
@@ -123,15 +124,25 @@ int main(int argc, char *argv[]) {
       NS = vlist.at(i)->length();
   }
 
-  for (i_S = 0; i_S < NS; i_S++) {
+  /* a block of rows at a time, each field's in one go */
+  const int blockSize = 512;
+  QVector<double> block(n_field * blockSize);
+  QVector<const double*> samples(n_field);
+  for (int from = 0; from < NS; from += blockSize) {
+    const int n = qMin(blockSize, NS - from);
     for (i = 0; i < n_field; i++) {
-      if (do_hex[i]) {
-        printf("%4x ",  (int)vlist.at(i)->interpolate(i_S, NS));
-      } else {
-        printf("%.16g ", vlist.at(i)->interpolate(i_S, NS));
+      samples[i] = vlist.at(i)->interpolated(from, n, NS, block.data() + i*blockSize);
+    }
+    for (i_S = 0; i_S < n; i_S++) {
+      for (i = 0; i < n_field; i++) {
+        if (do_hex[i]) {
+          printf("%4x ",  (int)samples.at(i)[i_S]);
+        } else {
+          printf("%.16g ", samples.at(i)[i_S]);
+        }
       }
+      printf("\n");
     }
-    printf("\n");
   }
   return 0;
 }
@@ -62,13 +62,16 @@ const DataVector::DataInfo DataInterfaceAsciiVector::dataInfo(const QString &fie
   if (!ascii._fieldList.contains(field))
     return DataVector::DataInfo();
 
-  return DataVector::DataInfo(ascii._reader.numberOfFrames(), 1);
+  return DataVector::DataInfo(ascii._reader.numberOfFrames(), 1, true);
 }
 
 
 //-------------------------------------------------------------------------------------------
 int DataInterfaceAsciiVector::read(const QString& field, DataVector::ReadInfo& p)
 {
+  if (p.skipFrame > 1) {
+    return ascii.readFieldSkip(p.data, field, p.startingFrame, p.numberOfFrames, p.skipFrame);
+  }
   return ascii.readField(p.data, field, p.startingFrame, p.numberOfFrames);
 }
 
@@ -194,15 +194,20 @@ bool AsciiDataReader::findDataRows(const Buffer& buffer, qint64 bufstart, qint64
 }
 
 //-------------------------------------------------------------------------------------------
-int AsciiDataReader::readFieldFromChunk(const AsciiFileData& chunk, int col, double *v, int start, const QString& field)
+int AsciiDataReader::readFieldsFromChunk(const AsciiFileData& chunk, const Columns& columns, int start)
 { 
   Q_ASSERT(chunk.rowBegin() >= start);
-  return readField(chunk, col, v + chunk.rowBegin() - start, field, chunk.rowBegin(), chunk.rowsRead());
+  Columns shifted;
+  for (int k = 0; k < columns.count(); ++k) {
+    shifted.append(columns.cols[k], columns.values[k] + chunk.rowBegin() - start);
+  }
+  return readFields(chunk, shifted, chunk.rowBegin(), chunk.rowsRead());
 }
 
 //-------------------------------------------------------------------------------------------
 int AsciiDataReader::readField(const AsciiFileData& buf, int col, double *v, const QString& field, int s, int n)
 {
+  Q_UNUSED(field)
   if (_config._columnType == AsciiSourceConfig::Fixed) {
     //MeasureTime t("AsciiSource::readField: same width for all columns");
     const LexicalCast& lexc = LexicalCast::instance();
@@ -213,20 +218,36 @@ int AsciiDataReader::readField(const AsciiFileData& buf, int col, double *v, con
       v[i] = lexc.toDouble(_rowIndex[i] + col_start);
     }
     return n;
+  }
+  return readFields(buf, Columns(col, v), s, n);
+}
+
+//-------------------------------------------------------------------------------------------
+// Delimited columns are all picked out of a row in the one pass over it.
+int AsciiDataReader::readFields(const AsciiFileData& buf, const Columns& columns, int s, int n)
+{
+  if (columns.count() == 0) {
+    return 0;
+  } else if (_config._columnType == AsciiSourceConfig::Fixed) {
+    int read = 0;
+    for (int k = 0; k < columns.count(); ++k) {
+      read = readField(buf, columns.cols[k], columns.values[k], QString(), s, n);
+    }
+    return read;
   } else if (_config._columnType == AsciiSourceConfig::Custom) {
     if (_config._columnDelimiter.value().size() == 1) {
       //MeasureTime t("AsciiSource::readField: 1 custom column delimiter");
       const IsCharacter column_del(_config._columnDelimiter.value()[0].toLatin1());
-      return readColumns(v, buf.checkedData(), buf.begin(), buf.bytesRead(), col, s, n, _lineending, column_del);
+      return readColumns(columns, buf.checkedData(), buf.begin(), buf.bytesRead(), s, n, _lineending, column_del);
     } if (_config._columnDelimiter.value().size() > 1) {
       //MeasureTime t(QString("AsciiSource::readField: %1 custom column delimiters").arg(_config._columnDelimiter.value().size()));
       const IsInString column_del(_config._columnDelimiter.value());
-      return readColumns(v, buf.checkedData(), buf.begin(), buf.bytesRead(), col, s, n, _lineending, column_del);
+      return readColumns(columns, buf.checkedData(), buf.begin(), buf.bytesRead(), s, n, _lineending, column_del);
     }
   } else if (_config._columnType == AsciiSourceConfig::Whitespace) {
     //MeasureTime t("AsciiSource::readField: whitespace separated columns");
     const IsWhiteSpace column_del;
-    return readColumns(v, buf.checkedData(), buf.begin(), buf.bytesRead(), col, s, n, _lineending, column_del);
+    return readColumns(columns, buf.checkedData(), buf.begin(), buf.bytesRead(), s, n, _lineending, column_del);
   }
   return 0;
 }
@@ -237,47 +258,47 @@ int AsciiDataReader::readField(const AsciiFileData& buf, int col, double *v, con
 
 //-------------------------------------------------------------------------------------------
 template<class Buffer, typename ColumnDelimiter>
-int AsciiDataReader::readColumns(double* v, const Buffer& buffer, qint64 bufstart, qint64 bufread, int col, int s, int n,
+int AsciiDataReader::readColumns(const Columns& columns, const Buffer& buffer, qint64 bufstart, qint64 bufread, int s, int n,
                                  const LineEndingType& lineending, const ColumnDelimiter& column_del) const
 {
   if (_config._delimiters.value().size() == 0) {
     const NoDelimiter comment_del;
-    return readColumns(v, buffer, bufstart, bufread, col, s, n, lineending, column_del, comment_del);
+    return readColumns(columns, buffer, bufstart, bufread, s, n, lineending, column_del, comment_del);
   } else if (_config._delimiters.value().size() == 1) {
     const IsCharacter comment_del(_config._delimiters.value()[0].toLatin1());
-    return readColumns(v, buffer, bufstart, bufread, col, s, n, lineending, column_del, comment_del);
+    return readColumns(columns, buffer, bufstart, bufread, s, n, lineending, column_del, comment_del);
   } else if (_config._delimiters.value().size() > 1) {
     const IsInString comment_del(_config._delimiters.value());
-    return readColumns(v, buffer, bufstart, bufread, col, s, n, lineending, column_del, comment_del);
+    return readColumns(columns, buffer, bufstart, bufread, s, n, lineending, column_del, comment_del);
   }
   return 0;
 }
 
 //-------------------------------------------------------------------------------------------
 template<class Buffer, typename ColumnDelimiter, typename CommentDelimiter>
-int AsciiDataReader::readColumns(double* v, const Buffer& buffer, qint64 bufstart, qint64 bufread, int col, int s, int n,
+int AsciiDataReader::readColumns(const Columns& columns, const Buffer& buffer, qint64 bufstart, qint64 bufread, int s, int n,
                                  const LineEndingType& lineending, const ColumnDelimiter& column_del, const CommentDelimiter& comment_del) const
 {
   if (_config._columnWidthIsConst) {
     const AlwaysTrue column_withs_const;
     if (lineending.isLF()) {
-      return readColumns(v, buffer, bufstart, bufread, col, s, n, IsLineBreakLF(lineending), column_del, comment_del, column_withs_const);
+      return readColumns(columns, buffer, bufstart, bufread, s, n, IsLineBreakLF(lineending), column_del, comment_del, column_withs_const);
     } else {
-      return readColumns(v, buffer, bufstart, bufread, col, s, n, IsLineBreakCR(lineending), column_del, comment_del, column_withs_const);
+      return readColumns(columns, buffer, bufstart, bufread, s, n, IsLineBreakCR(lineending), column_del, comment_del, column_withs_const);
     }
   } else {
     const AlwaysFalse column_withs_const;
     if (lineending.isLF()) {
-      return readColumns(v, buffer, bufstart, bufread, col, s, n, IsLineBreakLF(lineending), column_del, comment_del, column_withs_const);
+      return readColumns(columns, buffer, bufstart, bufread, s, n, IsLineBreakLF(lineending), column_del, comment_del, column_withs_const);
     } else {
-      return readColumns(v, buffer, bufstart, bufread, col, s, n, IsLineBreakCR(lineending), column_del, comment_del, column_withs_const);
+      return readColumns(columns, buffer, bufstart, bufread, s, n, IsLineBreakCR(lineending), column_del, comment_del, column_withs_const);
     }
   }
 }
 
 //-------------------------------------------------------------------------------------------
 template<class Buffer, typename IsLineBreak, typename ColumnDelimiter, typename CommentDelimiter, typename ColumnWidthsAreConst>
-int AsciiDataReader::readColumns(double* v, const Buffer& buffer, qint64 bufstart, qint64 bufread, int col, int s, int n,
+int AsciiDataReader::readColumns(const Columns& columns, const Buffer& buffer, qint64 bufstart, qint64 bufread, int s, int n,
                                  const IsLineBreak& isLineBreak,
                                  const ColumnDelimiter& column_del, const CommentDelimiter& comment_del,
                                  const ColumnWidthsAreConst& are_column_widths_const) const
@@ -288,27 +309,36 @@ int AsciiDataReader::readColumns(double* v, const Buffer& buffer, qint64 bufstar
 
   bool is_custom = (_config._columnType.value() == AsciiSourceConfig::Custom);
 
+  // the constant width shortcut only holds for a single column
+  const int count = columns.count();
+  const bool single = (count == 1);
   qint64 col_start = -1;
   for (int i = 0; i < n; i++, s++) {
     bool incol = false;
     int i_col = 0;
+    int next = 0; // the column of columns to look for next
 
-    if (are_column_widths_const()) {
+    if (are_column_widths_const() && single) {
       if (col_start != -1) {
-        v[i] = lexc.toDouble(&buffer[0] + _rowIndex[s] + col_start);
+        columns.values[0][i] = lexc.toDouble(&buffer[0] + _rowIndex[s] + col_start);
         continue;
       }
     }
 
-    v[i] = Kst::NOPOINT;
+    for (int k = 0; k < count; ++k) {
+      columns.values[k][i] = Kst::NOPOINT;
+    }
     for (qint64 ch = _rowIndex[s] - bufstart; ch < bufread; ++ch) {
       if (isLineBreak(buffer[ch])) {
         break;
       } else if (column_del(buffer[ch])) { //<- check for column start
         if ((!incol) && is_custom) {
           ++i_col;
-          if (i_col == col) {
-            v[i] = NAN;
+          if (i_col == columns.cols[next]) {
+            columns.values[next][i] = NAN;
+            if (++next == count) {
+              break;
+            }
           }
         }
         incol = false;
@@ -318,14 +348,16 @@ int AsciiDataReader::readColumns(double* v, const Buffer& buffer, qint64 bufstar
         if (!incol) {
           incol = true;
           ++i_col;
-          if (i_col == col) {
-            toDouble(lexc, &buffer[0], bufread, ch, &v[i], i);
-            if (are_column_widths_const()) {
+          if (i_col == columns.cols[next]) {
+            toDouble(lexc, &buffer[0], bufread, ch, &columns.values[next][i], i);
+            if (are_column_widths_const() && single) {
               if (col_start == -1) {
                 col_start = ch - _rowIndex[s];
               }
             }
-            break;
+            if (++next == count) {
+              break;
+            }
           }
         }
       }
@@ -41,8 +41,21 @@ class AsciiDataReader
     void detectLineEndingType(QFile& file);
     
     bool findDataRows(bool read_completely, QFile& file, qint64 _byteLength);
+
+    // The columns one pass over the rows reads, in ascending order, and
+    // where the samples of each go.
+    struct Columns {
+      Columns() {}
+      Columns(int col, double *v) { append(col, v); }
+      void append(int col, double *v) { cols.append(col); values.append(v); }
+      int count() const { return cols.size(); }
+      QVarLengthArray<int, 8> cols;
+      QVarLengthArray<double*, 8> values;
+    };
+
     int readField(const AsciiFileData &buf, int col, double *v, const QString& field, int start, int n);
-    int readFieldFromChunk(const AsciiFileData& chunk, int col, double *v, int start, const QString& field);
+    int readFields(const AsciiFileData &buf, const Columns& columns, int start, int n);
+    int readFieldsFromChunk(const AsciiFileData& chunk, const Columns& columns, int start);
 
     template<typename ColumnDelimiter>
     static int splitColumns(const QByteArray& line, const ColumnDelimiter& column_del, QStringList* cols = 0);
@@ -60,15 +73,15 @@ class AsciiDataReader
     bool resizeBuffer(T& buffer, qint64 bytes);
 
     template<class Buffer, typename ColumnDelimiter>
-    int readColumns(double* v, const Buffer& buffer, qint64 bufstart, qint64 bufread, int col, int s, int n,
+    int readColumns(const Columns& columns, const Buffer& buffer, qint64 bufstart, qint64 bufread, int s, int n,
                     const AsciiCharacterTraits::LineEndingType&, const ColumnDelimiter&) const;
 
     template<class Buffer, typename ColumnDelimiter, typename CommentDelimiter>
-    int readColumns(double* v, const Buffer& buffer, qint64 bufstart, qint64 bufread, int col, int s, int n,
+    int readColumns(const Columns& columns, const Buffer& buffer, qint64 bufstart, qint64 bufread, int s, int n,
                     const AsciiCharacterTraits::LineEndingType&, const ColumnDelimiter&, const CommentDelimiter&) const;
 
     template<class Buffer, typename IsLineBreak, typename ColumnDelimiter, typename CommentDelimiter, typename ColumnWidthsAreConst>
-    int readColumns(double* v, const Buffer& buffer, qint64 bufstart, qint64 bufread, int col, int s, int n,
+    int readColumns(const Columns& columns, const Buffer& buffer, qint64 bufstart, qint64 bufread, int s, int n,
                     const IsLineBreak&, const ColumnDelimiter&, const CommentDelimiter&, const ColumnWidthsAreConst&) const;
 
     template<class Buffer, typename IsLineBreak, typename CommentDelimiter>
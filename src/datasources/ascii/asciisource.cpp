@@ -81,6 +81,7 @@ AsciiSource::AsciiSource(Kst::ObjectStore *store, QSettings *cfg, const QString&
 //-------------------------------------------------------------------------------------------
 AsciiSource::~AsciiSource() 
 {
+  stopReadAhead();
 }
 
 
@@ -101,7 +102,7 @@ void AsciiSource::reset()
   _scalarList.clear();
   _strings.clear();
   
-  Object::reset();
+  Kst::DataSource::reset();
   
   _strings = fileMetas();
 }
@@ -258,6 +259,14 @@ int AsciiSource::readField(double *v, const QString& field, int s, int n)
 
   }
 
+  return reportRead(read, n);
+}
+
+
+//-------------------------------------------------------------------------------------------
+// Warns, once, about a read which fell short.
+int AsciiSource::reportRead(int read, int n)
+{
   QString msg("%1 because not enough memory is available.\nTry setting a file buffer limit in the configuration options.");
   if (read == n) {
     return read;
@@ -280,6 +289,95 @@ int AsciiSource::readField(double *v, const QString& field, int s, int n)
 }
 
 
+//-------------------------------------------------------------------------------------------
+// Rows are a block at a time, keeping every skip'th; rows far apart are read
+// one by one rather than parsing everything between them.
+int AsciiSource::readFieldSkip(double *v, const QString& field, int s, int n, int skip)
+{
+  const int blockRows = 65536;
+
+  if (skip >= blockRows) {
+    int read = 0;
+    for (int i = 0; i < n; i++) {
+      if (readField(v + i, field, s + i*skip, 1) < 1) {
+        break;
+      }
+      read++;
+    }
+    return read;
+  }
+
+  const int perBlock = qMax(blockRows/skip, 1);
+  QVector<double> buffer((perBlock - 1)*skip + 1);
+  int read = 0;
+  while (read < n) {
+    const int count = qMin(perBlock, n - read);
+    const int got = readField(buffer.data(), field, s + read*skip, (count - 1)*skip + 1);
+    const int kept = (got > 0) ? qMin((got - 1)/skip + 1, count) : 0;
+    for (int i = 0; i < kept; i++) {
+      v[read + i] = buffer.at(i*skip);
+    }
+    read += kept;
+    if (kept < count) {
+      break;
+    }
+  }
+  return read;
+}
+
+
+//-------------------------------------------------------------------------------------------
+// Reads of the same rows are parsed together, every row once for all their
+// columns.  INDEX and time fields, which are made up or converted on the
+// way, are read one by one as usual.
+void AsciiSource::readVectors(QList<VectorRead> &reads)
+{
+  QMap<QPair<int, int>, QList<int> > byRows;
+  for (int i = 0; i < reads.count(); i++) {
+    VectorRead &read = reads[i];
+    if (read.field == "INDEX" || isTime(read.field) || columnOfField(read.field) == -1 || read.numberOfFrames < 1) {
+      read.samplesRead = readField(read.data.data(), read.field, read.startingFrame, read.numberOfFrames);
+    } else {
+      byRows[qMakePair(read.startingFrame, read.numberOfFrames)].append(i);
+    }
+  }
+
+  for (QMap<QPair<int, int>, QList<int> >::ConstIterator it = byRows.begin(); it != byRows.end(); ++it) {
+    const int s = it.key().first;
+    const int n = it.key().second;
+
+    // by column, each once: a repeat is copied from the first afterwards
+    QMap<int, int> byColumn;
+    foreach (int i, it.value()) {
+      const int col = columnOfField(reads.at(i).field);
+      if (!byColumn.contains(col)) {
+        byColumn.insert(col, i);
+      }
+    }
+    AsciiDataReader::Columns columns;
+    for (QMap<int, int>::ConstIterator c = byColumn.begin(); c != byColumn.end(); ++c) {
+      columns.append(c.key(), reads[c.value()].data.data());
+    }
+
+    const int read = reportRead(tryReadColumns(columns, QString(), s, n), n);
+    foreach (int i, it.value()) {
+      const int first = byColumn.value(columnOfField(reads.at(i).field));
+      if (first != i) {
+        reads[i].data = reads.at(first).data;
+      }
+      reads[i].samplesRead = read;
+    }
+  }
+}
+
+
+//-------------------------------------------------------------------------------------------
+bool AsciiSource::readsFieldsTogether() const
+{
+  return true;
+}
+
+
 //-------------------------------------------------------------------------------------------
 bool AsciiSource::useThreads() const
 {
@@ -306,7 +404,14 @@ int AsciiSource::tryReadField(double *v, const QString& field, int s, int n)
   if (col == -1) {
     return -2;
   }
-  
+
+  return tryReadColumns(AsciiDataReader::Columns(col, v), field, s, n);
+}
+
+
+//-------------------------------------------------------------------------------------------
+int AsciiSource::tryReadColumns(const AsciiDataReader::Columns& columns, const QString& field, int s, int n)
+{
   // check if the already in buffer
   qint64 begin = _reader.beginOfRow(s);
   qint64 bytesToRead = _reader.beginOfRow(s + n) - begin;
@@ -360,9 +465,9 @@ int AsciiSource::tryReadField(double *v, const QString& field, int s, int n)
 
     int read;
     if (useThreads())
-      read = parseWindowMultithreaded(slidingWindow[i], col, v, s, field);
+      read = parseWindowMultithreaded(slidingWindow[i], columns, s);
     else
-      read = parseWindowSinglethreaded(slidingWindow[i], col, v, s, field, sampleRead);
+      read = parseWindowSinglethreaded(slidingWindow[i], columns, s, sampleRead);
 
     // something went wrong abort reading
     if (read == 0) {
@@ -378,28 +483,28 @@ int AsciiSource::tryReadField(double *v, const QString& field, int s, int n)
 
 
 //-------------------------------------------------------------------------------------------
-int AsciiSource::parseWindowSinglethreaded(QVector<AsciiFileData>& window, int col, double* v, int start, const QString& field, int sRead)
+int AsciiSource::parseWindowSinglethreaded(QVector<AsciiFileData>& window, const AsciiDataReader::Columns& columns, int start, int sRead)
 {
   int read = 0;
   for (int i = 0; i < window.size(); i++) {
     Q_ASSERT(sRead + start ==  window[i].rowBegin());
     if (!window[i].read() || window[i].bytesRead() == 0)
       return 0;
-    read += _reader.readFieldFromChunk(window[i], col, v, start, field);
+    read += _reader.readFieldsFromChunk(window[i], columns, start);
   }
   return read;
 }
 
 
 //-------------------------------------------------------------------------------------------
-int AsciiSource::parseWindowMultithreaded(QVector<AsciiFileData>& window, int col, double* v, int start, const QString& field)
+int AsciiSource::parseWindowMultithreaded(QVector<AsciiFileData>& window, const AsciiDataReader::Columns& columns, int start)
 {
   if (!_fileBuffer.readWindow(window))
     return 0;
 
   QFutureSynchronizer<int> readFutures;
   foreach (const AsciiFileData& chunk, window) {
-    QFuture<int> future = QtConcurrent::run(&_reader, &AsciiDataReader::readFieldFromChunk, chunk, col, v, start, field);
+    QFuture<int> future = QtConcurrent::run(&_reader, &AsciiDataReader::readFieldsFromChunk, chunk, columns, start);
     readFutures.addFuture(future);
   }
   readFutures.waitForFinished();
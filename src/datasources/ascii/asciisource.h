@@ -39,6 +39,10 @@ class AsciiSource : public Kst::DataSource
     virtual UpdateType internalDataSourceUpdate();
 
     int readField(double *v, const QString &field, int s, int n);
+    int readFieldSkip(double *v, const QString &field, int s, int n, int skip);
+
+    void readVectors(QList<VectorRead> &reads);
+    bool readsFieldsTogether() const;
 
     QString fileType() const;
 
@@ -90,8 +94,10 @@ class AsciiSource : public Kst::DataSource
     bool useSlidingWindow(qint64 bytesToRead)  const;
 
     int tryReadField(double *v, const QString &field, int s, int n);
-    int parseWindowSinglethreaded(QVector<AsciiFileData>& fileData, int col, double* v, int start, const QString& field, int sRead);
-    int parseWindowMultithreaded(QVector<AsciiFileData>& fileData, int col, double* v, int start, const QString& field);
+    int tryReadColumns(const AsciiDataReader::Columns& columns, const QString& field, int s, int n);
+    int reportRead(int read, int n);
+    int parseWindowSinglethreaded(QVector<AsciiFileData>& fileData, const AsciiDataReader::Columns& columns, int start, int sRead);
+    int parseWindowMultithreaded(QVector<AsciiFileData>& fileData, const AsciiDataReader::Columns& columns, int start);
     
     
 
@@ -149,12 +149,15 @@ const DataVector::DataInfo DataInterfaceDirFileVector::dataInfo(const QString &f
   if (!dir._fieldList.contains(field))
     return DataVector::DataInfo();
 
-  return DataVector::DataInfo(dir._frameCount, dir.samplesPerFrame(field));
+  return DataVector::DataInfo(dir._frameCount, dir.samplesPerFrame(field), true);
 }
 
 
 int DataInterfaceDirFileVector::read(const QString& field, DataVector::ReadInfo& p)
 {
+  if (p.skipFrame > 1) {
+    return dir.readFieldSkip(p.data, field, p.startingFrame, p.numberOfFrames, p.skipFrame);
+  }
   return dir.readField(p.data, field, p.startingFrame, p.numberOfFrames);
 }
 
@@ -224,6 +227,7 @@ DirFileSource::DirFileSource(Kst::ObjectStore *store, QSettings *cfg, const QStr
 
 DirFileSource::~DirFileSource()
 {
+  stopReadAhead();
   delete _config;
   _config = 0L;
   delete _dirfile;
@@ -239,7 +243,7 @@ void DirFileSource::reset()
   }
 
   init();
-  Object::reset();
+  Kst::DataSource::reset();
 }
 
 
@@ -300,6 +304,16 @@ Kst::Object::UpdateType DirFileSource::internalDataSourceUpdate() {
   return (isnew ? Updated : NoChange);
 }
 
+bool DirFileSource::readsPastFrameCount() const {
+  return true;
+}
+
+
+bool DirFileSource::appendsOnly() const {
+  return true;
+}
+
+
 int DirFileSource::readField(double *v, const QString& field, int s, int n) {
 
   if (n < 0) {
@@ -316,6 +330,45 @@ int DirFileSource::readField(double *v, const QString& field, int s, int n) {
 }
 
 
+// getdata has no stride, so read frames a block at a time and keep the
+// first sample of every skip'th one.  When the kept samples are far apart
+// reading them one by one is cheaper than reading what lies between.
+int DirFileSource::readFieldSkip(double *v, const QString& field, int s, int n, int skip) {
+  const int blockSamples = 65536;
+  const QByteArray name = field.toUtf8();
+  const int spf = qMax(samplesPerFrame(field), 1);
+
+  if (qint64(skip)*spf >= blockSamples) {
+    int n_read = 0;
+    for (int i = 0; i < n; ++i) {
+      if (_dirfile->GetData(name.constData(), s + i*skip, 0, 0, 1, Float64, (void*)(v + i)) < 1) {
+        break;
+      }
+      ++n_read;
+    }
+    return n_read;
+  }
+
+  const int perBlock = qMax(blockSamples/(skip*spf), 1);
+  QVector<double> buffer(((perBlock - 1)*skip + 1)*spf);
+  int n_read = 0;
+  while (n_read < n) {
+    const int count = qMin(perBlock, n - n_read);
+    const int frames = (count - 1)*skip + 1;
+    const int got = _dirfile->GetData(name.constData(), s + n_read*skip, 0, frames, 0, Float64, (void*)buffer.data());
+    const int kept = (got > 0) ? qMin((got - 1)/(skip*spf) + 1, count) : 0;
+    for (int i = 0; i < kept; ++i) {
+      v[n_read + i] = buffer.at(i*skip*spf);
+    }
+    n_read += kept;
+    if (kept < count) {
+      break;
+    }
+  }
+  return n_read;
+}
+
+
 // int DirFileSource::writeField(const double *v, const QString& field, int s, int n) {
 //   int err = 0;
 //
@@ -41,7 +41,16 @@ class DirFileSource : public Kst::DataSource {
 
     virtual UpdateType internalDataSourceUpdate();
 
+    /** getdata stops at the end of the field */
+    virtual bool readsPastFrameCount() const;
+
+    /** a dirfile grows by frames written at the end of every field; one
+      * which shrinks is reset */
+    virtual bool appendsOnly() const;
+
     int readField(double *v, const QString &field, int s, int n);
+    /** n samples, the first of every skip'th frame from frame s on */
+    int readFieldSkip(double *v, const QString &field, int s, int n, int skip);
 
 //     int writeField(const double *v, const QString &field, int s, int n);
 
@@ -102,7 +111,7 @@ class DirFileSource : public Kst::DataSource {
 class DirFilePlugin : public QObject, public Kst::DataSourcePluginInterface {
     Q_OBJECT
     Q_INTERFACES(Kst::DataSourcePluginInterface)
-    Q_PLUGIN_METADATA(IID "com.kst.DataSourcePluginInterface/2.0")
+    Q_PLUGIN_METADATA(IID "com.kst.DataSourcePluginInterface/2.1")
   public:
     virtual ~DirFilePlugin() {}
 
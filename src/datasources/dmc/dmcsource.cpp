@@ -133,6 +133,7 @@ DmcSource::DmcSource(Kst::ObjectStore *store, QSettings *cfg, const QString& fil
 
 
 DmcSource::~DmcSource() {
+  stopReadAhead();
   //qDebug() << "Planck source " << (void*)this << " destroyed" << endl;
 }
 
@@ -151,6 +152,7 @@ void DmcSource::reset() {
     update();
     _valid = true;
   }
+  Kst::DataSource::reset();
 }
 
 
@@ -61,7 +61,7 @@ class DmcSource : public Kst::DataSource {
 
     bool isEmpty() const;
 
-    void  reset();
+    virtual void reset();
 
   private:
     QMap<QString, int> _frameCounts;
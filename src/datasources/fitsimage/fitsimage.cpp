@@ -411,6 +411,7 @@ FitsImageSource::FitsImageSource(Kst::ObjectStore *store, QSettings *cfg, const
 
 
 FitsImageSource::~FitsImageSource() {
+  stopReadAhead();
   int status = 0;
   if (_fptr) {
     fits_close_file( _fptr, &status );
@@ -428,7 +429,7 @@ const QString& FitsImageSource::typeString() const {
 
 void FitsImageSource::reset() {
   init();
-  Object::reset();
+  Kst::DataSource::reset();
 }
 
 bool FitsImageSource::init() {
@@ -428,6 +428,7 @@ HealpixSource::HealpixSource(Kst::ObjectStore *store, QSettings *cfg, const QStr
 
 
 HealpixSource::~HealpixSource() {
+  stopReadAhead();
   if (_keys) {
     healpix_keys_free(_keys);
   }
@@ -440,8 +441,8 @@ HealpixSource::~HealpixSource() {
 }
 
 
-bool HealpixSource::reset() {
-  return true;
+void HealpixSource::reset() {
+  Kst::DataSource::reset();
 }
 
 
@@ -71,12 +71,13 @@ LFIIOSource::LFIIOSource(Kst::ObjectStore *store, QSettings *cfg, const QString&
 
 
 LFIIOSource::~LFIIOSource() {
+  stopReadAhead();
 }
 
 
-bool LFIIOSource::reset() {
+void LFIIOSource::reset() {
   init();
-  return true;
+  Kst::DataSource::reset();
 }
 
 
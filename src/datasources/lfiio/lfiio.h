@@ -29,7 +29,7 @@ class LFIIOSource : public Kst::DataSource {
     ~LFIIOSource();
 
     bool init();
-    bool reset();
+    virtual void reset();
 
     Kst::Object::UpdateType update();
 
@@ -342,6 +342,7 @@ MatlabSource::MatlabSource(Kst::ObjectStore *store, QSettings *cfg, const QStrin
 
 
 MatlabSource::~MatlabSource() {
+  stopReadAhead();
   Mat_Close(_matfile);
   _matfile = 0L;
 }
@@ -351,6 +352,7 @@ void MatlabSource::reset() {
   Mat_Close(_matfile);
   _matfile = 0L;
   _maxFrameCount = 0;
+  Kst::DataSource::reset();
   _valid = init();
 }
 
@@ -84,7 +84,7 @@ class MatlabSource : public Kst::DataSource {
 class MatlabSourcePlugin : public QObject, public Kst::DataSourcePluginInterface {
     Q_OBJECT
     Q_INTERFACES(Kst::DataSourcePluginInterface)
-    Q_PLUGIN_METADATA(IID "com.kst.DataSourcePluginInterface/2.0")
+    Q_PLUGIN_METADATA(IID "com.kst.DataSourcePluginInterface/2.1")
   public:
     virtual ~MatlabSourcePlugin() {}
 
@@ -167,13 +167,16 @@ const DataVector::DataInfo DataInterfaceNetCdfVector::dataInfo(const QString &fi
   if (!netcdf._fieldList.contains(field))
     return DataVector::DataInfo();
 
-  return DataVector::DataInfo(netcdf.frameCount(field), netcdf.samplesPerFrame(field));
+  return DataVector::DataInfo(netcdf.frameCount(field), netcdf.samplesPerFrame(field), true);
 }
 
 
 
 int DataInterfaceNetCdfVector::read(const QString& field, DataVector::ReadInfo& p)
 {
+  if (p.skipFrame > 1) {
+    return netcdf.readFieldSkip(p.data, field, p.startingFrame, p.numberOfFrames, p.skipFrame);
+  }
   return netcdf.readField(p.data, field, p.startingFrame, p.numberOfFrames);
 }
 
@@ -340,6 +343,7 @@ NetcdfSource::NetcdfSource(Kst::ObjectStore *store, QSettings *cfg, const QStrin
 
 
 NetcdfSource::~NetcdfSource() {
+  stopReadAhead();
   delete _ncfile;
   _ncfile = 0L;
 }
@@ -350,6 +354,7 @@ void NetcdfSource::reset() {
   _ncfile = 0L;
   _maxFrameCount = 0;
   _valid = initFile();
+  Kst::DataSource::reset();
 }
 
 
@@ -584,6 +589,43 @@ int NetcdfSource::readField(double *v, const QString& field, int s, int n) {
 }
 
 
+/* The first value of every skip'th record, in one strided read.  The C++
+   interface has no stride, so this goes to the C library underneath. */
+int NetcdfSource::readFieldSkip(double *v, const QString& field, int s, int n, int skip) {
+  if (field.toLower() == "index") {
+    for (int i = 0; i < n; ++i) {
+      v[i] = double(s + i*skip);
+    }
+    return n;
+  }
+
+  QByteArray bytes = field.toLatin1();
+  NcVar *var = _ncfile->get_var(bytes.constData());  // var is owned by _ncfile
+  if (!var || var->num_dims() < 1) {
+    KST_DBG qDebug() << "Queried field " << field << " which can't be read" << endl;
+    return -1;
+  }
+
+  const int records = var->num_vals() / var->rec_size();
+  if (s >= records || n <= 0) {
+    return 0;
+  }
+  n = qMin(n, (records - 1 - s)/skip + 1);
+
+  const int dims = var->num_dims();
+  QVector<size_t> start(dims, 0), count(dims, 1);
+  QVector<ptrdiff_t> stride(dims, 1);
+  start[0] = s;
+  count[0] = n;
+  stride[0] = skip;
+  if (nc_get_vars_double(_ncfile->id(), var->id(), start.data(), count.data(), stride.data(), v) != NC_NOERR) {
+    KST_DBG qDebug() << field << ": strided read failed" << endl;
+    return 0;
+  }
+  return n;
+}
+
+
 
 
 
@@ -53,6 +53,8 @@ class NetcdfSource : public Kst::DataSource {
 
     int readField(double *v, const QString& field, int s, int n);
 
+    int readFieldSkip(double *v, const QString& field, int s, int n, int skip);
+
     int readMatrix(double *v, const QString& field);
 
     int samplesPerFrame(const QString& field);
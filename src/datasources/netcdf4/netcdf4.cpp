@@ -373,6 +373,7 @@ Netcdf4Source::Netcdf4Source(Kst::ObjectStore *store, QSettings *cfg, const QStr
 
 
 Netcdf4Source::~Netcdf4Source() {
+  stopReadAhead();
   delete _ncfile;
   _ncfile = 0L;
 }
@@ -383,7 +384,7 @@ void Netcdf4Source::reset() {
   _ncfile = 0L;
   _maxFrameCount = 0;
   _valid = init();
-  Object::reset();
+  Kst::DataSource::reset();
 }
 
 void Netcdf4Source::add_variables(std::multimap<std::string, NcVar> varMap, std::string prefix) {
@@ -84,7 +84,7 @@ class Netcdf4Source : public Kst::DataSource {
 class Netcdf4Plugin : public QObject, public Kst::DataSourcePluginInterface {
     Q_OBJECT
     Q_INTERFACES(Kst::DataSourcePluginInterface)
-    Q_PLUGIN_METADATA(IID "com.kst.DataSourcePluginInterface/2.0")
+    Q_PLUGIN_METADATA(IID "com.kst.DataSourcePluginInterface/2.1")
   public:
     virtual ~Netcdf4Plugin() {}
 
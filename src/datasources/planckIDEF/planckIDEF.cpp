@@ -90,6 +90,7 @@ PlanckIDEFSource::PlanckIDEFSource(Kst::ObjectStore *store, QSettings *cfg, cons
 
 
 PlanckIDEFSource::~PlanckIDEFSource() {
+  stopReadAhead();
   delete _config;
   _config = 0L;
 }
@@ -239,8 +240,8 @@ QString PlanckIDEFSource::baseFilename(const QString& filename) {
 }
 
 
-bool PlanckIDEFSource::reset() {
-  return true;
+void PlanckIDEFSource::reset() {
+  Kst::DataSource::reset();
 }
 
 
@@ -43,7 +43,7 @@ class PlanckIDEFSource : public Kst::DataSource {
     ~PlanckIDEFSource();
 
     bool init();
-    bool reset();
+    virtual void reset();
 
     Kst::Object::UpdateType update();
 
@@ -322,6 +322,7 @@ QImageSource::QImageSource(Kst::ObjectStore *store, QSettings *cfg, const QStrin
 
 
 QImageSource::~QImageSource() {
+  stopReadAhead();
   delete _config;
   _config = 0L;
 }
@@ -334,7 +335,7 @@ const QString& QImageSource::typeString() const {
 
 void QImageSource::reset() {
   init();
-  Object::reset();
+  Kst::DataSource::reset();
 }
 
 
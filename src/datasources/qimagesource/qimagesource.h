@@ -58,7 +58,7 @@ class QImageSource : public Kst::DataSource
 class QImageSourcePlugin : public QObject, public Kst::DataSourcePluginInterface {
     Q_OBJECT
     Q_INTERFACES(Kst::DataSourcePluginInterface)
-    Q_PLUGIN_METADATA(IID "com.kst.DataSourcePluginInterface/2.0")
+    Q_PLUGIN_METADATA(IID "com.kst.DataSourcePluginInterface/2.1")
   public:
     virtual ~QImageSourcePlugin() {}
 
@@ -76,12 +76,13 @@ SampleDatasourceSource::SampleDatasourceSource(Kst::ObjectStore *store, QSetting
 
 
 SampleDatasourceSource::~SampleDatasourceSource() {
+  stopReadAhead();
 }
 
 
 void SampleDatasourceSource::reset() {
   init();
-  Object::reset();
+  Kst::DataSource::reset();
 }
 
 
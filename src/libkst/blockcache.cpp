@@ -0,0 +1,168 @@
+/***************************************************************************
+             blockcache.cpp: recently read blocks of data source fields
+                             -------------------
+    begin                : October, 2012
+    copyright            : (C) 2012 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "blockcache.h"
+
+#include <QCoreApplication>
+
+namespace Kst {
+
+static BlockCache *_blockCache = 0;
+void BlockCache::cleanup() {
+  delete _blockCache;
+  _blockCache = 0;
+}
+
+
+BlockCache *BlockCache::self() {
+  if (!_blockCache) {
+    _blockCache = new BlockCache;
+    qAddPostRoutine(cleanup);
+  }
+  return _blockCache;
+}
+
+
+BlockCache::BlockCache()
+  : _capacity(0), _bytes(0), _hits(0), _misses(0) {
+}
+
+
+BlockCache::~BlockCache() {
+}
+
+
+bool BlockCache::find(const DataSource *source, const QString &field, int block, QVector<double> &samples) {
+  QMutexLocker ml(&_mutex);
+  QHash<Key, Entry>::Iterator it = _entries.find(Key(source, field, block));
+  if (it == _entries.end()) {
+    ++_misses;
+    return false;
+  }
+  ++_hits;
+  _uses.erase(it.value().use);
+  it.value().use = _uses.insert(_uses.end(), it.key());
+  samples = it.value().samples;
+  return true;
+}
+
+
+void BlockCache::insert(const DataSource *source, const QString &field, int block, const QVector<double> &samples) {
+  const qint64 size = qint64(samples.size())*sizeof(double);
+
+  QMutexLocker ml(&_mutex);
+  if (size > _capacity) {
+    return;
+  }
+  const Key key(source, field, block);
+  QHash<Key, Entry>::Iterator it = _entries.find(key);
+  if (it != _entries.end()) {
+    remove(it);
+  }
+  Entry entry;
+  entry.samples = samples;
+  entry.use = _uses.insert(_uses.end(), key);
+  _entries.insert(key, entry);
+  _bytes += size;
+  shrink();
+}
+
+
+QHash<BlockCache::Key, BlockCache::Entry>::Iterator BlockCache::remove(QHash<Key, Entry>::Iterator it) {
+  _bytes -= qint64(it.value().samples.size())*sizeof(double);
+  _uses.erase(it.value().use);
+  return _entries.erase(it);
+}
+
+
+void BlockCache::shrink() {
+  while (_bytes > _capacity && !_uses.isEmpty()) {
+    remove(_entries.find(_uses.first()));
+  }
+}
+
+
+void BlockCache::invalidate(const DataSource *source) {
+  QMutexLocker ml(&_mutex);
+  QHash<Key, Entry>::Iterator it = _entries.begin();
+  while (it != _entries.end()) {
+    if (it.key().source == source) {
+      it = remove(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+
+void BlockCache::invalidate(const DataSource *source, const QString &field) {
+  invalidate(source, field, 0);
+}
+
+
+void BlockCache::invalidate(const DataSource *source, const QString &field, int block) {
+  QMutexLocker ml(&_mutex);
+  QHash<Key, Entry>::Iterator it = _entries.begin();
+  while (it != _entries.end()) {
+    if (it.key().source == source && it.key().field == field && it.key().block >= block) {
+      it = remove(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+
+qint64 BlockCache::capacity() const {
+  QMutexLocker ml(&_mutex);
+  return _capacity;
+}
+
+
+void BlockCache::setCapacity(qint64 bytes) {
+  QMutexLocker ml(&_mutex);
+  _capacity = qMax(bytes, qint64(0));
+  shrink();
+}
+
+
+qint64 BlockCache::bytes() const {
+  QMutexLocker ml(&_mutex);
+  return _bytes;
+}
+
+
+int BlockCache::blocks() const {
+  QMutexLocker ml(&_mutex);
+  return _entries.count();
+}
+
+
+qint64 BlockCache::hits() const {
+  QMutexLocker ml(&_mutex);
+  return _hits;
+}
+
+
+qint64 BlockCache::misses() const {
+  QMutexLocker ml(&_mutex);
+  return _misses;
+}
+
+}
+
+// vim: ts=2 sw=2 et
@@ -0,0 +1,119 @@
+/***************************************************************************
+              blockcache.h: recently read blocks of data source fields
+                             -------------------
+    begin                : October, 2012
+    copyright            : (C) 2012 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef BLOCKCACHE_H
+#define BLOCKCACHE_H
+
+#include <QHash>
+#include <QLinkedList>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include "kst_export.h"
+
+namespace Kst {
+
+class DataSource;
+
+// The samples of recently read blocks of frames of data source fields,
+// shared by all the sources of the process.  Several vectors of the same
+// field, or a vector which goes back over frames it had before (a new
+// range, a reload of the plot) then take them from memory rather than have
+// the source decode them again.
+//
+// A block is blockFrames() frames, about BlockSamples samples, starting at
+// a multiple of that: DataSource::readCachedVector() only keeps whole
+// blocks.  Whenever an update finds the file changed, or the source is
+// reset, the blocks of the source are dropped with invalidate(): neither
+// the size nor the time of a file tells an append from a rewrite, unless
+// the source appendsOnly(), when only the blocks from the old end of the
+// file on go.  When the blocks add up to more than the capacity the least
+// recently used go first.
+
+class KSTCORE_EXPORT BlockCache
+{
+  public:
+    static BlockCache *self();
+
+    enum { BlockSamples = 64*1024 };
+
+    /** frames in a block of a field of samplesPerFrame */
+    static int blockFrames(int samplesPerFrame) { return qMax(BlockSamples/qMax(samplesPerFrame, 1), 1); }
+
+    /** The samples of block of field of source, if they are here.  Counts
+      * a hit or a miss. */
+    bool find(const DataSource *source, const QString &field, int block, QVector<double> &samples);
+    void insert(const DataSource *source, const QString &field, int block, const QVector<double> &samples);
+
+    /** forget the blocks of source, or of one field of it */
+    void invalidate(const DataSource *source);
+    void invalidate(const DataSource *source, const QString &field);
+    /** forget the blocks of field of source from block on */
+    void invalidate(const DataSource *source, const QString &field, int block);
+
+    /** bytes of samples kept at most; 0 to keep none */
+    qint64 capacity() const;
+    void setCapacity(qint64 bytes);
+    bool isEnabled() const { return capacity() > 0; }
+
+    qint64 bytes() const;
+    int blocks() const;
+    qint64 hits() const;
+    qint64 misses() const;
+
+  private:
+    BlockCache();
+    ~BlockCache();
+    static void cleanup();
+
+    struct Key {
+      Key(const DataSource *s, const QString &f, int b) : source(s), field(f), block(b) {}
+      const DataSource *source;
+      QString field;
+      int block;
+
+      bool operator==(const Key &other) const {
+        return block == other.block && source == other.source && field == other.field;
+      }
+      friend uint qHash(const Key &key) {
+        return qHash(key.field) ^ uint(quintptr(key.source) >> 4) ^ uint(key.block)*2654435761u;
+      }
+    };
+
+    struct Entry {
+      QVector<double> samples;
+      QLinkedList<Key>::Iterator use; // where it is in _uses
+    };
+
+    QHash<Key, Entry>::Iterator remove(QHash<Key, Entry>::Iterator it);
+    void shrink();
+
+    mutable QMutex _mutex;
+    QHash<Key, Entry> _entries;
+    QLinkedList<Key> _uses; // least recently used first
+    qint64 _capacity;
+    qint64 _bytes;
+    qint64 _hits;
+    qint64 _misses;
+};
+
+}
+
+#endif
+
+// vim: ts=2 sw=2 et
@@ -0,0 +1,383 @@
+/***************************************************************************
+              bufferstore.cpp: memory for vector and matrix data
+                             -------------------
+    begin                : October, 2012
+    copyright            : (C) 2012 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "bufferstore.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef Q_OS_WIN
+#include <malloc.h>
+#endif
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QTemporaryFile>
+
+namespace Kst {
+
+static BufferStore *_bufferStore = 0;
+void BufferStore::cleanup() {
+  delete _bufferStore;
+  _bufferStore = 0;
+}
+
+
+BufferStore *BufferStore::self() {
+  if (!_bufferStore) {
+    _bufferStore = new BufferStore;
+    qAddPostRoutine(cleanup);
+  }
+  return _bufferStore;
+}
+
+
+BufferStore::BufferStore()
+  : _budget(0), _heapBytes(0), _mappedBytes(0), _mappedBuffers(0), _pooledBytes(0), _scratchDirectory(QDir::tempPath()) {
+  for (int i = 0; i < UsageCount; ++i) {
+    _usageBytes[i] = 0;
+  }
+}
+
+
+// Whatever is still around by now belongs to objects which are never
+// deleted; only the scratch files are worth cleaning up.
+BufferStore::~BufferStore() {
+  for (QHash<void*, Block>::ConstIterator it = _blocks.begin(); it != _blocks.end(); ++it) {
+    delete it.value().file;
+  }
+}
+
+
+static void *alignedAllocate(size_t bytes) {
+#ifdef Q_OS_WIN
+  return _aligned_malloc(bytes, BufferStore::Alignment);
+#else
+  void *p = 0;
+  if (posix_memalign(&p, BufferStore::Alignment, bytes) != 0) {
+    return 0;
+  }
+  return p;
+#endif
+}
+
+
+static void alignedFree(void *ptr) {
+#ifdef Q_OS_WIN
+  _aligned_free(ptr);
+#else
+  free(ptr);
+#endif
+}
+
+
+// Eight classes per doubling, in multiples of the alignment: at most an
+// eighth is wasted, and growing one sample at a time only moves the buffer
+// every eighth of the way to twice its size.
+static size_t capacityFor(size_t bytes) {
+  size_t top = BufferStore::Alignment;
+  while (top < bytes) {
+    top <<= 1;
+  }
+  const size_t step = qMax(size_t(BufferStore::Alignment), top/16);
+  return (bytes + step - 1)/step*step;
+}
+
+
+void *BufferStore::allocateBlock(size_t capacity) {
+  if (capacity <= size_t(MaximumPooledSize)) {
+    QHash<size_t, QList<void*> >::Iterator it = _pool.find(capacity);
+    if (it != _pool.end() && !it.value().isEmpty()) {
+      _pooledBytes -= capacity;
+      return it.value().takeLast();
+    }
+  }
+  return alignedAllocate(capacity);
+}
+
+
+void BufferStore::freeBlock(void *ptr, size_t capacity) {
+  if (capacity <= size_t(MaximumPooledSize) && _pooledBytes + qint64(capacity) <= MaximumPoolBytes) {
+    _pool[capacity].append(ptr);
+    _pooledBytes += capacity;
+  } else {
+    alignedFree(ptr);
+  }
+}
+
+
+void BufferStore::insert(void *ptr, const Block &block) {
+  _blocks.insert(ptr, block);
+  if (block.file) {
+    _mappedBytes += block.capacity;
+    ++_mappedBuffers;
+  } else {
+    _heapBytes += block.capacity;
+  }
+  _usageBytes[block.usage] += block.bytes;
+}
+
+
+void BufferStore::remove(void *ptr, const Block &block) {
+  _blocks.remove(ptr);
+  if (block.file) {
+    _mappedBytes -= block.capacity;
+    --_mappedBuffers;
+  } else {
+    _heapBytes -= block.capacity;
+  }
+  _usageBytes[block.usage] -= block.bytes;
+}
+
+
+void *BufferStore::reallocate(void *ptr, size_t bytes, Usage usage) {
+  if (bytes == 0) {
+    bytes = 1;
+  }
+
+  QMutexLocker ml(&_mutex);
+  const bool known = !ptr || _blocks.contains(ptr);
+  const Block old = _blocks.value(ptr);
+  if (known && ptr) {
+    usage = old.usage;
+  }
+
+  // Something from outside stays with malloc(): we don't know how much of
+  // it there is to copy.
+  if (!known || old.foreign) {
+    void *p = realloc(ptr, bytes);
+    if (!p) {
+      return 0;
+    }
+    if (known) {
+      remove(ptr, old);
+    }
+    Block block;
+    block.bytes = block.capacity = bytes;
+    block.usage = usage;
+    block.foreign = true;
+    insert(p, block);
+    return p;
+  }
+
+  // snapshots and work buffers only last an update or so: not worth a file
+  if (bytes >= size_t(MinimumMappedSize) && (usage == VectorData || usage == MatrixData)) {
+    const qint64 heapAfter = _heapBytes + qint64(bytes) - (old.file ? 0 : qint64(old.capacity));
+    if (old.file || (_budget > 0 && heapAfter > _budget)) {
+      void *p = old.file ? remap(ptr, old, bytes) : mapNew(ptr, old, bytes, usage);
+      if (p) {
+        return p;
+      }
+      // no room on disk either: try the heap
+    }
+  }
+
+  const size_t capacity = capacityFor(bytes);
+  Block block;
+  block.bytes = bytes;
+  block.capacity = capacity;
+  block.usage = usage;
+
+  if (ptr && !old.file && old.capacity == capacity) {
+    remove(ptr, old);
+    insert(ptr, block);
+    return ptr;
+  }
+
+  void *p = allocateBlock(capacity);
+  if (!p) {
+    return 0;
+  }
+  if (ptr) {
+    memcpy(p, ptr, qMin(old.bytes, bytes));
+    remove(ptr, old);
+    if (old.file) {
+      old.file->unmap(static_cast<uchar*>(ptr));
+      delete old.file;
+    } else {
+      freeBlock(ptr, old.capacity);
+    }
+  }
+  insert(p, block);
+  return p;
+}
+
+
+// from the heap to a new scratch file
+void *BufferStore::mapNew(void *ptr, const Block &old, size_t bytes, Usage usage) {
+  QTemporaryFile *file = new QTemporaryFile(_scratchDirectory + QDir::separator() + "kst-buffer-XXXXXX");
+  uchar *p = 0;
+  if (file->open() && file->resize(bytes)) {
+    p = file->map(0, bytes);
+  }
+  if (!p) {
+    qWarning() << "Could not map a scratch file in" << _scratchDirectory << ":" << file->errorString();
+    delete file;
+    return 0;
+  }
+
+  if (ptr) {
+    memcpy(p, ptr, qMin(old.bytes, bytes));
+    remove(ptr, old);
+    freeBlock(ptr, old.capacity);
+  }
+
+  Block block;
+  block.bytes = block.capacity = bytes;
+  block.usage = usage;
+  block.file = file;
+  insert(p, block);
+  return p;
+}
+
+
+// to a different size of the same scratch file: the contents stay put in
+// the file, so nothing is copied.  The new mapping is made before the old
+// one goes, and the file only shrinks after, so that if anything fails
+// the buffer is just as it was, where it was.
+void *BufferStore::remap(void *ptr, const Block &old, size_t bytes) {
+  QTemporaryFile *file = old.file;
+  if (bytes > old.bytes && !file->resize(bytes)) {
+    return 0;
+  }
+  uchar *p = file->map(0, bytes);
+  if (!p) {
+    if (bytes > old.bytes) {
+      file->resize(old.bytes);
+    }
+    return 0;
+  }
+
+  file->unmap(static_cast<uchar*>(ptr));
+  if (bytes < old.bytes) {
+    file->resize(bytes); // if not, the file is only bigger than it needs to be
+  }
+  remove(ptr, old);
+  Block block = old;
+  block.bytes = block.capacity = bytes;
+  insert(p, block);
+  return p;
+}
+
+
+void BufferStore::release(void *ptr) {
+  if (!ptr) {
+    return;
+  }
+
+  QMutexLocker ml(&_mutex);
+  if (!_blocks.contains(ptr)) {
+    free(ptr);
+    return;
+  }
+  const Block block = _blocks.value(ptr);
+  remove(ptr, block);
+  if (block.file) {
+    block.file->unmap(static_cast<uchar*>(ptr));
+    delete block.file;
+  } else if (block.foreign) {
+    free(ptr);
+  } else {
+    freeBlock(ptr, block.capacity);
+  }
+}
+
+
+bool BufferStore::isMapped(const void *ptr) const {
+  QMutexLocker ml(&_mutex);
+  return _blocks.value(const_cast<void*>(ptr)).file != 0;
+}
+
+
+qint64 BufferStore::residentBudget() const {
+  QMutexLocker ml(&_mutex);
+  return _budget;
+}
+
+
+void BufferStore::setResidentBudget(qint64 bytes) {
+  QMutexLocker ml(&_mutex);
+  _budget = qMax(bytes, qint64(0));
+}
+
+
+QString BufferStore::scratchDirectory() const {
+  QMutexLocker ml(&_mutex);
+  return _scratchDirectory;
+}
+
+
+void BufferStore::setScratchDirectory(const QString &directory) {
+  const QString scratch = directory.isEmpty() ? QDir::tempPath() : directory;
+  if (!QDir().mkpath(scratch)) {
+    qWarning() << "Could not make the scratch directory" << scratch;
+  }
+
+  QMutexLocker ml(&_mutex);
+  _scratchDirectory = scratch;
+}
+
+
+qint64 BufferStore::heapBytes() const {
+  QMutexLocker ml(&_mutex);
+  return _heapBytes;
+}
+
+
+qint64 BufferStore::mappedBytes() const {
+  QMutexLocker ml(&_mutex);
+  return _mappedBytes;
+}
+
+
+int BufferStore::mappedBuffers() const {
+  QMutexLocker ml(&_mutex);
+  return _mappedBuffers;
+}
+
+
+qint64 BufferStore::pooledBytes() const {
+  QMutexLocker ml(&_mutex);
+  return _pooledBytes;
+}
+
+
+qint64 BufferStore::bytesInUse(Usage usage) const {
+  QMutexLocker ml(&_mutex);
+  return _usageBytes[usage];
+}
+
+
+QString BufferStore::usageName(Usage usage) {
+  switch (usage) {
+    case VectorData:
+      return QObject::tr("Vectors");
+    case MatrixData:
+      return QObject::tr("Matrices");
+    case SnapshotData:
+      return QObject::tr("Snapshots");
+    case WorkData:
+      return QObject::tr("Work buffers");
+    default:
+      return QString();
+  }
+}
+
+}
+
+// vim: ts=2 sw=2 et
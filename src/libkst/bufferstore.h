@@ -0,0 +1,144 @@
+/***************************************************************************
+               bufferstore.h: memory for vector and matrix data
+                             -------------------
+    begin                : October, 2012
+    copyright            : (C) 2012 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef BUFFERSTORE_H
+#define BUFFERSTORE_H
+
+#include <stddef.h>
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+#include "kst_export.h"
+
+class QTemporaryFile;
+
+namespace Kst {
+
+// Where the samples of Vectors and Matrices live.  Buffers are on the heap
+// until the heap buffers add up to the resident budget; after that, any
+// VectorData or MatrixData buffer of MinimumMappedSize or more is put in
+// a memory mapped scratch file instead, which the operating system pages
+// in and out as the data is used.  Snapshot and work buffers come and go
+// with updates, so they stay on the heap.  Either way a buffer is a plain
+// contiguous array, so the rest of Kst doesn't have to know.
+//
+// Heap buffers are Alignment aligned, for the SIMD kernels, and are
+// rounded up to one of eight size classes per doubling.  A buffer which
+// is resized within its class stays where it is.  Freed buffers of up to
+// MaximumPooledSize are kept, up to MaximumPoolBytes of them, for the next
+// buffer of the same class: objects which free and allocate their
+// buffers on every update don't go back to malloc(), and long sessions
+// don't fragment the heap.
+//
+// Buffers which didn't come from here (malloc()ed by a plugin, say) can
+// be handed in too: they are treated as heap buffers of unknown size.
+// Anything which did come from here must go back through reallocate() or
+// release(), never realloc() or free().
+
+class KSTCORE_EXPORT BufferStore
+{
+  public:
+    static BufferStore *self();
+
+    enum { MinimumMappedSize = 1024*1024 }; // bytes
+    enum { Alignment = 64 };
+    enum { MaximumPooledSize = 1024*1024, MaximumPoolBytes = 64*1024*1024 };
+
+    /** what a buffer holds, for the counters */
+    enum Usage { VectorData = 0, MatrixData, SnapshotData, WorkData, UsageCount };
+
+    /** As realloc(), but may move the buffer to or from a scratch file.
+      * Returns 0, and leaves ptr as it was, on failure.  The usage is
+      * taken from the first call for a buffer. */
+    void *reallocate(void *ptr, size_t bytes, Usage usage = VectorData);
+    void *allocate(size_t bytes, Usage usage = VectorData) { return reallocate(0, bytes, usage); }
+    void release(void *ptr);
+
+    /** As kstrealloc() */
+    template<class T> bool resize(T *&ptr, size_t bytes, Usage usage = VectorData) {
+      void *p = reallocate(ptr, bytes, usage);
+      if (!p) {
+        return false;
+      }
+      ptr = static_cast<T*>(p);
+      return true;
+    }
+
+    bool isMapped(const void *ptr) const;
+
+    /** bytes of heap buffers before new ones are mapped; 0 for no limit */
+    qint64 residentBudget() const;
+    void setResidentBudget(qint64 bytes);
+
+    /** where the scratch files go, made if need be: this wants to be a
+      * real disk, not a tmpfs, or the mapped buffers take up memory after
+      * all.  The temporary directory until set. */
+    QString scratchDirectory() const;
+    void setScratchDirectory(const QString &directory);
+
+    /** heap taken by buffers in use, pooled ones not included */
+    qint64 heapBytes() const;
+    qint64 mappedBytes() const;
+    int mappedBuffers() const;
+    /** heap kept for reuse */
+    qint64 pooledBytes() const;
+    /** bytes asked for, wherever they are */
+    qint64 bytesInUse(Usage usage) const;
+    static QString usageName(Usage usage);
+
+  private:
+    BufferStore();
+    ~BufferStore();
+    static void cleanup();
+
+    struct Block {
+      Block() : bytes(0), capacity(0), usage(VectorData), file(0), foreign(false) {}
+      size_t bytes;
+      size_t capacity;
+      Usage usage;
+      QTemporaryFile *file; // 0 for the heap
+      bool foreign;         // from malloc(), not from here
+    };
+
+    void *mapNew(void *ptr, const Block &old, size_t bytes, Usage usage);
+    void *remap(void *ptr, const Block &old, size_t bytes);
+
+    void *allocateBlock(size_t capacity);
+    void freeBlock(void *ptr, size_t capacity);
+    void insert(void *ptr, const Block &block);
+    void remove(void *ptr, const Block &block);
+
+    mutable QMutex _mutex;
+    QHash<void*, Block> _blocks;
+    QHash<size_t, QList<void*> > _pool; // by capacity
+    qint64 _budget;
+    qint64 _heapBytes;
+    qint64 _mappedBytes;
+    int _mappedBuffers;
+    qint64 _pooledBytes;
+    qint64 _usageBytes[UsageCount];
+    QString _scratchDirectory;
+};
+
+}
+
+#endif
+
+// vim: ts=2 sw=2 et
@@ -24,6 +24,7 @@
 
 #include "kst_i18n.h"
 
+#include "bufferstore.h"
 #include "datacollection.h"
 #include "debug.h"
 #include "objectstore.h"
@@ -53,6 +54,8 @@ DataMatrix::DataInfo::DataInfo() :
 
 DataMatrix::DataMatrix(ObjectStore *store)
   : Matrix(store), DataPrimitive(this) {
+  _aveReadBuffer = 0L;
+  _aveReadBufferSize = 0;
 }
 
 
@@ -86,6 +89,7 @@ void DataMatrix::save(QXmlStreamWriter &xml) {
 }
 
 DataMatrix::~DataMatrix() {
+  BufferStore::self()->release(_aveReadBuffer);
 }
 
 
@@ -248,7 +252,7 @@ void DataMatrix::doUpdateSkip(int realXStart, int realYStart) {
     // boxcar filtering is not supported by datasources currently; need to manually average
     if (_aveReadBufferSize < _samplesPerFrameCache*_skip*_samplesPerFrameCache*_skip) {
       _aveReadBufferSize = _samplesPerFrameCache*_skip*_samplesPerFrameCache*_skip;
-      if (!kstrealloc(_aveReadBuffer, _aveReadBufferSize*sizeof(double))) {
+      if (!BufferStore::self()->resize(_aveReadBuffer, _aveReadBufferSize*sizeof(double), BufferStore::WorkData)) {
         qCritical() << "Matrix resize failed";
       }
     }
@@ -327,6 +331,15 @@ void DataMatrix::doUpdateNoSkip(int realXStart, int realYStart) {
   _stepY = matData.yStepSize;
 }
 
+QList<ObjectPtr> DataMatrix::inputObjects() const {
+  QList<ObjectPtr> inputs = Primitive::inputObjects();
+  DataSourcePtr ds = dataSource();
+  if (ds) {
+    inputs.append(ObjectPtr(ds.data()));
+  }
+  return inputs;
+}
+
 qint64 DataMatrix::minInputSerial() const {
   if (dataSource()) {
     return (dataSource()->serial());
@@ -597,6 +610,7 @@ void DataMatrix::commonConstructor(DataSourcePtr in_file, const QString &field,
     _invertYHint = info.invertYHint;
   }
 
+  BufferStore::self()->release(_aveReadBuffer);
   _aveReadBuffer = 0L;
   _aveReadBufferSize = 0;
   _lastXStart = 0;
@@ -118,6 +118,7 @@ class KSTCORE_EXPORT DataMatrix : public Matrix, public DataPrimitive
 
     virtual QString propertyString() const;
     virtual void internalUpdate();
+    virtual QList<ObjectPtr> inputObjects() const;
 
     virtual LabelInfo xLabelInfo() const;
     virtual LabelInfo yLabelInfo() const;
@@ -95,8 +95,8 @@ class DataSourcePluginInterface : public PluginInterface {
 }
 
 
-Q_DECLARE_INTERFACE(Kst::PluginInterface, "com.kst.PluginInterface/2.0")
-Q_DECLARE_INTERFACE(Kst::DataSourcePluginInterface, "com.kst.DataSourcePluginInterface/2.0")
+Q_DECLARE_INTERFACE(Kst::PluginInterface, "com.kst.PluginInterface/2.1")
+Q_DECLARE_INTERFACE(Kst::DataSourcePluginInterface, "com.kst.DataSourcePluginInterface/2.1")
 
 
 #endif
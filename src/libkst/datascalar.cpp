@@ -136,6 +136,15 @@ PrimitivePtr DataScalar::makeDuplicate() const {
   return kst_cast<Primitive>(scalar);
 }
 
+QList<ObjectPtr> DataScalar::inputObjects() const {
+  QList<ObjectPtr> inputs = Primitive::inputObjects();
+  DataSourcePtr ds = dataSource();
+  if (ds) {
+    inputs.append(ObjectPtr(ds.data()));
+  }
+  return inputs;
+}
+
 qint64 DataScalar::minInputSerial() const {
   if (dataSource()) {
     return (dataSource()->serial());
@@ -58,6 +58,7 @@ class KSTCORE_EXPORT DataScalar : public Scalar, public DataPrimitive
     };
 
     virtual void internalUpdate();
+    virtual QList<ObjectPtr> inputObjects() const;
     virtual const QString& typeString() const;
     static const QString staticTypeString;
     static const QString staticTypeTag;
@@ -18,6 +18,7 @@
 #include "datasource.h"
 
 #include <assert.h>
+#include <string.h>
 
 #include <QApplication>
 #include <QDebug>
@@ -30,9 +31,12 @@
 #include <QUrl>
 #include <QXmlStreamWriter>
 #include <QTimer>
+#include <QTime>
+#include <QThreadPool>
 #include <QFileSystemWatcher>
 
 #include "kst_i18n.h"
+#include "blockcache.h"
 #include "datacollection.h"
 #include "debug.h"
 #include "objectstore.h"
@@ -84,10 +88,38 @@ Object::UpdateType DataSource::objectUpdate(qint64 newSerial) {
 
   if (!UpdateManager::self()->paused()) {
     // update the datasource
+    QTime t;
+    t.start();
     updated = internalDataSourceUpdate();
+    _updateTime = t.elapsed();
+
+    // the frame counts of this update are those found just now
+    QHash<QString, DataVector::DataInfo> lastInfo;
+    {
+      QMutexLocker ml(&_vectorInfoMutex);
+      lastInfo.swap(_vectorInfo);
+    }
+
+    // what was read ahead since the last update is for this one only
+    _readAhead = _readAheadPending;
+    _readAheadPending.clear();
 
     if (updated == Updated) {
       _serialOfLastChange = newSerial; // tell data objects it is new
+
+      if (appendsOnly()) {
+        // Only blocks from the old end of a field on can have changed.
+        // What is cached of fields not read since the last update is
+        // from even further back.
+        for (QHash<QString, DataVector::DataInfo>::ConstIterator it = lastInfo.constBegin(); it != lastInfo.constEnd(); ++it) {
+          const int blockFrames = BlockCache::blockFrames(it.value().samplesPerFrame);
+          BlockCache::self()->invalidate(this, it.key(), it.value().frameCount/blockFrames);
+        }
+      } else {
+        // appended to, or rewritten in place for all we know, so nothing
+        // cached from it can be trusted
+        BlockCache::self()->invalidate(this);
+      }
     }
   }
 
@@ -97,6 +129,322 @@ Object::UpdateType DataSource::objectUpdate(qint64 newSerial) {
 }
 
 
+void DataSource::readVectors(QList<VectorRead> &reads) {
+  for (int i = 0; i < reads.count(); ++i) {
+    VectorRead &read = reads[i];
+    DataVector::ReadInfo p = {read.data.data(), read.startingFrame, read.numberOfFrames, -1, 0L};
+    read.samplesRead = vector().read(read.field, p);
+  }
+}
+
+
+bool DataSource::readsFieldsTogether() const {
+  return false;
+}
+
+
+// Whatever the read ahead already has is left out.
+void DataSource::batchVectors(const QList<VectorRead> &reads) {
+  _vectorBatch.clear();
+  foreach (VectorRead read, reads) {
+    foreach (const VectorRead &ahead, _readAhead) {
+      if (ahead.field == read.field && ahead.samplesRead >= 0 &&
+          read.startingFrame >= ahead.startingFrame &&
+          read.startingFrame < ahead.startingFrame + ahead.numberOfFrames) {
+        const int end = read.startingFrame + read.numberOfFrames;
+        read.startingFrame = ahead.startingFrame + ahead.numberOfFrames;
+        read.numberOfFrames = end - read.startingFrame;
+      }
+    }
+    if (read.numberOfFrames < 1) {
+      continue;
+    }
+    read.samplesPerFrame = qMax(vectorInfo(read.field).samplesPerFrame, 1);
+    read.data.resize(read.numberOfFrames*read.samplesPerFrame);
+    read.samplesRead = -1;
+    _vectorBatch.append(read);
+  }
+  readVectors(_vectorBatch);
+}
+
+
+void DataSource::clearVectorBatch() {
+  _vectorBatch.clear();
+}
+
+
+static const DataSource::VectorRead *readHolding(const QList<DataSource::VectorRead> &reads, const QString &field, int frame) {
+  foreach (const DataSource::VectorRead &read, reads) {
+    if (read.field == field && read.samplesRead >= 0 &&
+        frame >= read.startingFrame && frame < read.startingFrame + read.numberOfFrames) {
+      return &read;
+    }
+  }
+  return 0;
+}
+
+
+int DataSource::readBatchedVector(const QString &field, DataVector::ReadInfo &p) {
+  if ((_readAhead.isEmpty() && _vectorBatch.isEmpty()) || p.numberOfFrames == 0) {
+    return -1;
+  }
+  const VectorRead *read = readHolding(_readAhead, field, p.startingFrame);
+  if (!read) {
+    read = readHolding(_vectorBatch, field, p.startingFrame);
+  }
+  if (!read) {
+    return -1;
+  }
+
+  // n < 0 is one sample, not one frame
+  const int frames = (p.numberOfFrames < 0) ? 1 : p.numberOfFrames;
+  const int held = qMin(frames, read->startingFrame + read->numberOfFrames - p.startingFrame);
+  const int first = (p.startingFrame - read->startingFrame)*read->samplesPerFrame;
+  const int wanted = (p.numberOfFrames < 0) ? 1 : held*read->samplesPerFrame;
+  const int available = qBound(0, read->samplesRead - first, wanted);
+  memcpy(p.data, read->data.constData() + first, available*sizeof(double));
+  if (available < wanted || held == frames) {
+    return available;
+  }
+
+  // the rest, from wherever it is
+  DataVector::ReadInfo rest = p;
+  rest.data += available;
+  rest.startingFrame += held;
+  rest.numberOfFrames = frames - held;
+  int more = readBatchedVector(field, rest);
+  if (more < 0) {
+    more = readCachedVector(field, rest);
+  }
+  if (more < 0) {
+    more = vector().read(field, rest);
+  }
+  return available + qMax(more, 0);
+}
+
+
+// Blocks the file has all of come from the cache, or are cached when read
+// whole; from the first block the file doesn't have all of on, the frames
+// are read from the source as they would have been.
+int DataSource::readCachedVector(const QString &field, DataVector::ReadInfo &p) {
+  BlockCache *cache = BlockCache::self();
+  if (p.numberOfFrames < 1 || p.skipFrame > 1 || p.decimation != DataVector::FirstSample || !cache->isEnabled()) {
+    return -1;
+  }
+
+  const DataVector::DataInfo info = vectorInfo(field);
+  const int spf = qMax(info.samplesPerFrame, 1);
+  const int blockFrames = BlockCache::blockFrames(spf);
+  const int wholeBlocks = info.frameCount/blockFrames;
+  const int end = p.startingFrame + p.numberOfFrames;
+
+  int n_read = 0;
+  int frame = p.startingFrame;
+  while (frame < end && frame/blockFrames < wholeBlocks) {
+    const int block = frame/blockFrames;
+    const int frames = qMin(end, (block + 1)*blockFrames) - frame;
+    QVector<double> samples;
+    if (cache->find(this, field, block, samples)) {
+      memcpy(p.data + n_read, samples.constData() + (frame - block*blockFrames)*spf, frames*spf*sizeof(double));
+    } else {
+      // only a read of the whole block fills it in: a few new frames at the
+      // end of a block don't cost a read of all of it
+      DataVector::ReadInfo part = {p.data + n_read, frame, frames, -1, 0L};
+      if (frames == blockFrames) {
+        samples.resize(blockFrames*spf);
+        part.data = samples.data();
+      }
+      const int got = vector().read(field, part);
+      if (frames == blockFrames && got > 0) {
+        memcpy(p.data + n_read, samples.constData(), got*sizeof(double));
+      }
+      if (got != frames*spf) {
+        if (n_read == 0) {
+          return got;
+        }
+        return n_read + qMax(got, 0);
+      }
+      if (frames == blockFrames) {
+        cache->insert(this, field, block, samples);
+      }
+    }
+    n_read += frames*spf;
+    frame += frames;
+  }
+
+  if (frame < end) {
+    DataVector::ReadInfo rest = p;
+    rest.data += n_read;
+    rest.startingFrame = frame;
+    rest.numberOfFrames = end - frame;
+    const int more = vector().read(field, rest);
+    if (n_read == 0) {
+      return more;
+    }
+    n_read += qMax(more, 0);
+  }
+  return n_read;
+}
+
+
+// What a read ahead job knows of its source: stopReadAhead() sets source to
+// 0 under the mutex, so a job which runs after that does nothing, and one
+// which is running holds it off until it is done.
+struct DataSourceReadAheadGuard
+{
+  DataSourceReadAheadGuard(DataSource *s) : source(s) {}
+  QMutex mutex;
+  DataSource *source;
+};
+
+
+// Runs DataSource::readAheadNow() on the source's read ahead thread.
+class DataSourceReadAheadJob : public QRunnable
+{
+  public:
+    DataSourceReadAheadJob(const QSharedPointer<DataSourceReadAheadGuard> &guard) : _guard(guard) {}
+
+    void run() {
+      QMutexLocker ml(&_guard->mutex);
+      if (_guard->source) {
+        _guard->source->readAheadNow();
+      }
+    }
+
+  private:
+    QSharedPointer<DataSourceReadAheadGuard> _guard;
+};
+
+
+DataVector::DataInfo DataSource::vectorInfo(const QString &field) {
+  QMutexLocker ml(&_vectorInfoMutex);
+  QHash<QString, DataVector::DataInfo>::ConstIterator it = _vectorInfo.constFind(field);
+  if (it != _vectorInfo.constEnd()) {
+    return it.value();
+  }
+  const DataVector::DataInfo info = vector().dataInfo(field);
+  _vectorInfo.insert(field, info);
+  return info;
+}
+
+
+bool DataSource::readsPastFrameCount() const {
+  return false;
+}
+
+
+bool DataSource::appendsOnly() const {
+  return false;
+}
+
+
+void DataSource::readAhead(const QString &field, int frame) {
+  if (!readsPastFrameCount()) {
+    return;
+  }
+  ReadAheadField &ahead = _readAheadFields[field];
+  if (!ahead.wanted) {
+    ahead.growth = qMax(frame - ahead.frame, 0);
+    ahead.frame = frame;
+    ahead.wanted = true;
+  } else if (frame < ahead.frame) {
+    ahead.frame = frame;
+  }
+  QMutexLocker ml(&_readAheadMutex);
+  _readAheadWanted = true;
+}
+
+
+// At most one read ahead is queued at a time.  Returns false if there is
+// nobody to read ahead for, and the update should be asked for right away.
+bool DataSource::startReadAhead() {
+  QMutexLocker ml(&_readAheadMutex);
+  if (!_readAheadWanted || _readAheadStopped) {
+    return false;
+  }
+  if (!_readAheadQueued) {
+    if (!_readAheadThread) {
+      _readAheadThread = new QThreadPool(this);
+      _readAheadThread->setMaxThreadCount(1);
+    }
+    _readAheadQueued = true;
+    _readAheadThread->start(new DataSourceReadAheadJob(_readAheadGuard));
+  }
+  return true;
+}
+
+
+void DataSource::stopReadAhead() {
+  {
+    QMutexLocker ml(&_readAheadMutex);
+    if (_readAheadStopped) {
+      return;
+    }
+    _readAheadStopped = true;
+    _readAheadWanted = false;
+  }
+  {
+    QMutexLocker ml(&_readAheadGuard->mutex);
+    _readAheadGuard->source = 0;
+  }
+  if (_readAheadThread) {
+    _readAheadThread->waitForDone();
+  }
+}
+
+
+// Reads on from where the followers are, past the frame count of the last
+// update: the source isn't updated here, so an update in progress sees the
+// frame count it started with.  Whatever comes back is kept for the next
+// update, which finds out how much of it is really there.
+void DataSource::readAheadNow() {
+  writeLock();
+  QList<VectorRead> reads;
+  qint64 frames = 0;
+  for (QHash<QString, ReadAheadField>::Iterator it = _readAheadFields.begin(); it != _readAheadFields.end(); ++it) {
+    if (!it.value().wanted) {
+      continue;
+    }
+    // the followers say again what they want when they have read these
+    it.value().wanted = false;
+
+    if (frames + MinReadAheadFrames > MaxReadAheadFrames) {
+      continue;
+    }
+    VectorRead read;
+    read.field = it.key();
+    read.startingFrame = it.value().frame;
+    read.numberOfFrames = qBound(int(MinReadAheadFrames), 2*it.value().growth, int(MaxReadAheadFrames - frames));
+    read.samplesPerFrame = qMax(vectorInfo(it.key()).samplesPerFrame, 1);
+    read.samplesRead = -1;
+    frames += read.numberOfFrames;
+    read.data.resize(read.numberOfFrames*read.samplesPerFrame);
+    reads.append(read);
+  }
+  readVectors(reads);
+
+  // only whole frames: the last may still be being written
+  _readAheadPending.clear();
+  foreach (VectorRead read, reads) {
+    read.numberOfFrames = qMax(read.samplesRead, 0)/read.samplesPerFrame;
+    if (read.numberOfFrames > 0) {
+      read.samplesRead = read.numberOfFrames*read.samplesPerFrame;
+      read.data.resize(read.samplesRead);
+      _readAheadPending.append(read);
+    }
+  }
+
+  {
+    QMutexLocker ml(&_readAheadMutex);
+    _readAheadWanted = false;
+    _readAheadQueued = false;
+  }
+  unlock();
+
+  QMetaObject::invokeMethod(UpdateManager::self(), "doUpdates", Qt::QueuedConnection);
+}
+
+
 void DataSource::_initializeShortName() {
   _shortName = QString("DS%1").arg(_dsnum);
   if (_dsnum>max_dsnum)
@@ -142,7 +490,13 @@ DataSource::DataSource(ObjectStore *store, QSettings *cfg, const QString& filena
   interf_vector(new NotSupportedImp<DataVector>),
   interf_matrix(new NotSupportedImp<DataMatrix>),
   _watcher(0),
-  _color(NextColor::self().next())
+  _color(NextColor::self().next()),
+  _updateTime(0),
+  _readAheadThread(0),
+  _readAheadGuard(new DataSourceReadAheadGuard(this)),
+  _readAheadWanted(false),
+  _readAheadQueued(false),
+  _readAheadStopped(false)
 {
   Q_UNUSED(type)
   Q_UNUSED(store)
@@ -161,6 +515,9 @@ DataSource::DataSource(ObjectStore *store, QSettings *cfg, const QString& filena
 }
 
 DataSource::~DataSource() {
+  // the sources have stopped it already; this is for those which don't
+  stopReadAhead();
+  BlockCache::self()->invalidate(this);
   resetFileWatcher();
   delete interf_scalar;
   delete interf_string;
@@ -223,7 +580,7 @@ void DataSource::setUpdateType(UpdateCheckType updateType, const QString& file)
   _updateCheckType = updateType;
   resetFileWatcher();
   if (_updateCheckType == Timer) {
-    QTimer::singleShot(UpdateManager::self()->minimumUpdatePeriod()-1, this, SLOT(checkUpdate()));
+    QTimer::singleShot(UpdateManager::self()->updatePeriod()-1, this, SLOT(checkUpdate()));
   } else if (_updateCheckType == File) {
     // TODO only works on local files:
     // http://bugreports.qt.nokia.com/browse/QTBUG-8351
@@ -238,12 +595,12 @@ void DataSource::setUpdateType(UpdateCheckType updateType, const QString& file)
 
 
 void DataSource::checkUpdate() {
-  if (!UpdateManager::self()->paused()) {
+  if (!UpdateManager::self()->paused() && !startReadAhead()) {
     UpdateManager::self()->doUpdates(false);
   }
 
   if (_updateCheckType == Timer) {
-    QTimer::singleShot(UpdateManager::self()->minimumUpdatePeriod()-1, this, SLOT(checkUpdate()));
+    QTimer::singleShot(UpdateManager::self()->updatePeriod()-1, this, SLOT(checkUpdate()));
   }
 }
 
@@ -315,6 +672,19 @@ bool DataSource::isEmpty() const {
 
 
 void DataSource::reset() {
+  {
+    QMutexLocker ml(&_readAheadMutex);
+    _readAheadWanted = false;
+  }
+  _readAheadFields.clear();
+  _readAheadPending.clear();
+  _readAhead.clear();
+  _vectorBatch.clear();
+  {
+    QMutexLocker ml(&_vectorInfoMutex);
+    _vectorInfo.clear();
+  }
+  BlockCache::self()->invalidate(this);
   Object::reset();
 }
 
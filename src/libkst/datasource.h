@@ -30,16 +30,23 @@
 
 #include <QRunnable>
 #include <QDialog>
+#include <QHash>
 #include <QMap>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
 
 class QSettings;
 class QXmlStreamWriter;
 class QXmlStreamAttributes;
 class QFileSystemWatcher;
+class QThreadPool;
+class TestDataSource;
 
 namespace Kst {
 
 class DataSourceConfigWidget;
+struct DataSourceReadAheadGuard;
 //class DataSourcePlugin;
 
 
@@ -108,6 +115,14 @@ class KSTCORE_EXPORT DataSource : public Object
 
     virtual UpdateType objectUpdate(qint64 newSerial);
 
+    /** vector().dataInfo(field) as it was when the current update began:
+      * all the reads of one update see the same frame count.  Only
+      * objectUpdate() and reset() start over. */
+    DataVector::DataInfo vectorInfo(const QString &field);
+
+    /** time taken by the last internalDataSourceUpdate(), in ms */
+    int updateTime() const { return _updateTime; }
+
     void internalUpdate() {return;}
     qint64 minInputSerial() const {return 0;}
     qint64 maxInputSerialOfLastChange() const {return 0;}
@@ -118,6 +133,74 @@ class KSTCORE_EXPORT DataSource : public Object
     virtual UpdateType internalDataSourceUpdate() = 0;
 
 
+    /************************************************************/
+    /* Reading several vectors at once                          */
+    /************************************************************/
+
+    /** frames of one field, for readVectors() */
+    struct KSTCORE_EXPORT VectorRead {
+      QString field;
+      int startingFrame;
+      int numberOfFrames;
+      int samplesPerFrame;
+      QVector<double> data; // numberOfFrames*samplesPerFrame, to be filled in
+      int samplesRead;      // what vector().read() would have returned
+    };
+
+    /** Fill in all of reads.  The default reads them one at a time through
+      * vector().  Called with the source write locked. */
+    virtual void readVectors(QList<VectorRead> &reads);
+
+    /** Whether readVectors() reads several fields for not much more than
+      * the price of one, as a row oriented format does: only then does
+      * UpdateManager gather the reads of an update into one call. */
+    virtual bool readsFieldsTogether() const;
+
+    /** Read reads now, and keep them for the vector reads which fall inside
+      * them until clearVectorBatch().  Both with the source write locked. */
+    void batchVectors(const QList<VectorRead> &reads);
+    void clearVectorBatch();
+
+    /** As vector().read(), from the read ahead or the batch: -1 if neither
+      * has the frame p starts at.  Whatever comes after what they have is
+      * read from the source. */
+    int readBatchedVector(const QString &field, DataVector::ReadInfo &p);
+
+    /** As vector().read(), through the BlockCache: -1 if the cache is off
+      * or p isn't a plain read of whole frames.  With the source write
+      * locked. */
+    int readCachedVector(const QString &field, DataVector::ReadInfo &p);
+
+
+    /************************************************************/
+    /* Reading ahead for vectors which follow the file          */
+    /************************************************************/
+
+    /** A vector following the end of the file will next read field from
+      * frame on.  Between updates, a source which readsPastFrameCount()
+      * reads the frames from there on, as many as came last time and more,
+      * on a thread of its own, and the update is only asked for when they
+      * are in memory.  What was read serves the next update only.  With the
+      * source write locked. */
+    void readAhead(const QString &field, int frame);
+
+    /** Drop the queued read ahead and wait for one which is running.  Every
+      * source calls this first thing in its destructor, while what the read
+      * ahead reads through is still there; no read ahead starts after. */
+    void stopReadAhead();
+
+    /** Whether a vector read past the frame count internalDataSourceUpdate()
+      * last found simply comes back short, rather than failing or warning.
+      * Only then is it read ahead.  The default is false. */
+    virtual bool readsPastFrameCount() const;
+
+    /** Whether the file only ever changes by frames added at the end, so
+      * that the frames it had are still good after an update finds it
+      * changed: only then is what the BlockCache has of them kept.  The
+      * default is false. */
+    virtual bool appendsOnly() const;
+
+
     /************************************************************/
     /* Methods for handling time in vectors.                    */
     /* not currently used - may be reworked (remove this note   */
@@ -269,6 +352,34 @@ class KSTCORE_EXPORT DataSource : public Object
     QFileSystemWatcher *_watcher;
 
     QColor _color;
+
+    int _updateTime;
+
+    QList<VectorRead> _vectorBatch;
+
+    QHash<QString, DataVector::DataInfo> _vectorInfo; // of this update
+    QMutex _vectorInfoMutex;
+
+    friend class DataSourceReadAheadJob;
+    friend class ::TestDataSource;
+    enum { MinReadAheadFrames = 256, MaxReadAheadFrames = 4*1024*1024 };
+    bool startReadAhead();
+    void readAheadNow();
+    struct ReadAheadField {
+      ReadAheadField() : frame(0), growth(0), wanted(false) {}
+      int frame;   // the next frame the followers want
+      int growth;  // how far that moved on last time
+      bool wanted; // asked for since the last read ahead
+    };
+    QHash<QString, ReadAheadField> _readAheadFields;
+    QList<VectorRead> _readAheadPending;  // read since the last update
+    QList<VectorRead> _readAhead;         // what this update may use of it
+    QThreadPool *_readAheadThread;
+    QSharedPointer<DataSourceReadAheadGuard> _readAheadGuard; // what the jobs hold
+    QMutex _readAheadMutex; // for these three
+    bool _readAheadWanted;
+    bool _readAheadQueued;
+    bool _readAheadStopped;
     // NOTE: You must bump the version key if you add new member variables
     //       or change or add virtual functions.
 };
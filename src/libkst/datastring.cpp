@@ -121,6 +121,15 @@ void DataString::internalUpdate() {
   }
 }
 
+QList<ObjectPtr> DataString::inputObjects() const {
+  QList<ObjectPtr> inputs = Primitive::inputObjects();
+  DataSourcePtr ds = dataSource();
+  if (ds) {
+    inputs.append(ObjectPtr(ds.data()));
+  }
+  return inputs;
+}
+
 qint64 DataString::minInputSerial() const {
   if (dataSource()) {
     return (dataSource()->serial());
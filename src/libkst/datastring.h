@@ -48,6 +48,7 @@ class KSTCORE_EXPORT DataString : public String, public DataPrimitive
   public:
     virtual ~DataString();
     virtual void internalUpdate();
+    virtual QList<ObjectPtr> inputObjects() const;
 
     struct KSTCORE_EXPORT ReadInfo 
     {
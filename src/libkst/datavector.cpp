@@ -23,15 +23,23 @@
 #include <stdlib.h>
 
 #include <QDebug>
+#include <QMultiHash>
+#include <QMutex>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
 #include <QXmlStreamWriter>
 
 #include "kst_i18n.h"
 
+#include "bufferstore.h"
 #include "datacollection.h"
 #include "debug.h"
 #include "datasource.h"
 #include "math_kst.h"
 #include "objectstore.h"
+#include "statistics_kst.h"
 #include "updatemanager.h"
 
 // ReqNF <=0 means read from ReqF0 to end of File
@@ -49,17 +57,26 @@ namespace Kst {
 const QString DataVector::staticTypeString = I18N_NOOP("Data Vector");
 const QString DataVector::staticTypeTag = I18N_NOOP("datavector");
 
+// The vectors which read for themselves, and maybe for followers, by
+// shareKey().  The lock is only ever taken last.
+static QMultiHash<QString, DataVector*> _sharedReaders;
+static QMutex _sharedReadersLock;
+
 
 DataVector::DataInfo::DataInfo() :
     frameCount(-1),
-    samplesPerFrame(-1)
+    samplesPerFrame(-1),
+    readsSkip(false),
+    decimations(0)
 {
 }
 
 
-DataVector::DataInfo::DataInfo(int fc, int spf) :
+DataVector::DataInfo::DataInfo(int fc, int spf, bool skip, int dec) :
     frameCount(fc),
-    samplesPerFrame(spf)
+    samplesPerFrame(spf),
+    readsSkip(skip),
+    decimations(dec)
 {
 }
 
@@ -76,6 +93,11 @@ DataVector::DataVector(ObjectStore *store)
 
   N_AveReadBuf = 0;
   AveReadBuf = 0L;
+  _readBuffer = 0L;
+
+  _readSerial = 0;
+  _lastUnchanged = 0;
+  _leaderReadSerial = -1;
 
   ReqF0 = 0;
   ReqNF = -1;
@@ -118,6 +140,8 @@ void DataVector::change(DataSourcePtr in_file, const QString &in_field,
                         bool in_DoAve) {
   Q_ASSERT(myLockStatus() == KstRWLock::WRITELOCKED);
 
+  unshare();
+
   Skip = in_skip;
   DoSkip = in_DoSkip;
   DoAve = in_DoAve;
@@ -142,21 +166,46 @@ void DataVector::change(DataSourcePtr in_file, const QString &in_field,
   if (ReqNF <= 0 && ReqF0 < 0) {
     ReqF0 = 0;
   }
+  share();
   registerChange();
 }
 
+QList<ObjectPtr> DataVector::inputObjects() const {
+  QList<ObjectPtr> inputs = Primitive::inputObjects();
+  DataSourcePtr ds = dataSource();
+  if (ds) {
+    inputs.append(ObjectPtr(ds.data()));
+  }
+  DataVectorPtr leader = sharesWith();
+  if (leader) {
+    inputs.append(ObjectPtr(leader.data()));
+  }
+  return inputs;
+}
+
 qint64 DataVector::minInputSerial() const {
+  qint64 serial = LLONG_MAX;
   if (dataSource()) {
-    return (dataSource()->serial());
+    serial = dataSource()->serial();
   }
-  return LLONG_MAX;
+  // a leader which has left the store won't be updated: see followLeader()
+  DataVectorPtr leader = sharesWith();
+  if (leader && leader->store()) {
+    serial = qMin(serial, leader->serial());
+  }
+  return serial;
 }
 
 qint64 DataVector::maxInputSerialOfLastChange() const {
+  qint64 serial = NoInputs;
   if (dataSource()) {
-    return (dataSource()->serialOfLastChange());
+    serial = dataSource()->serialOfLastChange();
+  }
+  DataVectorPtr leader = sharesWith();
+  if (leader) {
+    serial = qMax(serial, leader->serialOfLastChange());
   }
-  return NoInputs;
+  return serial;
 }
 
 
@@ -166,6 +215,7 @@ void DataVector::changeFile(DataSourcePtr in_file) {
   if (!in_file) {
     Debug::self()->log(i18n("Data file for vector %1 was not opened.", Name()), Debug::Warning);
   }
+  unshare();
   setDataSource(in_file);
   if (dataSource()) {
     dataSource()->writeLock();
@@ -174,6 +224,7 @@ void DataVector::changeFile(DataSourcePtr in_file) {
   if (dataSource()) {
     dataSource()->unlock();
   }
+  share();
   registerChange();
 }
 
@@ -183,6 +234,7 @@ void DataVector::changeFrames(int in_f0, int in_n,
                               bool in_DoAve) {
   Q_ASSERT(myLockStatus() == KstRWLock::WRITELOCKED);
 
+  unshare();
   if (dataSource()) {
     dataSource()->writeLock();
   }
@@ -203,6 +255,20 @@ void DataVector::changeFrames(int in_f0, int in_n,
   if (ReqNF <= 0 && ReqF0 < 0) {
     ReqF0 = 0;
   }
+  share();
+  registerChange();
+}
+
+
+void DataVector::setStorageType(StorageType type) {
+  Q_ASSERT(myLockStatus() == KstRWLock::WRITELOCKED);
+
+  if (type == storageType()) {
+    return;
+  }
+  unshare();
+  Vector::setStorageType(type);
+  share();
   registerChange();
 }
 
@@ -210,6 +276,7 @@ void DataVector::changeFrames(int in_f0, int in_n,
 void DataVector::setFromEnd() {
   Q_ASSERT(myLockStatus() == KstRWLock::WRITELOCKED);
 
+  unshare();
   ReqF0 = -1;
   if (ReqNF < 2) {
     ReqNF = numFrames();
@@ -217,15 +284,28 @@ void DataVector::setFromEnd() {
       ReqF0 = 0;
     }
   }
+  share();
   registerChange();
 }
 
 
 DataVector::~DataVector() {
+  // a leader can't have followers by now: they hold on to it
+  {
+    QMutexLocker ml(&_sharedReadersLock);
+    if (_leader) {
+      _leader->_followers.removeAll(this);
+    }
+    if (!_shareKey.isEmpty()) {
+      _sharedReaders.remove(_shareKey, this);
+    }
+  }
+
   if (AveReadBuf) {
-    free(AveReadBuf);
+    BufferStore::self()->release(AveReadBuf);
     AveReadBuf = 0L;
   }
+  BufferStore::self()->release(_readBuffer);
 }
 
 
@@ -300,6 +380,10 @@ void DataVector::save(QXmlStreamWriter &s) {
     s.writeAttribute("startUnits", startUnits());
     s.writeAttribute("rangeUnits", rangeUnits());
 
+    if (storageType() != DoubleStorage) {
+      s.writeAttribute("storage", storageTypeName(storageType()));
+    }
+
     saveNameInfo(s, VNUM|XNUM);
     s.writeEndElement();
   }
@@ -403,11 +487,80 @@ void DataVector::checkIntegrity() {
 //     read with skip enabled are read on 'skip boundries'... ie, the first samples of
 //     frame 0, Skip, 2*Skip... N*skip, and never M*Skip+1.
 
+// The frames asked for, out of the fc in the file.
+void DataVector::requestedFrames(int fc, int &f0, int &nf, bool &pastEof) const {
+  pastEof = false;
+  if (ReqNF < 1) { // read to end of file
+    f0 = ReqF0;
+    nf = fc - f0;
+  } else if (ReqF0 < 0) { // count back from end of file
+    nf = fc;
+    if (nf > ReqNF) {
+      nf = ReqNF;
+    }
+    f0 = fc - nf;
+  } else {
+    f0 = ReqF0;
+    nf = ReqNF;
+    if (f0 + nf > fc) {
+      nf = fc - f0;
+    }
+    if (nf <= 0) {
+      // Tried to read starting past the end.
+      f0 = 0;
+      nf = 1;
+      pastEof = true;
+    }
+  }
+}
+
+
+// The frames the next internalUpdate() will read, reckoned the same way,
+// so that UpdateManager can read them along with the other fields of the
+// source.  Only plain reads: skipping vectors read on their own.
+bool DataVector::plannedRead(int &startingFrame, int &numberOfFrames) const {
+  if (sharesWith() || !dataSource() || (DoSkip && (Skip > 1 || SPF != 1))) {
+    return false;
+  }
+
+  const DataInfo info = dataInfo(_field);
+  int f0, nf;
+  bool pastEof;
+  requestedFrames(info.frameCount, f0, nf, pastEof);
+  if (pastEof) {
+    return false;
+  }
+
+  // what is kept after shifting, less the partly read last frame
+  int kept = 0;
+  if (f0 >= F0 && f0 < F0 + NF) {
+    kept = qMax(NF - (f0 - F0) - 1, 0);
+  }
+  if (nf - kept <= 0) {
+    return false;
+  }
+
+  startingFrame = f0 + kept;
+  numberOfFrames = nf - kept;
+  return true;
+}
+
+
 void DataVector::internalUpdate() {
-  int i, k, shift, n_read=0;
-  int ave_nread;
+  int i, shift, n_read=0;
   int new_f0, new_nf;
   bool start_past_eof = false;
+  bool shifted = false;
+
+  // a duplicate of another vector takes what that one has just read
+  if (followLeader()) {
+    Vector::internalUpdate();
+    return;
+  }
+  if (!detachBuffer()) {
+    fatalError("Not enough memory for vector data");
+    return;
+  }
 
   if (dataSource()) {
     dataSource()->writeLock();
@@ -418,35 +571,17 @@ void DataVector::internalUpdate() {
   const DataInfo info = dataInfo(_field);
   checkIntegrity();
 
+  // Counting back from the end of the file drops the oldest frames on
+  // every update; leave room to do that without moving the rest.
+  setScrolling(ReqF0 < 0);
+
   if (DoSkip && Skip < 2 && SPF == 1) {
     DoSkip = false;
   }
 
 
   // set new_nf and new_f0
-  int fc = info.frameCount;
-  if (ReqNF < 1) { // read to end of file
-    new_f0 = ReqF0;
-    new_nf = fc - new_f0;
-  } else if (ReqF0 < 0) { // count back from end of file
-    new_nf = fc;
-    if (new_nf > ReqNF) {
-      new_nf = ReqNF;
-    }
-    new_f0 = fc - new_nf;
-  } else {
-    new_f0 = ReqF0;
-    new_nf = ReqNF;
-    if (new_f0 + new_nf > fc) {
-      new_nf = fc - new_f0;
-    }
-    if (new_nf <= 0) {
-      // Tried to read starting past the end.
-      new_f0 = 0;
-      new_nf = 1;
-      start_past_eof = true;
-    }
-  }
+  requestedFrames(info.frameCount, new_f0, new_nf, start_past_eof);
 
   if (DoSkip) {
     // change new_f0 and new_nf so they both lie on skip boundaries
@@ -470,84 +605,56 @@ void DataVector::internalUpdate() {
       _numSamples = (NF-1)*SPF;
     }
 
-    memmove(_v, _v+shift, _numSamples*sizeof(double));
+    if (_scrolling) {
+      Vector::shift(shift);
+    } else if (_f) {
+      memmove(_f, _f+shift, _numSamples*sizeof(float));
+    } else {
+      memmove(_v, _v+shift, _numSamples*sizeof(double));
+    }
+    shifted = (shift > 0);
   }
 
   if (DoSkip) {
     // reallocate V if necessary
     if (new_nf / Skip != _size) {
       if (! resize(new_nf/Skip)) {
-        // TODO: Is aborting all we can do?
-        fatalError("Not enough memory for vector data");
+        abortUpdate();
         return;
       }
     }
-    // FIXME maybe.
-    //   -skip acceleration is not supported by any current data sources.
-    //   -there is no API implemented to report if a data source implements skip accel
-    // so: for now, just say it isn't supported here.  Fix if we ever implement a data source
-    //     where skip accel is important (eg, planck HFI...)
-#if 0
-    _dontUseSkipAccel = true;
-    if (!_dontUseSkipAccel) { // ie, use skip accel.  Not used.
-      int rc;
-      int lastRead = -1;
-      if (DoAve) {
-        // We don't support boxcar inside data sources yet.
-        _dontUseSkipAccel = true;
-      } else {
-        rc = readField(_v + _numSamples, _field, new_f0, (new_nf - NF)/Skip, Skip, &lastRead);
-        if (rc != -9999) {
-          if (rc >= 0) {
-            n_read = rc;
-          } else {
-            n_read = 0;
-          }
-        } else {
-          _dontUseSkipAccel = true;
-        }
-      }
-    }
-#endif
-//  if (_dontUseSkipAccel) {
     n_read = 0;
     /** read each sample from the File */
-    double *t = _v + _numSamples;
+    const int readFrom = _numSamples;
+    double *t = readBuffer(readFrom);
+    if (!t) {
+      abortUpdate();
+      return;
+    }
     int new_nf_Skip = new_nf - Skip;
+    const int count = (new_nf_Skip >= NF) ? (new_nf_Skip - NF)/Skip + 1 : 0;
     if (DoAve) {
-      for (i = NF; new_nf_Skip >= i; i += Skip) {
-        /* enlarge AveReadBuf if necessary */
-        if (N_AveReadBuf < Skip*SPF) {
-          N_AveReadBuf = Skip*SPF;
-          if (!kstrealloc(AveReadBuf, N_AveReadBuf*sizeof(double))) {
-            qCritical() << "Vector resize failed";
-          }
-          if (!AveReadBuf) {
-            // FIXME: handle failed resize
-          }
-        }
-        ave_nread = readField(AveReadBuf, _field, new_f0+i, Skip);
-        for (k = 1; k < ave_nread; k++) {
-          AveReadBuf[0] += AveReadBuf[k];
-        }
-        if (ave_nread > 0) {
-          *t = AveReadBuf[0]/double(ave_nread);
-          n_read++;
-        }
-        ++t;
+      if (count > 0 && (info.decimations & MeanOfFrames)) {
+        n_read = qMax(readField(t, _field, new_f0 + NF, count, Skip, 0, MeanOfFrames), 0);
+      } else if (count > 0) {
+        n_read = readAveraged(t, new_f0 + NF, count, Skip, SPF);
+      }
+    } else if (info.readsSkip && Skip > 1) {
+      // the source decimates: one read rather than one for every sample
+      if (count > 0) {
+        n_read = qMax(readField(t, _field, new_f0 + NF, count, Skip), 0);
       }
     } else {
       for (i = NF; new_nf_Skip >= i; i += Skip) {
         n_read += readField(t++, _field, new_f0 + i, -1);
       }
     }
-//  } // end if _dontUseSkipAccel
+    storeReadBuffer(readFrom);
   } else {
     // reallocate V if necessary
     if ((new_nf - 1)*SPF + 1 != _size) {
       if (!resize((new_nf - 1)*SPF + 1)) {
-        // TODO: Is aborting all we can do?
-        fatalError("Not enough memory for vector data");
+        abortUpdate();
         return;
       }
     }
@@ -557,8 +664,14 @@ void DataVector::internalUpdate() {
     }
 
     // read the new data from file
+    const int readFrom = start_past_eof ? 0 : NF*SPF;
+    double *t = readBuffer(readFrom);
+    if (!t) {
+      abortUpdate();
+      return;
+    }
     if (start_past_eof) {
-      _v[0] = NOPOINT;
+      t[0] = NOPOINT;
       n_read = 1;
     } else if (info.samplesPerFrame > 1) {
       int safe_nf = (new_nf>0 ? new_nf : 0);
@@ -566,15 +679,16 @@ void DataVector::internalUpdate() {
       assert(new_f0 + NF >= 0);
       //assert(new_f0 + safe_nf - 1 >= 0);
       if (new_f0 + safe_nf - 1 >= 0) {
-        n_read = readField(_v+NF*SPF, _field, new_f0 + NF, safe_nf - NF - 1);
-        n_read += readField(_v+(safe_nf-1)*SPF, _field, new_f0 + safe_nf - 1, -1);
+        n_read = readField(t, _field, new_f0 + NF, safe_nf - NF - 1);
+        n_read += readField(t+(safe_nf-1)*SPF-readFrom, _field, new_f0 + safe_nf - 1, -1);
       }
     } else {
       assert(new_f0 + NF >= 0);
       if (new_nf - NF > 0 || new_nf - NF == -1) {
-        n_read = readField(_v+NF*SPF, _field, new_f0 + NF, new_nf - NF);
+        n_read = readField(t, _field, new_f0 + NF, new_nf - NF);
       }
     }
+    storeReadBuffer(readFrom);
   }
   NumNew = _size - _numSamples;
   NF = new_nf;
@@ -591,8 +705,14 @@ void DataVector::internalUpdate() {
   _dirty = false;
   if (_numSamples != _size && !(_numSamples == 0 && _size == 1)) {
     _dirty = true;
-    for (i = _numSamples; i < _size; i++) {
-      _v[i] = _v[0];
+    if (_f) {
+      for (i = _numSamples; i < _size; i++) {
+        _f[i] = _f[0];
+      }
+    } else {
+      for (i = _numSamples; i < _size; i++) {
+        _v[i] = _v[0];
+      }
     }
   }
 
@@ -603,7 +723,20 @@ void DataVector::internalUpdate() {
     NumShifted = _size;
   }
 
+  // Everything before the new samples is as it was, if moved down by the
+  // shift; unless the data moved, Vector only has to work out the
+  // statistics of what was added.
+  _unchangedSamples = start_past_eof ? 0 : _size - NumNew;
+  _shiftedSamples = shifted ? shift : 0;
+  _lastUnchanged = shifted ? 0 : _unchangedSamples;
+  ++_readSerial;
+
   if (dataSource()) {
+    // following the end of the file, the frames from the partly read last
+    // one on are wanted next: the source can read them ahead
+    if ((ReqNF < 1 || ReqF0 < 0) && !DoSkip) {
+      dataSource()->readAhead(_field, F0 + qMax(NF - 1, 0));
+    }
     dataSource()->unlock();
   }
 
@@ -764,6 +897,7 @@ PrimitivePtr DataVector::makeDuplicate() const {
 
   vector->writeLock();
   vector->change(dataSource(), _field, ReqF0, ReqNF, Skip, DoSkip, DoAve);
+  vector->setStorageType(storageType());
   if (descriptiveNameIsManual()) {
     vector->setDescriptiveName(descriptiveName());
   }
@@ -808,6 +942,10 @@ QString DataVector::descriptionTip() const {
       IDstring+=i18n("\n  Average each %1 frames.").arg(skip());
     }
   }
+  DataVectorPtr leader = sharesWith();
+  if (leader) {
+    IDstring += i18n("\n  Samples shared with %1.").arg(leader->Name());
+  }
   return IDstring;
 }
 
@@ -816,16 +954,279 @@ QString DataVector::propertyString() const {
 }
 
 
-int DataVector::readField(double *v, const QString& field, int s, int n, int skip, int *lastFrameRead)
+QString DataVector::shareKey() const {
+  return QString("%1|%2|%3|%4|%5|%6|%7").arg(quintptr(dataSource().data())).arg(_field)
+         .arg(ReqF0).arg(ReqNF).arg(DoSkip ? Skip : 0).arg(DoSkip && DoAve).arg(int(storageType()));
+}
+
+
+// Follow a vector which already reads what we are about to, or read for
+// any which come later.  We don't borrow anything until our next update,
+// which the leader, as one of our inputs, will have had first.
+void DataVector::share() {
+  if (!dataSource() || !store()) {
+    return;
+  }
+
+  const QString key = shareKey();
+  QMutexLocker ml(&_sharedReadersLock);
+  if (_leader || !_shareKey.isEmpty()) {
+    return;
+  }
+  foreach (DataVector *reader, _sharedReaders.values(key)) {
+    if (reader != this && reader->store() == store()) {
+      _leader = reader;
+      _leaderReadSerial = -1;
+      reader->_followers.append(this);
+      return;
+    }
+  }
+  _sharedReaders.insert(key, this);
+  _shareKey = key;
+}
+
+
+// Before this vector changes: a leader hands its followers over to the
+// first of them, which reads for the rest from then on.  Nobody else is
+// locked here, as they may be updating, and waiting on us: what was
+// borrowed stays as it is until its holder next updates, as the buffers are
+// only ever changed in a copy while they are shared.
+void DataVector::unshare() {
+  DataVectorPtr keep(this); // our followers may hold the last references
+  DataVectorPtr leader;
+  DataVectorPtr heir;
+  QList<DataVector*> followers;
+  {
+    QMutexLocker ml(&_sharedReadersLock);
+    leader = _leader; // let go of after the unlock
+    if (leader) {
+      leader->_followers.removeAll(this);
+      _leader = 0;
+    }
+    followers = _followers;
+    _followers.clear();
+    if (!_shareKey.isEmpty()) {
+      _sharedReaders.remove(_shareKey, this);
+      if (!followers.isEmpty()) {
+        heir = followers.takeFirst();
+        heir->_leader = 0;
+        heir->_shareKey = _shareKey;
+        _sharedReaders.insert(_shareKey, heir.data());
+        foreach (DataVector *follower, followers) {
+          follower->_leader = heir;
+          follower->_leaderReadSerial = -1;
+          heir->_followers.append(follower);
+        }
+      }
+      _shareKey.clear();
+    }
+  }
+
+  if (!detachBuffer()) {
+    fatalError("Not enough memory for vector data");
+  }
+  if (heir) {
+    heir->registerChange();
+    foreach (DataVector *follower, followers) {
+      follower->registerChange();
+    }
+  }
+}
+
+
+SharedPtr<DataVector> DataVector::sharesWith() const {
+  QMutexLocker ml(&_sharedReadersLock);
+  return _leader;
+}
+
+
+// Take the leader's samples, and where it got to in the file, if it has
+// read since the data source last changed.  The leader is read locked
+// throughout: it may be updating in another thread.
+bool DataVector::followLeader() {
+  DataVectorPtr leader;
+  int leaderReadSerial;
+  {
+    QMutexLocker ml(&_sharedReadersLock);
+    leader = _leader;
+    leaderReadSerial = _leaderReadSerial;
+  }
+  if (!leader || !dataSource()) {
+    return false;
+  }
+  if (!leader->store()) {
+    // it was deleted: read for ourselves, and maybe for the others
+    unshare();
+    share();
+    if (sharesWith() && store()) {
+      store()->invalidateInputs(this);
+    }
+    return false;
+  }
+
+  leader->readLock();
+  if (leader->serial() == Forced || leader->serialOfLastChange() < dataSource()->serialOfLastChange()) {
+    leader->unlock();
+    return false;
+  }
+
+  // the statistics of what we had still hold for what hasn't changed
+  int unchanged = 0;
+  if (borrowsBuffer() && leaderReadSerial == leader->_readSerial) {
+    unchanged = leader->_size;
+  } else if (borrowsBuffer() && leaderReadSerial == leader->_readSerial - 1) {
+    unchanged = leader->_lastUnchanged;
+  }
+
+  borrowBuffer(leader.data());
+  SPF = leader->SPF;
+  NF = leader->NF;
+  F0 = leader->F0;
+  _numSamples = leader->_numSamples;
+  _dirty = leader->_dirty;
+  NumNew = leader->NumNew;
+  NumShifted = leader->NumShifted;
+  _unchangedSamples = unchanged;
+  leaderReadSerial = leader->_readSerial;
+  leader->unlock();
+
+  QMutexLocker ml(&_sharedReadersLock);
+  if (_leader == leader) {
+    _leaderReadSerial = leaderReadSerial;
+  }
+  return true;
+}
+
+
+double *DataVector::readBuffer(int from) {
+  if (!_f) {
+    return _v + from;
+  }
+  if (!BufferStore::self()->resize(_readBuffer, qMax(_size - from, 1)*sizeof(double), BufferStore::WorkData)) {
+    return 0L;
+  }
+  return _readBuffer;
+}
+
+
+// Out of memory part way through internalUpdate(), with the source locked:
+// what was shifted or resized so far is thrown away and read again next
+// time, and the source is let go of before saying so.
+void DataVector::abortUpdate() {
+  reset();
+  dataSource()->unlock();
+  // TODO: Is aborting all we can do?
+  fatalError("Not enough memory for vector data");
+}
+
+
+void DataVector::storeReadBuffer(int from) {
+  if (!_f || !_readBuffer) {
+    return;
+  }
+  for (int i = from; i < _size; i++) {
+    _f[i] = _readBuffer[i - from];
+  }
+  // only ever as big as the last read, so don't hang on to it
+  BufferStore::self()->release(_readBuffer);
+  _readBuffer = 0L;
+}
+
+
+// The means of the finite samples of each length samples of in, of which
+// got were read; a short last run is averaged over what there is.
+static void averageRuns(const double *in, int got, int length, double *out, int from, int to) {
+  for (int k = from; k < to; ++k) {
+    double sum;
+    const int finite = RunningStatistics::sumFinite(in + k*length, qMin(length, got - k*length), sum);
+    out[k] = (finite > 0) ? sum/double(finite) : NOPOINT;
+  }
+}
+
+
+class DataVectorAverageRuns : public QRunnable
 {
-  ReadInfo par = {v, s, n, skip, lastFrameRead};
+  public:
+    DataVectorAverageRuns(const double *in, int got, int length, double *out, int from, int to, QSemaphore *done)
+      : _in(in), _got(got), _length(length), _out(out), _from(from), _to(to), _done(done) {}
+
+    void run() {
+      averageRuns(_in, _got, _length, _out, _from, _to);
+      _done->release();
+    }
+
+  private:
+    const double *_in;
+    int _got, _length;
+    double *_out;
+    int _from, _to;
+    QSemaphore *_done;
+};
+
+
+// Boxcar averages of skip frames each, count of them from frame f0 on.  The
+// frames are read AveBlockSamples at a time rather than an average at a
+// time, and a big block is summed on the global thread pool as well as here.
+int DataVector::readAveraged(double *v, int f0, int count, int skip, int spf) {
+  const int length = skip*spf;
+  const int perBlock = qMax(AveBlockSamples/length, 1);
+  if (N_AveReadBuf < perBlock*length) {
+    if (!BufferStore::self()->resize(AveReadBuf, perBlock*length*sizeof(double), BufferStore::WorkData)) {
+      qCritical() << "Vector resize failed";
+      return 0;
+    }
+    N_AveReadBuf = perBlock*length;
+  }
+
+  const int threads = qMax(QThread::idealThreadCount(), 1);
+  int n_read = 0;
+  while (n_read < count) {
+    const int n = qMin(perBlock, count - n_read);
+    const int got = readField(AveReadBuf, _field, f0 + n_read*skip, n*skip);
+    if (got <= 0) {
+      break;
+    }
+    const int averages = qMin((got + length - 1)/length, n);
+
+    const int parts = (got >= AveThreadedSamples) ? qMin(threads, averages) : 1;
+    QSemaphore done;
+    for (int part = 1; part < parts; ++part) {
+      QThreadPool::globalInstance()->start(new DataVectorAverageRuns(AveReadBuf, got, length, v + n_read,
+                                           averages*part/parts, averages*(part + 1)/parts, &done));
+    }
+    averageRuns(AveReadBuf, got, length, v + n_read, 0, averages/parts);
+    done.acquire(parts - 1);
+
+    n_read += averages;
+    if (got < n*length) {
+      break;
+    }
+  }
+  return n_read;
+}
+
+
+int DataVector::readField(double *v, const QString& field, int s, int n, int skip, int *lastFrameRead,
+                          Decimation decimation)
+{
+  ReadInfo par = {v, s, n, skip, lastFrameRead, decimation};
+  if (skip <= 1) {
+    const int batched = dataSource()->readBatchedVector(field, par);
+    if (batched >= 0) {
+      return batched;
+    }
+    const int cached = dataSource()->readCachedVector(field, par);
+    if (cached >= 0) {
+      return cached;
+    }
+  }
   return dataSource()->vector().read(field, par);
 }
 
 const DataVector::DataInfo DataVector::dataInfo(const QString& field) const
 {
   dataSource()->readLock();
-  const DataInfo info = dataSource()->vector().dataInfo(field);
+  const DataInfo info = dataSource()->vectorInfo(field);
   dataSource()->unlock();
   return info;
 }
@@ -41,25 +41,40 @@ class KSTCORE_EXPORT DataVector : public Vector, public DataPrimitive
       startingFrame is the starting frame
       numberOfFrames is the number of frames to read
         if numberOfFrames is -1, it means to read 1 -sample- from startingFrame.
-      skipFrame: currently ignored by all data sources
+      skipFrame: if more than 1, and the source's DataInfo has readsSkip,
+        numberOfFrames samples are read instead: the first sample of every
+        skipFrame'th frame from startingFrame on.  Otherwise ignored.
       lastFrameRead: currently ignored
+      decimation: with skipFrame, how each sample stands for its skipFrame
+        frames: FirstSample as above, or the mean, smallest or largest of
+        the finite samples of those frames, if the source's DataInfo lists
+        it in decimations.
      */
+    enum Decimation { FirstSample = 0x0, MeanOfFrames = 0x1, MinOfFrames = 0x2, MaxOfFrames = 0x4 };
+
     struct KSTCORE_EXPORT ReadInfo {
       double*  data;
       int startingFrame;
       int numberOfFrames;
       int skipFrame;
       int *lastFrameRead;
+      Decimation decimation;
     };
 
 
     struct KSTCORE_EXPORT DataInfo
     {
       DataInfo();
-      DataInfo(int frameCount, int samplesPerFrame);
+      DataInfo(int frameCount, int samplesPerFrame, bool readsSkip = false, int decimations = 0);
 
       int frameCount;
       int samplesPerFrame;
+      /** read() takes ReadInfo::skipFrame: one call reads a whole
+        * decimated vector, rather than one call for every sample */
+      bool readsSkip;
+      /** the Decimations, other than FirstSample, which read() computes
+        * itself: cheaper at the source than here, if it has them stored */
+      int decimations;
     };
 
 
@@ -80,6 +95,14 @@ class KSTCORE_EXPORT DataVector : public Vector, public DataPrimitive
     void changeFrames(int f0, int n, int skip,
                       bool in_doSkip, bool in_doAve);           //si
 
+    /** As Vector::setStorageType(): vectors sharing samples have to store
+      * them the same way, so this one may stop or start sharing. */
+    void setStorageType(StorageType type);
+
+    /** Another vector reading exactly the same samples, whose buffer this
+      * one borrows rather than reading them again; or 0. */
+    SharedPtr<DataVector> sharesWith() const;
+
     /** Return frames held in Vector */
     int numFrames() const;                                      //si
 
@@ -109,6 +132,10 @@ class KSTCORE_EXPORT DataVector : public Vector, public DataPrimitive
     /** Returns intrinsic samples per frame */
     int samplesPerFrame() const;                                //si
 
+    /** the frames of field() the next update will read, if it is a plain
+      * read: see DataSource::batchVectors() */
+    bool plannedRead(int &startingFrame, int &numberOfFrames) const;
+
     /** Save vector information */
     virtual void save(QXmlStreamWriter &s);
 
@@ -133,6 +160,7 @@ class KSTCORE_EXPORT DataVector : public Vector, public DataPrimitive
 
     bool isValid() const;                                       //si
     virtual void internalUpdate();
+    virtual QList<ObjectPtr> inputObjects() const;
 
     //implemented in Vector too but must not be virtual.
     QByteArray scriptInterface(QList<QByteArray> &command);
@@ -189,17 +217,49 @@ class KSTCORE_EXPORT DataVector : public Vector, public DataPrimitive
     int N_AveReadBuf;
     double *AveReadBuf;
 
+    /** With single precision storage, samples are read into this and then
+      * narrowed into the vector: see readBuffer() */
+    double *_readBuffer;
+
+    /** where to read the samples from index from on: the vector itself, or
+      * _readBuffer, which storeReadBuffer() copies into the vector */
+    double *readBuffer(int from);
+    void storeReadBuffer(int from);
+    void abortUpdate(); // out of memory in internalUpdate()
+
     void checkIntegrity(); // must be called with a lock
 
     //bool _dontUseSkipAccel;
 
     // wrappers around DataSource interface functions
-    int readField(double *v, const QString& field, int s, int n, int skip = -1, int *lastFrameRead = 0L);
+    int readField(double *v, const QString& field, int s, int n, int skip = -1, int *lastFrameRead = 0L,
+                  Decimation decimation = FirstSample);
+
+    /** boxcar averages are read AveBlockSamples at a time, and blocks of
+      * AveThreadedSamples or more are summed on several threads */
+    enum { AveBlockSamples = 1024*1024, AveThreadedSamples = 256*1024 };
+    int readAveraged(double *v, int f0, int count, int skip, int spf);
     const DataInfo dataInfo(const QString& field) const;
+    void requestedFrames(int fc, int &f0, int &nf, bool &pastEof) const;
 
     QHash<QString, ScalarPtr> _fieldScalars;
     QHash<QString, StringPtr> _fieldStrings;
 
+    // Vectors with the same source, field, range and storage share one
+    // buffer and one read: the first to be set up reads, and the others
+    // follow it.  A vector which is changed takes a copy first.
+    QString shareKey() const;
+    void share();
+    void unshare();
+    bool followLeader();
+
+    SharedPtr<DataVector> _leader;
+    QList<DataVector*> _followers;
+    QString _shareKey;       // what we read for our followers, if anything
+    int _readSerial;         // counts our reads
+    int _lastUnchanged;      // _unchangedSamples of the last read
+    int _leaderReadSerial;   // the leader's _readSerial when we last followed
+
     /** make a copy of the DataVector */
     virtual PrimitivePtr makeDuplicate() const;
     virtual bool checkValidity(const DataSourcePtr& ds) const;
@@ -18,8 +18,10 @@ INCLUDEPATH += tmp \
     $$TOPLEVELDIR/src/widgets \
     $$OUTPUT_DIR/src/libkst/tmp
 
-SOURCES += builtindatasources.cpp \
+SOURCES += blockcache.cpp \
+    builtindatasources.cpp \
     builtinprimitives.cpp \
+    bufferstore.cpp \
     coredocument.cpp \
     datacollection.cpp \
     datamatrix.cpp \
@@ -43,6 +45,7 @@ SOURCES += builtindatasources.cpp \
     matrix.cpp \
     matrixfactory.cpp \
     measuretime.cpp \
+    minmaxindex.cpp \
     namedobject.cpp \
     nextcolor.cpp \
     object.cpp \
@@ -56,11 +59,15 @@ SOURCES += builtindatasources.cpp \
     scalar.cpp \
     scalarfactory.cpp \
     shortnameindex.cpp \
+    statistics_kst.cpp \
     string_kst.cpp \
     stringfactory.cpp \
+    updategraph.cpp \
+    updateprofiler.cpp \
     updatemanager.cpp \
     vector.cpp \
     vectorfactory.cpp \
+    vectorsnapshot.cpp \
     vscalar.cpp \
     ksttimezone.cpp
 	
@@ -68,8 +75,10 @@ SOURCES += builtindatasources.cpp \
 !macx:!win32:SOURCES += sysinfo.c \
     psversion.c
 	
-HEADERS += builtindatasources.h \
+HEADERS += blockcache.h \
+    builtindatasources.h \
     builtinprimitives.h \
+    bufferstore.h \
     coredocument.h \
     datacollection.h \
     datamatrix.h \
@@ -100,6 +109,7 @@ HEADERS += builtindatasources.h \
     matrix.h \
     matrixfactory.h \
     measuretime.h \
+    minmaxindex.h \
     namedobject.h \
     object.h \
     objectlist.h \
@@ -115,12 +125,16 @@ HEADERS += builtindatasources.h \
     scalarfactory.h \
     sharedptr.h \
 #    stdinsource.h \
+    statistics_kst.h \
     string_kst.h \
     stringfactory.h \
     sysinfo.h \
     timezones.h \
+    updategraph.h \
+    updateprofiler.h \
     updatemanager.h \
     vector.h \
     vectorfactory.h \
+    vectorsnapshot.h \
     vscalar.h \
     ksttimezone.h
@@ -27,8 +27,10 @@
 #include "debug.h"
 #include "kst_i18n.h"
 #include "math_kst.h"
+#include "bufferstore.h"
 #include "datacollection.h"
 #include "objectstore.h"
+#include "statistics_kst.h"
 
 
 // used for resizing; set to 1 for loop zeroing, 2 to use memset
@@ -58,7 +60,7 @@ Matrix::Matrix(ObjectStore *store)
 Matrix::~Matrix() {
   if (_z) {
     _vectors["z"]->setV(0L, 0);
-    free(_z);
+    BufferStore::self()->release(_z);
     _z = 0L;
   }
 }
@@ -318,44 +320,22 @@ void Matrix::internalUpdate() {
   _NS = _nX * _nY;
 
   if (_zSize > 0) {
-    double min = NAN;
-    double max = NAN;
-    double minpos = NAN;
-    double sum = 0.0, sumsquared = 0.0;
-    bool initialized = false;
-
-    _NRealS = 0;
-
-    for (int i = 0; i < _zSize; i++) {
-      if (isfinite(_z[i]) && !KST_ISNAN(_z[i])) {
-        if (!initialized) {
-          min = _z[i];
-          max = _z[i];
-          minpos = (_z[0] > 0) ? _z[0] : 1.0E300;
-          initialized = true;
-          _NRealS++;
-        } else {
-          if (min > _z[i]) {
-            min = _z[i];
-          }
-          if (max < _z[i]) {
-            max = _z[i];
-          }
-          if (minpos > _z[i] && _z[i] > 0) {
-            minpos = _z[i];
-          }
-          sum += _z[i];
-          sumsquared += _z[i] * _z[i];
-
-          _NRealS++;
-        }
-      }
+    RunningStatistics stats;
+    stats.add(_z, _zSize);
+
+    _NRealS = stats.n;
+
+    _scalars["sum"]->setValue(stats.sum);
+    _scalars["sumsquared"]->setValue(stats.sum2);
+    if (stats.n > 0) {
+      _scalars["max"]->setValue(stats.max);
+      _scalars["min"]->setValue(stats.min);
+      _scalars["minpos"]->setValue(stats.minPos);
+    } else {
+      _scalars["max"]->setValue(NAN);
+      _scalars["min"]->setValue(NAN);
+      _scalars["minpos"]->setValue(NAN);
     }
-    _scalars["sum"]->setValue(sum);
-    _scalars["sumsquared"]->setValue(sumsquared);
-    _scalars["max"]->setValue(max);
-    _scalars["min"]->setValue(min);
-    _scalars["minpos"]->setValue(minpos);
 
     updateScalars();
   }
@@ -462,7 +442,7 @@ void Matrix::updateScalars() {
 bool Matrix::resizeZ(int sz, bool reinit) {
 //   qDebug() << "resizing to: " << sz << endl;
   if (sz >= 1) {
-    if (!kstrealloc(_z, sz*sizeof(double))) {
+    if (!BufferStore::self()->resize(_z, sz*sizeof(double), BufferStore::MatrixData)) {
       qCritical() << "Matrix resize failed";
       return false;
     }
@@ -523,7 +503,7 @@ bool Matrix::resize(int xSize, int ySize, bool reinit) {
   int sz = xSize * ySize;
   if (sz > _zSize) {
     // array is getting bigger, so resize before moving
-    if (!kstrealloc(_z, sz*sizeof(double))) {
+    if (!BufferStore::self()->resize(_z, sz*sizeof(double), BufferStore::MatrixData)) {
       qCritical() << "Matrix resize failed";
       return false;
     }
@@ -547,7 +527,7 @@ bool Matrix::resize(int xSize, int ySize, bool reinit) {
 
   if (sz < _zSize) {
     // array is getting smaller, so resize after moving
-    if (!kstrealloc(_z, sz*sizeof(double))) {
+    if (!BufferStore::self()->resize(_z, sz*sizeof(double), BufferStore::MatrixData)) {
       qCritical() << "Matrix resize failed";
       return false;
     }
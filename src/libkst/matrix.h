@@ -181,7 +181,9 @@ class KSTCORE_EXPORT Matrix : public Primitive
     void renameScalars();
     void updateScalars();
 
-    // the flat-packed array in row-major order
+    // the flat-packed array in row-major order.  Always double: the z
+    // vector is set to this very buffer (Vector::setV()), and images are
+    // drawn from it, so float32 storage would have to change both.
     double *_z;
     int _zSize; // internally keep track of real _z size
 
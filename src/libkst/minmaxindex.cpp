@@ -0,0 +1,93 @@
+/***************************************************************************
+           minmaxindex.cpp: extremes of any range of a vector, quickly
+                             -------------------
+    begin                : October, 2012
+    copyright            : (C) 2012 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "minmaxindex.h"
+
+namespace Kst {
+
+MinMaxIndex::MinMaxIndex()
+  : Shared(), _size(0) {
+}
+
+
+MinMaxIndex::MinMaxIndex(const MinMaxIndex &other)
+  : Shared(), _levels(other._levels), _size(other._size) {
+}
+
+
+void MinMaxIndex::update(const double *v, int size, int unchanged) {
+  updateSamples(v, size, unchanged);
+}
+
+
+void MinMaxIndex::update(const float *v, int size, int unchanged) {
+  updateSamples(v, size, unchanged);
+}
+
+
+template<class T>
+void MinMaxIndex::updateSamples(const T *v, int size, int unchanged) {
+  size = qMax(size, 0);
+  unchanged = qBound(0, unchanged, qMin(size, _size));
+  _size = size;
+
+  // the blocks from the one holding the first changed sample on
+  int first = unchanged/BlockSize;
+  int count = (size + BlockSize - 1)/BlockSize;
+
+  if (_levels.isEmpty()) {
+    _levels.resize(1);
+  }
+  QVector<Block> &samples = _levels[0];
+  samples.resize(count);
+  for (int b = first; b < count; ++b) {
+    Block block;
+    const int end = qMin((b + 1)*BlockSize, size);
+    for (int i = b*BlockSize; i < end; ++i) {
+      block.add(v[i], i);
+    }
+    samples[b] = block;
+  }
+
+  int level = 1;
+  while (count > 1) {
+    first /= FanOut;
+    const int below = count;
+    count = (count + FanOut - 1)/FanOut;
+    if (_levels.size() <= level) {
+      _levels.resize(level + 1);
+      first = 0;
+    }
+    QVector<Block> &over = _levels[level];
+    const QVector<Block> &blocks = _levels.at(level - 1);
+    over.resize(count);
+    for (int b = first; b < count; ++b) {
+      Block block;
+      const int end = qMin((b + 1)*FanOut, below);
+      for (int i = b*FanOut; i < end; ++i) {
+        block.add(blocks.at(i));
+      }
+      over[b] = block;
+    }
+    ++level;
+  }
+  _levels.resize(level);
+}
+
+}
+
+// vim: ts=2 sw=2 et
@@ -0,0 +1,170 @@
+/***************************************************************************
+            minmaxindex.h: extremes of any range of a vector, quickly
+                             -------------------
+    begin                : October, 2012
+    copyright            : (C) 2012 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef MINMAXINDEX_H
+#define MINMAXINDEX_H
+
+#include <QVector>
+
+#include "sharedptr.h"
+#include "kst_export.h"
+
+namespace Kst {
+
+// The smallest and largest sample of every block of BlockSize samples, then
+// of every FanOut of those blocks, and so on up to one block for the whole
+// vector.  extremes() then finds those of any range of samples from a
+// handful of blocks, and only has to look at the samples themselves at the
+// ragged ends: zooming out on a curve of 100M samples, or autoscaling to
+// part of it, looks at a few thousand numbers rather than all of them.
+//
+// The samples themselves aren't kept here, so the same index serves
+// a vector and the snapshots taken of it.  Non finite samples are left out
+// of the extremes, but blocks remember having had them.
+//
+// Vector keeps one of these up to date once somebody has asked for it:
+// see Vector::minMaxIndex().
+
+class KSTCORE_EXPORT MinMaxIndex : public Shared
+{
+  public:
+    enum { BlockSize = 128, FanOut = 8 };
+
+    MinMaxIndex();
+    MinMaxIndex(const MinMaxIndex &other);
+
+    /** the number of samples indexed */
+    int size() const { return _size; }
+
+    /** Catch up with v, of which the first unchanged samples are the same
+      * as at the last update: only the blocks after those are redone. */
+    void update(const double *v, int size, int unchanged = 0);
+    void update(const float *v, int size, int unchanged = 0);
+
+    /** The indices of the smallest and largest finite samples from from to
+      * to, both included, of v: anything with value(int), such as a Vector
+      * or a VectorSnapshot, holding the samples this was last updated
+      * with.  Returns false if none of them are finite.  holes, if given,
+      * is set if any of them aren't. */
+    template<class V>
+    bool extremes(const V &v, int from, int to, int &iMin, int &iMax, bool *holes = 0) const;
+
+  private:
+    struct Block {
+      Block() : min(0.0), max(0.0), minIndex(-1), maxIndex(-1), holes(false) {}
+      double min, max;
+      int minIndex, maxIndex; // -1 if nothing in the block is finite
+      bool holes;
+
+      inline void add(double x, int i);
+      inline void add(const Block &b);
+    };
+
+    template<class T> void updateSamples(const T *v, int size, int unchanged);
+
+    // _levels[0] has a block for every BlockSize samples, and each level
+    // after it one for every FanOut blocks of the one before
+    QVector<QVector<Block> > _levels;
+    int _size;
+};
+
+typedef SharedPtr<MinMaxIndex> MinMaxIndexPtr;
+
+
+inline void MinMaxIndex::Block::add(double x, int i) {
+  if (x - x != 0.0) { // not finite
+    holes = true;
+    return;
+  }
+  if (minIndex < 0) {
+    min = max = x;
+    minIndex = maxIndex = i;
+  } else if (x < min) {
+    min = x;
+    minIndex = i;
+  } else if (x > max) {
+    max = x;
+    maxIndex = i;
+  }
+}
+
+
+inline void MinMaxIndex::Block::add(const Block &b) {
+  holes = holes || b.holes;
+  if (b.minIndex < 0) {
+    return;
+  }
+  if (minIndex < 0) {
+    min = b.min;
+    max = b.max;
+    minIndex = b.minIndex;
+    maxIndex = b.maxIndex;
+    return;
+  }
+  if (b.min < min) {
+    min = b.min;
+    minIndex = b.minIndex;
+  }
+  if (b.max > max) {
+    max = b.max;
+    maxIndex = b.maxIndex;
+  }
+}
+
+
+// Takes the biggest block which starts at i and ends by to, or else the
+// sample at i, and carries on after it.
+template<class V>
+bool MinMaxIndex::extremes(const V &v, int from, int to, int &iMin, int &iMax, bool *holes) const {
+  from = qMax(from, 0);
+  to = qMin(to, _size - 1);
+
+  Block all;
+  int i = from;
+  while (i <= to) {
+    int level = -1;
+    qint64 span = BlockSize;
+    while (level + 1 < _levels.size() && i % span == 0 && i + span - 1 <= to) {
+      ++level;
+      span *= FanOut;
+    }
+    if (level < 0) {
+      all.add(v.value(i), i);
+      ++i;
+    } else {
+      span /= FanOut;
+      all.add(_levels.at(level).at(int(i/span)));
+      i += span;
+    }
+  }
+
+  if (holes) {
+    *holes = all.holes;
+  }
+  if (all.minIndex < 0) {
+    return false;
+  }
+  iMin = all.minIndex;
+  iMax = all.maxIndex;
+  return true;
+}
+
+}
+
+#endif
+
+// vim: ts=2 sw=2 et
@@ -72,6 +72,11 @@ bool Object::uses(ObjectPtr p) const {
 }
 
 
+QList<ObjectPtr> Object::inputObjects() const {
+  return QList<ObjectPtr>();
+}
+
+
 ObjectStore* Object::store() const {
   return _store;
 }
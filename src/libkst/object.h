@@ -77,11 +77,16 @@ class KSTCORE_EXPORT Object : public QObject, public Shared, public KstRWLock, p
 
     virtual bool uses(ObjectPtr p) const;
 
+    /** the objects whose output this object reads when it updates.
+      * Used by the UpdateGraph to schedule updates. */
+    virtual QList<ObjectPtr> inputObjects() const;
+
   protected:
     Object();
     virtual ~Object();
 
     friend class ObjectStore;
+    friend class UpdateManager;
     ObjectStore *_store;  // set by ObjectStore
 
     virtual qint64 minInputSerial() const = 0;
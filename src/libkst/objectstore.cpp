@@ -18,8 +18,12 @@
 
 #include <QHash>
 #include <QList>
+#include <QMultiMap>
 #include <QString>
 
+#include "kst_i18n.h"
+
+#include "debug.h"
 #include "object.h"
 #include "datavector.h"
 #include "datastring.h"
@@ -31,7 +35,7 @@
 
 namespace Kst {
 
-ObjectStore::ObjectStore()
+ObjectStore::ObjectStore() : _nextAdded(0)
 {
   override.fileName.clear();
   override.f0 = override.N = override.skip = override.doAve = -5;
@@ -62,7 +66,7 @@ bool ObjectStore::removeObject(Object *o) {
 #endif
       return false;
     }
-  } else if (!_list.contains(o)) {
+  } else if (!_addedAt.contains(o)) {
 #if NAMEDEBUG > 1
     qDebug() << "Trying to delete a non-existent object from the store: " << o->tag().tagString();
 #endif
@@ -75,7 +79,9 @@ bool ObjectStore::removeObject(Object *o) {
   } else {
     o->deleteDependents();
     _list.removeAll(o);
+    unindexObject(o);
   }
+  _updateGraph.removeObject(o);
 
   o->_store = 0;
 
@@ -96,12 +102,11 @@ ObjectPtr ObjectStore::retrieveObject(const QString& name) const {
   shortName = rx.cap(2);
 
   // 1) search for short names
-  int size = _list.size();
-  for (int i = 0; i < size; ++i) {
-    if (_list.at(i)->shortName()==shortName)
-      return _list.at(i);
+  if (Object *o = _shortNames.value(shortName)) {
+    return o;
   }
   // 3) search for descriptive names: must be unique
+  int size = _list.size();
   for (int i = 0; i < size; ++i) {
     if (_list.at(i)->descriptiveName() == name) {
       if (match != -1) 
@@ -116,6 +121,72 @@ ObjectPtr ObjectStore::retrieveObject(const QString& name) const {
   return NULL;
 }
 
+void ObjectStore::indexObject(Object *o) {
+  qint64 added = _nextAdded++;
+  _addedAt.insert(o, added);
+  _typeBuckets[o->metaObject()].insert(added, o);
+  _shortNames.insert(o->shortName(), o);
+}
+
+
+void ObjectStore::unindexObject(Object *o) {
+  if (!_addedAt.contains(o)) {
+    return;
+  }
+
+  qint64 added = _addedAt.take(o);
+  QHash<const QMetaObject*, QMap<qint64, Object*> >::Iterator bucket = _typeBuckets.find(o->metaObject());
+  if (bucket != _typeBuckets.end()) {
+    bucket.value().remove(added);
+    if (bucket.value().isEmpty()) {
+      _typeBuckets.erase(bucket);
+    }
+  }
+  if (_shortNames.value(o->shortName()) == o) {
+    _shortNames.remove(o->shortName());
+  }
+}
+
+
+static bool inheritsFrom(const QMetaObject *m, const QMetaObject *type) {
+  for (; m; m = m->superClass()) {
+    if (m == type) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+// Everything in _list which inherits type, in the order it was added.  Only the
+// buckets need to be looked at, and there are only as many of them as there
+// are classes in use.
+QList<ObjectPtr> ObjectStore::objectsOfType(const QMetaObject *type) const {
+  QList<const QMap<qint64, Object*>*> matches;
+  for (QHash<const QMetaObject*, QMap<qint64, Object*> >::ConstIterator it = _typeBuckets.begin(); it != _typeBuckets.end(); ++it) {
+    if (inheritsFrom(it.key(), type)) {
+      matches.append(&it.value());
+    }
+  }
+
+  QList<ObjectPtr> objects;
+  if (matches.count() == 1) {
+    foreach (Object *o, *matches.first()) {
+      objects.append(o);
+    }
+  } else if (matches.count() > 1) {
+    QMap<qint64, Object*> merged;
+    foreach (const QMap<qint64, Object*> *bucket, matches) {
+      merged.unite(*bucket);
+    }
+    foreach (Object *o, merged) {
+      objects.append(o);
+    }
+  }
+  return objects;
+}
+
+
 void ObjectStore::rebuildDataSourceList() {
   cleanUpDataSourceList();
   foreach (DataSourcePtr ds, _dataSourceList) {
@@ -156,6 +227,10 @@ void ObjectStore::clear() {
 #if NAMEDEBUG > 0
   qDebug () << "Clearing object store " << (void*) this;
 #endif
+  if (KstRWLock::trackContention()) {
+    dumpLockContention();
+  }
+
   foreach(DataSource *ds, _dataSourceList) {
     removeObject(ds);
   }
@@ -178,6 +253,52 @@ QList<ObjectPtr> ObjectStore::objectList() {
   return _list;
 }
 
+QList<ObjectPtr> ObjectStore::updateSchedule(const QList<ObjectPtr> &seeds, QList<ObjectPtr> *cleanInputs) {
+  KstWriteLocker l(&_lock);
+  return _updateGraph.downstream(seeds, cleanInputs);
+}
+
+QList<QList<ObjectPtr> > ObjectStore::updateLevels(const QList<ObjectPtr> &seeds, QList<ObjectPtr> *cleanInputs) {
+  KstWriteLocker l(&_lock);
+  return _updateGraph.downstreamByLevel(seeds, cleanInputs);
+}
+
+QList<ObjectPtr> ObjectStore::forcedObjects() {
+  KstWriteLocker l(&_lock);
+  QList<ObjectPtr> forced = _updateGraph.forcedObjects();
+  foreach (const ObjectPtr &p, forced) {
+    _updateGraph.invalidate(const_cast<Object*>(p.data()));
+  }
+  return forced;
+}
+
+void ObjectStore::invalidateInputs(Object *o) {
+  KstWriteLocker l(&_lock);
+  _updateGraph.invalidate(o);
+}
+
+void ObjectStore::dumpLockContention() {
+  KstReadLocker l(&_lock);
+
+  QMultiMap<int, ObjectPtr> worstFirst;
+  QList<ObjectPtr> objects = _list;
+  foreach (DataSourcePtr ds, _dataSourceList) {
+    objects.append(ObjectPtr(ds.data()));
+  }
+  foreach (ObjectPtr p, objects) {
+    if (p->contendedReads() > 0 || p->contendedWrites() > 0) {
+      worstFirst.insert(-p->contentionTime(), p);
+    }
+  }
+
+  Debug::self()->log(i18n("Lock contention: %1 objects had to wait for their locks").arg(worstFirst.count()), Debug::DebugLog);
+  foreach (ObjectPtr p, worstFirst) {
+    Debug::self()->log(i18n("  %1: %2 ms waiting, %3 contended reads, %4 contended writes")
+                       .arg(p->Name()).arg(p->contentionTime()).arg(p->contendedReads()).arg(p->contendedWrites()), Debug::DebugLog);
+  }
+}
+
+
 void ObjectStore::clearUsedFlags() {
   foreach (ObjectPtr p, _list) {
     p->setUsed(false);
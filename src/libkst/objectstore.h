@@ -19,6 +19,8 @@
 #define OBJECTSTORE_H
 
 #include <QDebug>
+#include <QHash>
+#include <QMap>
 
 #include "kst_export.h"
 #include "kst_i18n.h"
@@ -26,6 +28,7 @@
 #include "objectlist.h"
 #include "rwlock.h"
 #include "datasource.h"
+#include "updategraph.h"
 
 namespace Kst {
 
@@ -67,9 +70,30 @@ class KSTCORE_EXPORT ObjectStore
     /** get everything but the data sources */
     QList<ObjectPtr> objectList();
 
+    /** get the objects downstream of seeds, in the order they must be
+      * updated.  Inputs of those objects which are not downstream of seeds
+      * are returned in cleanInputs.  See UpdateGraph. */
+    QList<ObjectPtr> updateSchedule(const QList<ObjectPtr> &seeds, QList<ObjectPtr> *cleanInputs = 0);
+
+    /** as updateSchedule(), but grouped into levels of objects which
+      * don't depend on each other. */
+    QList<QList<ObjectPtr> > updateLevels(const QList<ObjectPtr> &seeds, QList<ObjectPtr> *cleanInputs = 0);
+
+    /** get the objects which have been forced to update by registerChange() or reset().
+      * Their inputs will be re-read by the next updateSchedule() */
+    QList<ObjectPtr> forcedObjects();
+
+    /** the inputs of o have changed without a registerChange() */
+    void invalidateInputs(Object *o);
+
     /** locking */
     KstRWLock& lock() const { return _lock; }
 
+    /** write the lock contention of every object which has had to wait
+      * for its lock to the debug log, worst first.
+      * See KstRWLock::trackContention(). */
+    void dumpLockContention();
+
     /** clear the 'used' flag on all objects in list */
     void clearUsedFlags();
 
@@ -99,17 +123,31 @@ class KSTCORE_EXPORT ObjectStore
     DataSourceList _dataSourceList;
     QList<ObjectPtr> _list;
 
+    // who feeds who, for the update manager
+    UpdateGraph _updateGraph;
+
+    // indexes into _list, kept up to date by addObject() and removeObject():
+    // the objects of each class (exactly, not subclasses) keyed by when they
+    // were added, so that lookups by type keep the order of _list; and the
+    // objects by short name, which never changes once an object is made.
+    void indexObject(Object *o);
+    void unindexObject(Object *o);
+    QList<ObjectPtr> objectsOfType(const QMetaObject *type) const;
+
+    QHash<const QMetaObject*, QMap<qint64, Object*> > _typeBuckets;
+    QHash<Object*, qint64> _addedAt;
+    QHash<QString, Object*> _shortNames;
+    qint64 _nextAdded;
 };
 
 
-// this is an inefficient implementation for now
 template<class T>
 const ObjectList<T> ObjectStore::getObjects() const {
   KstReadLocker l(&(this->_lock));
   ObjectList<T> rc;
 
-  for (QList<ObjectPtr>::ConstIterator it = _list.begin(); it != _list.end(); ++it) {
-    SharedPtr<T> x = kst_cast<T>(*it);
+  foreach (const ObjectPtr &o, objectsOfType(&T::staticMetaObject)) {
+    SharedPtr<T> x = kst_cast<T>(o);
     if (x != 0) {
       rc.append(x);
     }
@@ -144,7 +182,9 @@ bool ObjectStore::addObject(T *o) {
     _dataSourceList.append(ds);
   } else {
     _list.append(o);
+    indexObject(o);
   }
+  _updateGraph.addObject(o);
   return true;
 }
 
@@ -64,6 +64,14 @@ QString Primitive::_automaticDescriptiveName() const {
   return name;
 }
 
+QList<ObjectPtr> Primitive::inputObjects() const {
+  QList<ObjectPtr> inputs;
+  if (_provider) {
+    inputs.append(ObjectPtr(_provider.data()));
+  }
+  return inputs;
+}
+
 qint64 Primitive::minInputSerial() const {
   if (_provider) {
     return (_provider->serial());
@@ -58,6 +58,8 @@ class KSTCORE_EXPORT Primitive : public Object
 
     virtual PrimitiveMap metas() const = 0;
 
+    virtual QList<ObjectPtr> inputObjects() const;
+
     // used for sorting dataobjects by Document::sortedDataObjectList()
     virtual bool flagSet() const { return _flag; }
     virtual void setFlag(bool f) { _flag = f;}
@@ -18,6 +18,7 @@
 #include "rwlock.h"
 
 #include <qdebug.h>
+#include <qdatetime.h>
 
 //#define LOCKTRACE
 
@@ -25,12 +26,83 @@
 QMutex KstRWLock::_mutex(true);
 #endif
 
+bool KstRWLock::_trackContention = !qgetenv("KST_LOCK_CONTENTION").isEmpty();
+
 KstRWLock::KstRWLock()
-: _readCount(0), _writeCount(0), _waitingReaders(0), _waitingWriters(0) {
+: _readCount(0), _writeCount(0), _waitingReaders(0), _waitingWriters(0), _moreReadLockers(0),
+  _contendedReads(0), _contendedWrites(0), _contentionTime(0) {
+  for (int i = 0; i < InlineReadLockers; ++i) {
+    _readLockers[i].thread = 0;
+    _readLockers[i].count = 0;
+  }
 }
 
 
 KstRWLock::~KstRWLock() {
+  delete _moreReadLockers;
+}
+
+
+int KstRWLock::readLocksHeld(Qt::HANDLE thread) const {
+  for (int i = 0; i < InlineReadLockers; ++i) {
+    if (_readLockers[i].count > 0 && _readLockers[i].thread == thread) {
+      return _readLockers[i].count;
+    }
+  }
+  if (_moreReadLockers) {
+    return _moreReadLockers->value(thread, 0);
+  }
+  return 0;
+}
+
+
+void KstRWLock::addReadLock(Qt::HANDLE thread) const {
+  int freeSlot = -1;
+  for (int i = 0; i < InlineReadLockers; ++i) {
+    if (_readLockers[i].count > 0) {
+      if (_readLockers[i].thread == thread) {
+        ++_readLockers[i].count;
+        return;
+      }
+    } else if (freeSlot < 0) {
+      freeSlot = i;
+    }
+  }
+
+  if (_moreReadLockers && _moreReadLockers->contains(thread)) {
+    ++(*_moreReadLockers)[thread];
+  } else if (freeSlot >= 0) {
+    _readLockers[freeSlot].thread = thread;
+    _readLockers[freeSlot].count = 1;
+  } else {
+    if (!_moreReadLockers) {
+      _moreReadLockers = new QMap<Qt::HANDLE, int>;
+    }
+    _moreReadLockers->insert(thread, 1);
+  }
+}
+
+
+bool KstRWLock::removeReadLock(Qt::HANDLE thread) const {
+  for (int i = 0; i < InlineReadLockers; ++i) {
+    if (_readLockers[i].count > 0 && _readLockers[i].thread == thread) {
+      --_readLockers[i].count;
+      return true;
+    }
+  }
+
+  if (_moreReadLockers) {
+    QMap<Qt::HANDLE, int>::Iterator it = _moreReadLockers->find(thread);
+    if (it != _moreReadLockers->end()) {
+      if (it.value() == 1) {
+        _moreReadLockers->erase(it);
+      } else {
+        --(it.value());
+      }
+      return true;
+    }
+  }
+  return false;
 }
 
 
@@ -50,20 +122,25 @@ void KstRWLock::readLock() const {
 #ifdef LOCKTRACE
     qDebug() << "Thread " << (int)QThread::currentThreadId() << " has a write lock on KstRWLock " << (void*)this << ", getting a read lock" << endl;
 #endif
-  } else {
-    QMap<Qt::HANDLE, int>::Iterator it = _readLockers.find(me);
-    if (it != _readLockers.end() && it.value() > 0) {
-      // thread already has another read lock
-    } else {
-      while (_writeCount > 0 || _waitingWriters) {  // writer priority otherwise
-        ++_waitingReaders;
-        _readerWait.wait(&_mutex);
-        --_waitingReaders;
-      }
+  } else if (readLocksHeld(me) > 0) {
+    // thread already has another read lock
+  } else if (_writeCount > 0 || _waitingWriters) {  // writer priority otherwise
+    QTime waited;
+    if (_trackContention) {
+      ++_contendedReads;
+      waited.start();
+    }
+    while (_writeCount > 0 || _waitingWriters) {
+      ++_waitingReaders;
+      _readerWait.wait(&_mutex);
+      --_waitingReaders;
+    }
+    if (_trackContention) {
+      _contentionTime += waited.elapsed();
     }
   }
 
-  _readLockers[me] = _readLockers[me] + 1;
+  addReadLock(me);
   ++_readCount;
 
 #ifdef LOCKTRACE
@@ -86,19 +163,26 @@ void KstRWLock::writeLock() const {
 
   Qt::HANDLE me = QThread::currentThreadId();
 
-  if (_readCount > 0) {
-    QMap<Qt::HANDLE, int>::Iterator it = _readLockers.find(me);
-    if (it != _readLockers.end() && it.value() > 0) {
-      // cannot acquire a write lock if I already have a read lock -- ERROR
-      qDebug() << "Thread " << QThread::currentThread() << " tried to write lock KstRWLock " << (void*)this << " while holding a read lock" << endl;
-      return;
-    }
+  if (_readCount > 0 && readLocksHeld(me) > 0) {
+    // cannot acquire a write lock if I already have a read lock -- ERROR
+    qDebug() << "Thread " << QThread::currentThread() << " tried to write lock KstRWLock " << (void*)this << " while holding a read lock" << endl;
+    return;
   }
 
-  while (_readCount > 0 || (_writeCount > 0 && _writeLocker != me)) {
-    ++_waitingWriters;
-    _writerWait.wait(&_mutex);
-    --_waitingWriters;
+  if (_readCount > 0 || (_writeCount > 0 && _writeLocker != me)) {
+    QTime waited;
+    if (_trackContention) {
+      ++_contendedWrites;
+      waited.start();
+    }
+    while (_readCount > 0 || (_writeCount > 0 && _writeLocker != me)) {
+      ++_waitingWriters;
+      _writerWait.wait(&_mutex);
+      --_waitingWriters;
+    }
+    if (_trackContention) {
+      _contentionTime += waited.elapsed();
+    }
   }
   _writeLocker = me;
   ++_writeCount;
@@ -123,18 +207,12 @@ void KstRWLock::unlock() const {
   Qt::HANDLE me = QThread::currentThreadId();
 
   if (_readCount > 0) {
-    QMap<Qt::HANDLE, int>::Iterator it = _readLockers.find(me);
-    if (it == _readLockers.end()) {
+    if (!removeReadLock(me)) {
       // read locked but not by me -- ERROR
       qDebug() << "Thread " << QThread::currentThread() << " tried to unlock KstRWLock " << (void*)this << " (read locked) without holding the lock" << endl;
       return;
     } else {
       --_readCount;
-      if (it.value() == 1) {
-        _readLockers.remove(it.key());
-      } else {
-        --(it.value());
-      }
     }
   } else if (_writeCount > 0) {
     if (_writeLocker != me) {
@@ -194,7 +272,7 @@ KstRWLock::LockStatus KstRWLock::myLockStatus() const {
 
   if (_writeCount > 0 && _writeLocker == me) {
     return WRITELOCKED;
-  } else if (_readCount > 0 && _readLockers.find(me) != _readLockers.end()) {
+  } else if (_readCount > 0 && readLocksHeld(me) > 0) {
     return READLOCKED;
   } else {
     return UNLOCKED;
@@ -205,4 +283,38 @@ KstRWLock::LockStatus KstRWLock::myLockStatus() const {
 #endif
 }
 
+
+void KstRWLock::setTrackContention(bool track) {
+  _trackContention = track;
+}
+
+
+bool KstRWLock::trackContention() {
+  return _trackContention;
+}
+
+
+int KstRWLock::contendedReads() const {
+  QMutexLocker lock(&_mutex);
+  return _contendedReads;
+}
+
+
+int KstRWLock::contendedWrites() const {
+  QMutexLocker lock(&_mutex);
+  return _contendedWrites;
+}
+
+
+int KstRWLock::contentionTime() const {
+  QMutexLocker lock(&_mutex);
+  return _contentionTime;
+}
+
+
+void KstRWLock::resetContention() const {
+  QMutexLocker lock(&_mutex);
+  _contendedReads = _contendedWrites = _contentionTime = 0;
+}
+
 // vim: ts=2 sw=2 et
@@ -46,6 +46,17 @@ class KSTCORE_EXPORT KstRWLock {
     virtual LockStatus lockStatus() const;
     virtual LockStatus myLockStatus() const;
 
+    /** Contention statistics: how often a thread had to wait for this
+      * lock, and for how long in total (ms).  Only collected while
+      * trackContention() is on; it is off by default, or on if the
+      * KST_LOCK_CONTENTION environment variable is set. */
+    static void setTrackContention(bool track);
+    static bool trackContention();
+    int contendedReads() const;
+    int contendedWrites() const;
+    int contentionTime() const;
+    void resetContention() const;
+
   protected:
 #ifdef ONE_LOCK_TO_RULE_THEM_ALL
     static
@@ -59,7 +70,26 @@ class KSTCORE_EXPORT KstRWLock {
     mutable int _waitingReaders, _waitingWriters;
 
     mutable Qt::HANDLE _writeLocker;
-    mutable QMap<Qt::HANDLE, int> _readLockers;
+
+    // The threads holding read locks, and how many each holds.  There are
+    // rarely more than a couple, so they are kept in place; only if more
+    // threads than that read at once does the rest go to the heap.
+    enum { InlineReadLockers = 4 };
+    struct ReadLocker {
+      Qt::HANDLE thread;
+      int count;
+    };
+    mutable ReadLocker _readLockers[InlineReadLockers];
+    mutable QMap<Qt::HANDLE, int> *_moreReadLockers;
+
+    mutable int _contendedReads, _contendedWrites, _contentionTime;
+
+  private:
+    int readLocksHeld(Qt::HANDLE thread) const;
+    void addReadLock(Qt::HANDLE thread) const;
+    bool removeReadLock(Qt::HANDLE thread) const;
+
+    static bool _trackContention;
 };
 
 
@@ -14,7 +14,7 @@
 #ifndef SharedPTR_H
 #define SharedPTR_H
 
-#include <QSemaphore>
+#include <QAtomicInt>
 #include <QDebug>
 
 //#define KST_DEBUG_SHARED
@@ -32,21 +32,19 @@
 
 namespace Kst {
 
-#define SEMAPHORE_COUNT 999999
-
 class Shared {
 public:
    /**
     * Standard constructor.  This will initialize the reference count
     * on this object to 0.
     */
-   Shared() : sem(SEMAPHORE_COUNT) { }
+   Shared() : _count(0) { }
 
    /**
     * Copy constructor.  This will @em not actually copy the objects
     * but it will initialize the reference count on this object to 0.
     */
-   Shared( const Shared & ) : sem(SEMAPHORE_COUNT) { }
+   Shared( const Shared & ) : _count(0) { }
 
    /**
     * Overloaded assignment operator.
@@ -57,7 +55,7 @@ public:
     * Increases the reference count by one.
     */
    void _KShared_ref() const {
-     sem.acquire(1);
+     _count.ref();
      KST_DBG qDebug() << "KShared_ref: " << (void*)this << " -> " << _KShared_count() << endl;
    }
 
@@ -66,9 +64,10 @@ public:
     * the count goes to 0, this object will delete itself.
     */
    void _KShared_unref() const {
-     sem.release(1);
+     // deref() tells exactly one thread that it released the last reference
+     bool last = !_count.deref();
      KST_DBG qDebug() << "KShared_unref: " << (void*)this << " -> " << _KShared_count() << endl;
-     if (SEMAPHORE_COUNT == sem.available()) delete this;
+     if (last) delete this;
    }
 
    /**
@@ -76,13 +75,13 @@ public:
     *
     * @return Number of references
     */
-   int _KShared_count() const { return SEMAPHORE_COUNT - sem.available(); }
+   int _KShared_count() const { return _count.fetchAndAddRelaxed(0); }
 
 protected:
    virtual ~Shared() { }
 
 private:
-   mutable QSemaphore sem;
+   mutable QAtomicInt _count;
 };
 
 
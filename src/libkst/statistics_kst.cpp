@@ -0,0 +1,422 @@
+/***************************************************************************
+           statistics_kst.cpp: running statistics of arrays of doubles
+                             -------------------
+    begin                : October, 2012
+    copyright            : (C) 2012 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "statistics_kst.h"
+
+#include <math.h>
+
+// GCC 4.9 and clang can build AVX2 code in a file compiled for plain x86,
+// and pick it at run time.  Elsewhere only SSE2, which every x86-64 has.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#  if defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)
+#    define KST_STATISTICS_AVX2 1
+#    define KST_STATISTICS_SSE2 1
+#    define KST_TARGET(t) __attribute__((target(t)))
+#    include <immintrin.h>
+#  endif
+#elif defined(_MSC_VER) && defined(_M_X64)
+#  define KST_STATISTICS_SSE2 1
+#  define KST_TARGET(t)
+#  include <emmintrin.h>
+#endif
+
+namespace Kst {
+
+static const double statisticsEpsilon = 1e-300;
+
+RunningStatistics::RunningStatistics()
+  : n(0), sum(0.0), sum2(0.0), min(0.0), max(0.0), minPos(0.0), dv2(0.0), last(0.0), rising(true) {
+}
+
+
+// One sample: also what the vector kernels fall back to around anything
+// which isn't finite.
+static inline void addSample(RunningStatistics &s, double x) {
+  if (x - x != 0.0) { // not finite
+    s.rising = false;
+    return;
+  }
+
+  if (s.n == 0) {
+    s.min = s.max = s.last = x;
+    s.minPos = (x > statisticsEpsilon) ? x : 1.0E300;
+  } else if (x <= s.last) {
+    s.rising = false;
+  }
+
+  const double dv = x - s.last;
+  s.dv2 += dv*dv;
+  s.last = x;
+
+  s.n++;
+  s.sum += x;
+  s.sum2 += x*x;
+
+  if (x > s.max) {
+    s.max = x;
+  } else if (x < s.min) {
+    s.min = x;
+  }
+  if (x < s.minPos && x > statisticsEpsilon) {
+    s.minPos = x;
+  }
+}
+
+
+static void addScalar(RunningStatistics &s, const double *v, int count) {
+  for (int i = 0; i < count; i++) {
+    addSample(s, v[i]);
+  }
+}
+
+
+// Folds the lanes of the vector kernels back into s.
+static inline void mergeLanes(RunningStatistics &s, const double *sum, const double *sum2,
+                              const double *min, const double *max, const double *minPos,
+                              const double *dv2, int lanes, int n, bool stepDown) {
+  if (n == 0) {
+    return;
+  }
+  for (int i = 0; i < lanes; i++) {
+    s.sum += sum[i];
+    s.sum2 += sum2[i];
+    s.dv2 += dv2[i];
+    if (min[i] < s.min) {
+      s.min = min[i];
+    }
+    if (max[i] > s.max) {
+      s.max = max[i];
+    }
+    if (minPos[i] < s.minPos) {
+      s.minPos = minPos[i];
+    }
+  }
+  s.n += n;
+  if (stepDown) {
+    s.rising = false;
+  }
+}
+
+
+#ifdef KST_STATISTICS_SSE2
+// Runs of finite samples go two at a time; the step into the first of
+// them needs the sample before to be the last finite one, so anything
+// else is handed to addSample().
+KST_TARGET("sse2") static void addSSE2(RunningStatistics &s, const double *v, int count) {
+  const __m128d zero = _mm_setzero_pd();
+  const __m128d epsilon = _mm_set1_pd(statisticsEpsilon);
+  const __m128d noMinPos = _mm_set1_pd(1.0E300);
+  __m128d sum = zero, sum2 = zero, dv2 = zero;
+  __m128d min = _mm_set1_pd(HUGE_VAL), max = _mm_set1_pd(-HUGE_VAL), minPos = noMinPos;
+  __m128d stepDown = zero;
+  int n = 0;
+
+  bool lastIsPrevious = false; // is v[i-1] the last finite sample?
+  int i = 0;
+  while (i < count) {
+    if (lastIsPrevious && i + 2 <= count) {
+      const __m128d x = _mm_loadu_pd(v + i);
+      if (_mm_movemask_pd(_mm_cmpeq_pd(_mm_sub_pd(x, x), zero)) == 0x3) {
+        const __m128d dv = _mm_sub_pd(x, _mm_loadu_pd(v + i - 1));
+        dv2 = _mm_add_pd(dv2, _mm_mul_pd(dv, dv));
+        stepDown = _mm_or_pd(stepDown, _mm_cmple_pd(dv, zero));
+        sum = _mm_add_pd(sum, x);
+        sum2 = _mm_add_pd(sum2, _mm_mul_pd(x, x));
+        min = _mm_min_pd(min, x);
+        max = _mm_max_pd(max, x);
+        const __m128d positive = _mm_cmpgt_pd(x, epsilon);
+        minPos = _mm_min_pd(minPos, _mm_or_pd(_mm_and_pd(positive, x), _mm_andnot_pd(positive, noMinPos)));
+        n += 2;
+        i += 2;
+        continue;
+      }
+    }
+    if (lastIsPrevious) {
+      s.last = v[i - 1];
+    }
+    addSample(s, v[i]);
+    lastIsPrevious = (v[i] - v[i] == 0.0);
+    i++;
+  }
+  if (lastIsPrevious) {
+    s.last = v[count - 1];
+  }
+
+  double l_sum[2], l_sum2[2], l_min[2], l_max[2], l_minPos[2], l_dv2[2];
+  _mm_storeu_pd(l_sum, sum);
+  _mm_storeu_pd(l_sum2, sum2);
+  _mm_storeu_pd(l_min, min);
+  _mm_storeu_pd(l_max, max);
+  _mm_storeu_pd(l_minPos, minPos);
+  _mm_storeu_pd(l_dv2, dv2);
+  mergeLanes(s, l_sum, l_sum2, l_min, l_max, l_minPos, l_dv2, 2, n, _mm_movemask_pd(stepDown) != 0);
+}
+#endif
+
+
+#ifdef KST_STATISTICS_AVX2
+KST_TARGET("avx2") static void addAVX2(RunningStatistics &s, const double *v, int count) {
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d epsilon = _mm256_set1_pd(statisticsEpsilon);
+  const __m256d noMinPos = _mm256_set1_pd(1.0E300);
+  __m256d sum = zero, sum2 = zero, dv2 = zero;
+  __m256d min = _mm256_set1_pd(HUGE_VAL), max = _mm256_set1_pd(-HUGE_VAL), minPos = noMinPos;
+  __m256d stepDown = zero;
+  int n = 0;
+
+  bool lastIsPrevious = false;
+  int i = 0;
+  while (i < count) {
+    if (lastIsPrevious && i + 4 <= count) {
+      const __m256d x = _mm256_loadu_pd(v + i);
+      if (_mm256_movemask_pd(_mm256_cmp_pd(_mm256_sub_pd(x, x), zero, _CMP_EQ_OQ)) == 0xf) {
+        const __m256d dv = _mm256_sub_pd(x, _mm256_loadu_pd(v + i - 1));
+        dv2 = _mm256_add_pd(dv2, _mm256_mul_pd(dv, dv));
+        stepDown = _mm256_or_pd(stepDown, _mm256_cmp_pd(dv, zero, _CMP_LE_OQ));
+        sum = _mm256_add_pd(sum, x);
+        sum2 = _mm256_add_pd(sum2, _mm256_mul_pd(x, x));
+        min = _mm256_min_pd(min, x);
+        max = _mm256_max_pd(max, x);
+        const __m256d positive = _mm256_cmp_pd(x, epsilon, _CMP_GT_OQ);
+        minPos = _mm256_min_pd(minPos, _mm256_blendv_pd(noMinPos, x, positive));
+        n += 4;
+        i += 4;
+        continue;
+      }
+    }
+    if (lastIsPrevious) {
+      s.last = v[i - 1];
+    }
+    addSample(s, v[i]);
+    lastIsPrevious = (v[i] - v[i] == 0.0);
+    i++;
+  }
+  if (lastIsPrevious) {
+    s.last = v[count - 1];
+  }
+
+  double l_sum[4], l_sum2[4], l_min[4], l_max[4], l_minPos[4], l_dv2[4];
+  _mm256_storeu_pd(l_sum, sum);
+  _mm256_storeu_pd(l_sum2, sum2);
+  _mm256_storeu_pd(l_min, min);
+  _mm256_storeu_pd(l_max, max);
+  _mm256_storeu_pd(l_minPos, minPos);
+  _mm256_storeu_pd(l_dv2, dv2);
+  mergeLanes(s, l_sum, l_sum2, l_min, l_max, l_minPos, l_dv2, 4, n, _mm256_movemask_pd(stepDown) != 0);
+}
+#endif
+
+
+static int sumFiniteScalar(const double *v, int count, double &sum) {
+  double total = 0.0;
+  int n = 0;
+  for (int i = 0; i < count; i++) {
+    if (v[i] - v[i] == 0.0) {
+      total += v[i];
+      n++;
+    }
+  }
+  sum = total;
+  return n;
+}
+
+
+// The finite lanes are masked in: anything else adds nothing and counts
+// for nothing.
+#ifdef KST_STATISTICS_SSE2
+KST_TARGET("sse2") static int sumFiniteSSE2(const double *v, int count, double &sum) {
+  const __m128d zero = _mm_setzero_pd();
+  const __m128d one = _mm_set1_pd(1.0);
+  __m128d total = zero, n = zero;
+  int i = 0;
+  for (; i + 2 <= count; i += 2) {
+    const __m128d x = _mm_loadu_pd(v + i);
+    const __m128d finite = _mm_cmpeq_pd(_mm_sub_pd(x, x), zero);
+    total = _mm_add_pd(total, _mm_and_pd(finite, x));
+    n = _mm_add_pd(n, _mm_and_pd(finite, one));
+  }
+
+  double l_total[2], l_n[2];
+  _mm_storeu_pd(l_total, total);
+  _mm_storeu_pd(l_n, n);
+  double rest = 0.0;
+  const int found = sumFiniteScalar(v + i, count - i, rest);
+  sum = l_total[0] + l_total[1] + rest;
+  return int(l_n[0] + l_n[1]) + found;
+}
+#endif
+
+
+#ifdef KST_STATISTICS_AVX2
+KST_TARGET("avx2") static int sumFiniteAVX2(const double *v, int count, double &sum) {
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d one = _mm256_set1_pd(1.0);
+  __m256d total = zero, n = zero;
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m256d x = _mm256_loadu_pd(v + i);
+    const __m256d finite = _mm256_cmp_pd(_mm256_sub_pd(x, x), zero, _CMP_EQ_OQ);
+    total = _mm256_add_pd(total, _mm256_and_pd(finite, x));
+    n = _mm256_add_pd(n, _mm256_and_pd(finite, one));
+  }
+
+  double l_total[4], l_n[4];
+  _mm256_storeu_pd(l_total, total);
+  _mm256_storeu_pd(l_n, n);
+  double rest = 0.0;
+  const int found = sumFiniteScalar(v + i, count - i, rest);
+  sum = l_total[0] + l_total[1] + l_total[2] + l_total[3] + rest;
+  return int(l_n[0] + l_n[1] + l_n[2] + l_n[3]) + found;
+}
+#endif
+
+
+typedef void (*StatisticsKernel)(RunningStatistics &, const double *, int);
+typedef int (*SumFiniteKernel)(const double *, int, double &);
+
+static RunningStatistics::Kernel bestStatisticsKernel() {
+#ifdef KST_STATISTICS_AVX2
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return RunningStatistics::AVX2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return RunningStatistics::SSE2;
+  }
+#elif defined(KST_STATISTICS_SSE2)
+  return RunningStatistics::SSE2;
+#endif
+  return RunningStatistics::Scalar;
+}
+
+// Picked once; a race on the first call only means picking it twice.
+static RunningStatistics::Kernel statisticsKernel = RunningStatistics::Kernel(-1);
+
+static StatisticsKernel statisticsKernelFunction(RunningStatistics::Kernel kernel) {
+  switch (kernel) {
+#ifdef KST_STATISTICS_AVX2
+    case RunningStatistics::AVX2:
+      return addAVX2;
+#endif
+#ifdef KST_STATISTICS_SSE2
+    case RunningStatistics::SSE2:
+      return addSSE2;
+#endif
+    default:
+      return addScalar;
+  }
+}
+
+
+static SumFiniteKernel sumFiniteKernelFunction(RunningStatistics::Kernel kernel) {
+  switch (kernel) {
+#ifdef KST_STATISTICS_AVX2
+    case RunningStatistics::AVX2:
+      return sumFiniteAVX2;
+#endif
+#ifdef KST_STATISTICS_SSE2
+    case RunningStatistics::SSE2:
+      return sumFiniteSSE2;
+#endif
+    default:
+      return sumFiniteScalar;
+  }
+}
+
+
+bool RunningStatistics::kernelSupported(Kernel kernel) {
+  switch (kernel) {
+    case Scalar:
+      return true;
+    case SSE2:
+#ifdef KST_STATISTICS_SSE2
+      return bestStatisticsKernel() >= SSE2;
+#else
+      return false;
+#endif
+    case AVX2:
+#ifdef KST_STATISTICS_AVX2
+      return bestStatisticsKernel() >= AVX2;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+
+RunningStatistics::Kernel RunningStatistics::kernel() {
+  if (statisticsKernel < 0) {
+    statisticsKernel = bestStatisticsKernel();
+  }
+  return statisticsKernel;
+}
+
+
+bool RunningStatistics::setKernel(Kernel kernel) {
+  if (!kernelSupported(kernel)) {
+    return false;
+  }
+  statisticsKernel = kernel;
+  return true;
+}
+
+
+const char *RunningStatistics::kernelName(Kernel kernel) {
+  switch (kernel) {
+    case SSE2:
+      return "sse2";
+    case AVX2:
+      return "avx2";
+    default:
+      return "scalar";
+  }
+}
+
+
+void RunningStatistics::add(const double *v, int count) {
+  if (count > 0) {
+    statisticsKernelFunction(kernel())(*this, v, count);
+  }
+}
+
+
+int RunningStatistics::sumFinite(const double *v, int count, double &sum) {
+  if (count <= 0) {
+    sum = 0.0;
+    return 0;
+  }
+  return sumFiniteKernelFunction(kernel())(v, count, sum);
+}
+
+
+void RunningStatistics::add(const float *v, int count) {
+  const int blockSize = 512;
+  double block[blockSize];
+  StatisticsKernel addBlock = statisticsKernelFunction(kernel());
+  for (int i = 0; i < count; i += blockSize) {
+    const int n = (count - i < blockSize) ? count - i : blockSize;
+    for (int j = 0; j < n; j++) {
+      block[j] = v[i + j];
+    }
+    addBlock(*this, block, n);
+  }
+}
+
+}
+
+// vim: ts=2 sw=2 et
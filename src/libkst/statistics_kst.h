@@ -0,0 +1,69 @@
+/***************************************************************************
+            statistics_kst.h: running statistics of arrays of doubles
+                             -------------------
+    begin                : October, 2012
+    copyright            : (C) 2012 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef STATISTICS_KST_H
+#define STATISTICS_KST_H
+
+#include "kst_export.h"
+
+namespace Kst {
+
+// The statistics Vector, Matrix and the statistics plugin all need, in one
+// pass: non-finite samples are skipped, and steps are taken between
+// consecutive finite samples.  add() can be called again with more samples
+// to carry on where the last call left off.
+//
+// On x86 the work is done with SSE2 or AVX2 when the processor has them.
+// The sums are then added up in a different order than by the plain loop,
+// so the last bits may differ between kernels.
+
+struct KSTCORE_EXPORT RunningStatistics
+{
+  RunningStatistics();
+
+  void add(const double *v, int count);
+  /** single precision samples go through the same kernels, a block at a time */
+  void add(const float *v, int count);
+
+  /** Adds up the finite samples of v into sum, and returns how many there
+    * were: for boxcar averages, with the same kernel as add(). */
+  static int sumFinite(const double *v, int count, double &sum);
+
+  int n; // finite samples
+  double sum, sum2;
+  double min, max;
+  double minPos; // smallest positive sample, or 1.0E300
+  double dv2;    // sum of the squared steps between finite samples
+  double last;   // last finite sample
+  bool rising;   // no step down or sideways, and nothing non-finite
+
+  enum Kernel { Scalar = 0, SSE2, AVX2 };
+
+  /** the kernel add() is using */
+  static Kernel kernel();
+  /** For benchmarks and tests.  Returns false, and leaves the kernel alone,
+    * if the processor can't run the one asked for. */
+  static bool setKernel(Kernel kernel);
+  static bool kernelSupported(Kernel kernel);
+  static const char *kernelName(Kernel kernel);
+};
+
+}
+
+#endif
+
+// vim: ts=2 sw=2 et
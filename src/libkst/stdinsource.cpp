@@ -54,6 +54,7 @@ StdinSource::StdinSource(ObjectStore *store, QSettings *cfg)
 
 
 StdinSource::~StdinSource() {
+  stopReadAhead();
   _file->close();
   delete _file;
   _file = 0L;
@@ -0,0 +1,227 @@
+/***************************************************************************
+                 updategraph.cpp: dependency graph of Objects
+                             -------------------
+    begin                : October, 2012
+    copyright            : (C) 2012 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "updategraph.h"
+
+#include <QMap>
+#include <QSet>
+
+namespace Kst {
+
+UpdateGraph::UpdateGraph() : _sorted(true) {
+}
+
+
+UpdateGraph::~UpdateGraph() {
+  clear();
+}
+
+
+void UpdateGraph::addObject(Object *o) {
+  if (!o || _nodes.contains(o)) {
+    return;
+  }
+
+  Node *node = new Node(o);
+  _nodes.insert(o, node);
+  _stale.append(node);
+  _sorted = false;
+}
+
+
+void UpdateGraph::removeObject(Object *o) {
+  Node *node = _nodes.take(o);
+  if (!node) {
+    return;
+  }
+
+  detachEdges(node);
+  foreach (Node *dependent, node->dependents) {
+    dependent->inputs.removeAll(node);
+  }
+  _stale.removeAll(node);
+  delete node;
+  _sorted = false;
+}
+
+
+void UpdateGraph::clear() {
+  qDeleteAll(_nodes);
+  _nodes.clear();
+  _stale.clear();
+  _sorted = true;
+}
+
+
+void UpdateGraph::invalidate(Object *o) {
+  Node *node = _nodes.value(o);
+  if (node && node->edgesValid) {
+    node->edgesValid = false;
+    _stale.append(node);
+  }
+}
+
+
+QList<ObjectPtr> UpdateGraph::forcedObjects() const {
+  QList<ObjectPtr> forced;
+  for (QHash<Object*, Node*>::ConstIterator it = _nodes.begin(); it != _nodes.end(); ++it) {
+    if (it.key()->serial() == Object::Forced) {
+      forced.append(it.key());
+    }
+  }
+  return forced;
+}
+
+
+QList<ObjectPtr> UpdateGraph::downstream(const QList<ObjectPtr> &seeds, QList<ObjectPtr> *cleanInputs) {
+  // ranks are unique, so the map gives us topological order.
+  QMap<int, Node*> ordered;
+  foreach (Node *node, dirtyNodes(seeds, cleanInputs)) {
+    ordered.insert(node->rank, node);
+  }
+
+  QList<ObjectPtr> objects;
+  foreach (Node *node, ordered) {
+    objects.append(node->object);
+  }
+  return objects;
+}
+
+
+QList<QList<ObjectPtr> > UpdateGraph::downstreamByLevel(const QList<ObjectPtr> &seeds, QList<ObjectPtr> *cleanInputs) {
+  QMap<int, QList<ObjectPtr> > levels;
+  foreach (Node *node, dirtyNodes(seeds, cleanInputs)) {
+    levels[node->level].append(node->object);
+  }
+  return levels.values();
+}
+
+
+QList<UpdateGraph::Node*> UpdateGraph::dirtyNodes(const QList<ObjectPtr> &seeds, QList<ObjectPtr> *cleanInputs) {
+  foreach (Node *node, _stale) {
+    refreshEdges(node);
+  }
+  _stale.clear();
+
+  if (!_sorted) {
+    sort();
+  }
+
+  // everything reachable from the seeds needs to be updated
+  QSet<Node*> dirty;
+  QList<Node*> pending;
+  foreach (const ObjectPtr &seed, seeds) {
+    Node *node = _nodes.value(const_cast<Object*>(seed.data()));
+    if (node && !dirty.contains(node)) {
+      dirty.insert(node);
+      pending.append(node);
+    }
+  }
+  while (!pending.isEmpty()) {
+    Node *node = pending.takeLast();
+    foreach (Node *dependent, node->dependents) {
+      if (!dirty.contains(dependent)) {
+        dirty.insert(dependent);
+        pending.append(dependent);
+      }
+    }
+  }
+
+  if (cleanInputs) {
+    QSet<Node*> clean;
+    foreach (Node *node, dirty) {
+      foreach (Node *input, node->inputs) {
+        if (!dirty.contains(input)) {
+          clean.insert(input);
+        }
+      }
+    }
+    foreach (Node *node, clean) {
+      cleanInputs->append(node->object);
+    }
+  }
+
+  return dirty.toList();
+}
+
+
+void UpdateGraph::refreshEdges(Node *node) {
+  detachEdges(node);
+
+  foreach (const ObjectPtr &p, node->object->inputObjects()) {
+    Node *input = _nodes.value(const_cast<Object*>(p.data()));
+    // inputs which aren't in the store can't be updated by us anyway
+    if (input && input != node && !node->inputs.contains(input)) {
+      node->inputs.append(input);
+      input->dependents.append(node);
+    }
+  }
+  node->edgesValid = true;
+  _sorted = false;
+}
+
+
+void UpdateGraph::detachEdges(Node *node) {
+  foreach (Node *input, node->inputs) {
+    input->dependents.removeAll(node);
+  }
+  node->inputs.clear();
+}
+
+
+// Kahn's algorithm.  Anything left over is part of a cycle, which shouldn't
+// happen; it goes at the end and the update manager's deferral loop copes.
+void UpdateGraph::sort() {
+  QHash<Node*, int> inDegree;
+  QList<Node*> ready;
+
+  foreach (Node *node, _nodes) {
+    node->level = 0;
+    inDegree.insert(node, node->inputs.count());
+    if (node->inputs.isEmpty()) {
+      ready.append(node);
+    }
+  }
+
+  int rank = 0;
+  for (int i = 0; i < ready.count(); ++i) {
+    Node *node = ready.at(i);
+    node->rank = rank++;
+    inDegree.remove(node);
+    foreach (Node *dependent, node->dependents) {
+      dependent->level = qMax(dependent->level, node->level + 1);
+      if (--inDegree[dependent] == 0) {
+        ready.append(dependent);
+      }
+    }
+  }
+
+  int level = 0;
+  foreach (Node *node, ready) {
+    level = qMax(level, node->level);
+  }
+  for (QHash<Node*, int>::ConstIterator it = inDegree.begin(); it != inDegree.end(); ++it) {
+    it.key()->rank = rank++;
+    it.key()->level = ++level;
+  }
+
+  _sorted = true;
+}
+
+}
+
+// vim: ts=2 sw=2 et
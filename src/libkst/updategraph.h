@@ -0,0 +1,96 @@
+/***************************************************************************
+                 updategraph.h: dependency graph of Objects
+                             -------------------
+    begin                : October, 2012
+    copyright            : (C) 2012 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef UPDATEGRAPH_H
+#define UPDATEGRAPH_H
+
+#include <QHash>
+#include <QList>
+
+#include "kst_export.h"
+#include "object.h"
+
+namespace Kst {
+
+// The UpdateGraph keeps track of which Objects in an ObjectStore feed
+// which other Objects, so that an update cycle only has to visit the
+// objects downstream of something that changed, and can visit them in
+// dependency order.
+//
+// Nodes are added and removed by the ObjectStore, which owns the graph.
+// Edges come from Object::inputObjects() and are resolved lazily: a node's
+// edges are (re)read the first time it is scheduled after being added or
+// invalidated.  The caller is responsible for locking (the ObjectStore
+// lock protects the graph).
+
+class KSTCORE_EXPORT UpdateGraph
+{
+  public:
+    UpdateGraph();
+    ~UpdateGraph();
+
+    void addObject(Object *o);
+    void removeObject(Object *o);
+    void clear();
+
+    /** the inputs of o may have changed: re-read them next time */
+    void invalidate(Object *o);
+
+    /** objects which have had registerChange() or reset() called on them */
+    QList<ObjectPtr> forcedObjects() const;
+
+    /** Returns the objects downstream of (and including) seeds, sorted so
+      * that every object comes after all of its inputs.  Inputs of the
+      * returned objects which are not themselves downstream of seeds are
+      * returned in cleanInputs. */
+    QList<ObjectPtr> downstream(const QList<ObjectPtr> &seeds, QList<ObjectPtr> *cleanInputs = 0);
+
+    /** As downstream(), but split into levels: no object depends on
+      * another object in the same level, so each level can be updated
+      * in parallel once the levels before it are done. */
+    QList<QList<ObjectPtr> > downstreamByLevel(const QList<ObjectPtr> &seeds, QList<ObjectPtr> *cleanInputs = 0);
+
+    int count() const { return _nodes.count(); }
+
+  private:
+    Q_DISABLE_COPY(UpdateGraph)
+
+    struct Node {
+      Node(Object *o) : object(o), rank(0), level(0), edgesValid(false) {}
+      Object *object;
+      QList<Node*> inputs;
+      QList<Node*> dependents;
+      int rank;
+      int level; // length of the longest path from a node with no inputs
+      bool edgesValid;
+    };
+
+    void refreshEdges(Node *node);
+    void detachEdges(Node *node);
+    void sort();
+    QList<Node*> dirtyNodes(const QList<ObjectPtr> &seeds, QList<ObjectPtr> *cleanInputs);
+
+    QHash<Object*, Node*> _nodes;
+    QList<Node*> _stale;
+    bool _sorted;
+};
+
+}
+
+#endif
+
+// vim: ts=2 sw=2 et
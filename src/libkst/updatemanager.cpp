@@ -14,16 +14,74 @@
 
 #include "primitive.h"
 #include "datasource.h"
+#include "datavector.h"
 #include "objectstore.h"
 #include "measuretime.h"
+#include "updateprofiler.h"
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMultiMap>
+#include <QRunnable>
+#include <QThreadPool>
 #include <QTimer>
 #include <QDebug>
 
 #define DEFAULT_MIN_UPDATE_PERIOD 2000
+#define MIN_ADAPTIVE_UPDATE_PERIOD 20
 
 namespace Kst {
 
+// Updates one object, and tells the profiler how long it took if it
+// actually changed.
+static Object::UpdateType profiledUpdate(Object *object, qint64 serial, UpdateProfiler::Kind kind) {
+  QElapsedTimer timer;
+  timer.start();
+  object->writeLock();
+  Object::UpdateType result = object->objectUpdate(serial);
+  object->unlock();
+  if (result == Object::Updated) {
+    UpdateProfiler::self()->record(kind, object->shortName(), object->typeString(), timer.nsecsElapsed());
+  }
+  return result;
+}
+
+
+// Updates one object of a level on a worker thread.
+class ObjectUpdateJob : public QRunnable
+{
+  public:
+    ObjectUpdateJob(const ObjectPtr &object, qint64 serial, UpdateProfiler::Kind kind, Object::UpdateType *result)
+      : _object(object), _serial(serial), _kind(kind), _result(result) {}
+
+    void run() {
+      *_result = profiledUpdate(_object, _serial, _kind);
+    }
+
+  private:
+    ObjectPtr _object;
+    qint64 _serial;
+    UpdateProfiler::Kind _kind;
+    Object::UpdateType *_result;
+};
+
+
+// Runs a whole update cycle away from the GUI thread.
+class UpdateCycleJob : public QRunnable
+{
+  public:
+    UpdateCycleJob(UpdateManager *manager) : _manager(manager) {}
+
+    void run() {
+      qint64 serial = _manager->runCycle();
+      QMetaObject::invokeMethod(_manager, "backgroundCycleFinished", Qt::QueuedConnection, Q_ARG(qint64, serial));
+    }
+
+  private:
+    UpdateManager *_manager;
+};
+
+
 static UpdateManager *_self = 0;
 void UpdateManager::cleanup() {
   delete _self;
@@ -47,13 +105,52 @@ UpdateManager::UpdateManager() {
   _store = 0;
   _delayedUpdateScheduled = false;
   _updateInProgress = false;
+  _updateThreads = 1;
+  _threadPool = new QThreadPool(this);
+  _threadPool->setMaxThreadCount(_updateThreads);
+  _backgroundUpdates = false;
+  _cycleThread = new QThreadPool(this);
+  _cycleThread->setMaxThreadCount(1);
+  _targetLatency = 0;
+  _adaptivePeriod = DEFAULT_MIN_UPDATE_PERIOD;
+  _updateCost = 0;
+  _decimation = 0;
+  _updatePending = false;
   _time.start();
 }
 
 
 UpdateManager::~UpdateManager() {
+  _cycleThread->waitForDone();
 }
 
+
+void UpdateManager::setUpdateThreads(int threads) {
+  _updateThreads = qMax(1, threads);
+  _threadPool->setMaxThreadCount(_updateThreads);
+}
+
+
+void UpdateManager::setBackgroundUpdates(bool background) {
+  if (!background) {
+    _cycleThread->waitForDone();
+  }
+  _backgroundUpdates = background;
+}
+
+
+void UpdateManager::setTargetLatency(int latency) {
+  _targetLatency = qMax(0, latency);
+  _adaptivePeriod = qMax(MIN_ADAPTIVE_UPDATE_PERIOD, _targetLatency / 2);
+  _updateCost = 0;
+  _updatePending = false;
+  if (_decimation != 0) {
+    _decimation = 0;
+    emit decimationChanged(0);
+  }
+}
+
+
 void UpdateManager::delayedUpdates() {
   _delayedUpdateScheduled = false;
   doUpdates();
@@ -73,11 +170,19 @@ void UpdateManager::doUpdates(bool forceImmediate) {
     return;
   }
 
+  // Falling behind: rather than checking back every 20 ms, do one more
+  // update when the last one has been drawn, whatever came in meanwhile.
+  if (_targetLatency > 0 && _updateInProgress && !forceImmediate) {
+    _updatePending = true;
+    return;
+  }
+
+  int period = updatePeriod();
   int dT = _time.elapsed();
-  if (((dT<_minUpdatePeriod) || (_updateInProgress)) && (!forceImmediate)) {
+  if (((dT<period) || (_updateInProgress)) && (!forceImmediate)) {
     if (!_delayedUpdateScheduled) {
       _delayedUpdateScheduled = true;
-      int deferTime = _minUpdatePeriod-dT;
+      int deferTime = period-dT;
       if (deferTime <= 0) {
         deferTime = 20; // if an update is already in progress, wait this long to check again.
       }
@@ -88,46 +193,257 @@ void UpdateManager::doUpdates(bool forceImmediate) {
   _updateInProgress = true;
   _time.restart();
 
+  if (_backgroundUpdates && !forceImmediate) {
+    // objectsUpdated() follows from backgroundCycleFinished()
+    _cycleThread->start(new UpdateCycleJob(this));
+    return;
+  }
+
+  emit objectsUpdated(runCycle());
+}
+
+
+void UpdateManager::backgroundCycleFinished(qint64 serial) {
+  emit objectsUpdated(serial);
+}
+
+
+void UpdateManager::viewItemUpdateFinished() {
+  finishViewItemUpdate(true);
+}
+
+
+void UpdateManager::viewItemUpdateAbandoned() {
+  finishViewItemUpdate(false);
+}
+
+
+// Called from the end of a paint, so anything merged in meanwhile is left
+// to the event loop rather than updated from in here.
+void UpdateManager::finishViewItemUpdate(bool drawn) {
+  _updateInProgress = false;
+
+  if (_targetLatency > 0) {
+    if (drawn) {
+      // _time was restarted when the update began.
+      adaptUpdatePeriod(_time.elapsed());
+    }
+    if (_updatePending) {
+      _updatePending = false;
+      if (!_delayedUpdateScheduled) {
+        _delayedUpdateScheduled = true;
+        QTimer::singleShot(0, this, SLOT(delayedUpdates()));
+      }
+    }
+  }
+}
+
+
+// Keep the time spent updating and drawing within the latency budget, and
+// leave the GUI at least as long idle as it spends busy.
+void UpdateManager::adaptUpdatePeriod(int latency) {
+  _updateCost = (_updateCost > 0) ? (3 * _updateCost + latency) / 4 : latency;
+
+  const int decimation = _decimation;
+  if (_updateCost > _targetLatency / 2 && _decimation < MaxDecimation) {
+    ++_decimation;
+  } else if (_updateCost < _targetLatency / 4 && _decimation > 0) {
+    --_decimation;
+  }
+
+  _adaptivePeriod = qMax(_updateCost, _targetLatency - _updateCost);
+  _adaptivePeriod = qMax(MIN_ADAPTIVE_UPDATE_PERIOD, _adaptivePeriod);
+
+  if (_decimation != decimation) {
+    emit decimationChanged(_decimation);
+  }
+}
+
+
+// One pass over everything which might need updating.  Only one cycle runs
+// at a time, whichever thread it is on.
+qint64 UpdateManager::runCycle() {
+  QMutexLocker ml(&_cycleMutex);
+
   _serial++;
+  UpdateProfiler::self()->startCycle(_serial);
 
   int n_updated=0, n_deferred=0, n_unchanged = 0;
   qint64 retval;
+  QList<ObjectPtr> changed;
 
   // update the datasources
-  foreach (DataSourcePtr ds, _store->dataSourceList()) {
-    ds->writeLock();
-    retval = ds->objectUpdate(_serial);
-    ds->unlock();
-    if (retval == Object::Updated) n_updated++;
-    else if (retval == Object::Deferred) n_deferred++;
-    else if (retval == Object::NoChange) n_unchanged++;
+  DataSourceList sources = _store->dataSourceList();
+  QVector<Object::UpdateType> dsResults(sources.count());
+  updateDataSources(sources, dsResults);
+
+  for (int i = 0; i < sources.count(); ++i) {
+    if (dsResults.at(i) == Object::Updated) {
+      n_updated++;
+      changed.append(ObjectPtr(sources[i].data()));
+    } else if (dsResults.at(i) == Object::Deferred) {
+      n_deferred++;
+    } else if (dsResults.at(i) == Object::NoChange) {
+      n_unchanged++;
+    }
   }
 
   //qDebug() << "ds up: " << n_updated << "  ds def: " << n_deferred << " n_no: " << n_unchanged;
   
   //MeasureTime t(" UpdateManager::doUpdates loop");
 
-  int i_loop = retval = 0;
-  int maxloop = _store->objectList().size();
-  do {
-    n_updated = n_unchanged = n_deferred = 0;
-    // update data objects
-    foreach (ObjectPtr p, _store->objectList()) {
-      p->writeLock();
-      retval = p->objectUpdate(_serial);
-      p->unlock();
-
-      if (retval == Object::Updated) n_updated++;
-      else if (retval == Object::Deferred) n_deferred++;
-      else if (retval == Object::NoChange) n_unchanged++;
+  // objects which had registerChange() called need updating even if
+  // none of their inputs changed.
+  changed += _store->forcedObjects();
+
+  // only objects downstream of a change get updated, in dependency order.
+  QList<ObjectPtr> cleanInputs;
+  QList<QList<ObjectPtr> > levels = _store->updateLevels(changed, &cleanInputs);
+
+  // the other inputs of those objects are up to date by definition
+  foreach (ObjectPtr p, cleanInputs) {
+    p->writeLock();
+    if (p->_serial != Object::Forced) {
+      p->_serial = _serial;
     }
-    maxloop = qMin(maxloop,n_deferred);
-    //qDebug() << "loop: " << i_loop << " obj up: " << n_updated << "  obj def: " << n_deferred << " obj_no: " << n_unchanged << "dt:" << double(_time.elapsed())/1000.0;
-    i_loop++;
-  } while ((n_deferred + n_updated > 0) && (i_loop<=maxloop));
+    p->unlock();
+  }
 
-  emit objectsUpdated(_serial);
+  n_updated = n_unchanged = n_deferred = 0;
+  foreach (const QList<ObjectPtr> &level, levels) {
+    const QList<DataSourcePtr> batched = batchVectorReads(level);
+    QVector<Object::UpdateType> results(level.count());
+    updateLevel(level, results);
+    foreach (const DataSourcePtr &source, batched) {
+      source->writeLock();
+      source->clearVectorBatch();
+      source->unlock();
+    }
+
+    for (int i = 0; i < level.count(); ++i) {
+      if (results.at(i) == Object::Updated) {
+        n_updated++;
+      } else if (results.at(i) == Object::NoChange) {
+        n_unchanged++;
+      } else if (results.at(i) == Object::Deferred) {
+        n_deferred++;
+        // an input changed without us hearing about it.
+        _store->invalidateInputs(level.at(i));
+      }
+    }
+  }
+
+  // If anything was deferred the graph was out of date.  Finish this cycle
+  // the slow way: keep walking everything until nothing is deferred.
+  int i_loop = 0;
+  if (n_deferred > 0) {
+    int maxloop = _store->objectList().size();
+    do {
+      n_updated = n_unchanged = n_deferred = 0;
+      foreach (ObjectPtr p, _store->objectList()) {
+        retval = profiledUpdate(p, _serial, UpdateProfiler::ObjectUpdate);
+
+        if (retval == Object::Updated) n_updated++;
+        else if (retval == Object::Deferred) n_deferred++;
+        else if (retval == Object::NoChange) n_unchanged++;
+      }
+      maxloop = qMin(maxloop,n_deferred);
+      //qDebug() << "loop: " << i_loop << " obj up: " << n_updated << "  obj def: " << n_deferred << " obj_no: " << n_unchanged << "dt:" << double(_time.elapsed())/1000.0;
+      i_loop++;
+    } while ((n_deferred + n_updated > 0) && (i_loop<=maxloop));
+  }
+
+  UpdateProfiler::self()->finishCycle(i_loop);
+  return _serial;
 }
+
+
+// Data sources don't depend on each other, so they can all check their
+// files at once.  The ones which were slow last time are started first,
+// so a slow source is overlapped with the others rather than holding up
+// the end of the stage.
+void UpdateManager::updateDataSources(const QList<DataSourcePtr> &sources, QVector<Object::UpdateType> &results) {
+  if (_updateThreads < 2 || sources.count() < 2) {
+    for (int i = 0; i < sources.count(); ++i) {
+      results[i] = profiledUpdate(sources.at(i), _serial, UpdateProfiler::DataSourceUpdate);
+    }
+    return;
+  }
+
+  QMultiMap<int, int> slowestFirst;
+  for (int i = 0; i < sources.count(); ++i) {
+    slowestFirst.insert(-sources.at(i)->updateTime(), i);
+  }
+  foreach (int i, slowestFirst) {
+    DataSourcePtr ds = sources.at(i);
+    _threadPool->start(new ObjectUpdateJob(ObjectPtr(ds.data()), _serial, UpdateProfiler::DataSourceUpdate, &results[i]));
+  }
+  _threadPool->waitForDone();
+}
+
+
+// The vectors of a level which read the same row oriented source have
+// their new frames read in one go, before any of them is updated: the
+// source then goes through its rows once rather than once for every
+// column.  Returns the sources which are holding a batch.
+QList<DataSourcePtr> UpdateManager::batchVectorReads(const QList<ObjectPtr> &level) {
+  QHash<DataSource*, QList<DataSource::VectorRead> > reads;
+  QList<DataSourcePtr> sources;
+  qint64 frames = 0;
+  foreach (const ObjectPtr &object, level) {
+    DataVectorPtr vector = kst_cast<DataVector>(object);
+    if (!vector) {
+      continue;
+    }
+    DataSource::VectorRead read;
+    vector->readLock();
+    DataSourcePtr source = vector->dataSource();
+    const bool planned = source && source->readsFieldsTogether() &&
+                         vector->plannedRead(read.startingFrame, read.numberOfFrames);
+    read.field = vector->field();
+    vector->unlock();
+
+    if (!planned || frames + read.numberOfFrames > MaxBatchedFrames) {
+      continue;
+    }
+    frames += read.numberOfFrames;
+    if (!reads.contains(source.data())) {
+      sources.append(source);
+    }
+    reads[source.data()].append(read);
+  }
+
+  QList<DataSourcePtr> batched;
+  foreach (const DataSourcePtr &source, sources) {
+    if (reads.value(source.data()).count() < 2) {
+      continue;
+    }
+    source->writeLock();
+    source->batchVectors(reads.value(source.data()));
+    source->unlock();
+    batched.append(source);
+  }
+  return batched;
+}
+
+
+// Nothing in a level depends on anything else in it, so the objects can
+// be updated in any order, or all at once.  Each object write locks
+// itself here, and its inputs and outputs in internalUpdate().
+void UpdateManager::updateLevel(const QList<ObjectPtr> &level, QVector<Object::UpdateType> &results) {
+  if (_updateThreads < 2 || level.count() < 2) {
+    for (int i = 0; i < level.count(); ++i) {
+      results[i] = profiledUpdate(level.at(i), _serial, UpdateProfiler::ObjectUpdate);
+    }
+    return;
+  }
+
+  for (int i = 0; i < level.count(); ++i) {
+    _threadPool->start(new ObjectUpdateJob(level.at(i), _serial, UpdateProfiler::ObjectUpdate, &results[i]));
+  }
+  _threadPool->waitForDone();
+}
+
 }
 
 // vim: ts=2 sw=2 et
@@ -16,10 +16,17 @@
 #include "object.h"
 
 #include <QGraphicsRectItem>
+#include <QMutex>
 #include <QTime>
+#include <QVector>
+
+class QThreadPool;
+class TestObjectStore;
 
 namespace Kst {
 class ObjectStore;
+class DataSource;
+typedef SharedPtr<DataSource> DataSourcePtr;
 
 class KSTCORE_EXPORT UpdateManager : public QObject
 {
@@ -35,21 +42,67 @@ class KSTCORE_EXPORT UpdateManager : public QObject
 
     void setStore(ObjectStore *store) {_store = store;}
 
+    /** Number of threads used to update independent objects.
+      * With 1, everything is updated on the calling thread. */
+    void setUpdateThreads(int threads);
+    int updateThreads() const { return _updateThreads; }
+
+    /** With background updates, the periodic update cycles run on a thread
+      * of their own, and objectsUpdated() is emitted from the GUI thread
+      * when each one is done.  Forced updates still run on the caller's
+      * thread, after waiting for any cycle in progress. */
+    void setBackgroundUpdates(bool background);
+    bool backgroundUpdates() const { return _backgroundUpdates; }
+
+    /** With a target latency (ms), the period between updates follows how
+      * long updating and drawing actually take, and renderers are asked to
+      * decimate dense data when that is more than half the budget.
+      * Updates which come in while one is still being drawn are merged
+      * into a single one.  0 uses the fixed minimum update period. */
+    void setTargetLatency(int latency);
+    int targetLatency() const { return _targetLatency; }
+
+    /** the period between updates in use at the moment */
+    int updatePeriod() const { return _targetLatency > 0 ? _adaptivePeriod : _minUpdatePeriod; }
+
+    enum { MaxDecimation = 4 };
+    /** 0 to MaxDecimation: how hard renderers may thin out dense data */
+    int decimation() const { return _decimation; }
 
   public Q_SLOTS:
     void doUpdates(bool forceImmediate = false);
     void delayedUpdates();
-    void viewItemUpdateFinished() { _updateInProgress = false; }
+    /** The views have drawn the results of the last update, or had
+      * nothing to draw: the latency is measured up to here. */
+    void viewItemUpdateFinished();
+    /** The views were to draw the last update but haven't, being hidden
+      * perhaps: finish it without taking its time into account. */
+    void viewItemUpdateAbandoned();
 
   Q_SIGNALS:
     void objectsUpdated(qint64 serial);
+    /** for the views to draw again, as decimation() is part of how */
+    void decimationChanged(int decimation);
+
+  private Q_SLOTS:
+    void backgroundCycleFinished(qint64 serial);
 
   private:
+    friend class ::TestObjectStore;
     UpdateManager();
     ~UpdateManager();
     static void cleanup();
     QTime _time;
 
+    friend class UpdateCycleJob;
+    qint64 runCycle();
+    void updateDataSources(const QList<DataSourcePtr> &sources, QVector<Object::UpdateType> &results);
+    void updateLevel(const QList<ObjectPtr> &level, QVector<Object::UpdateType> &results);
+    enum { MaxBatchedFrames = 16*1024*1024 };
+    QList<DataSourcePtr> batchVectorReads(const QList<ObjectPtr> &level);
+    void adaptUpdatePeriod(int latency);
+    void finishViewItemUpdate(bool drawn);
+
   private:
     bool _delayedUpdate;
     int _minUpdatePeriod;
@@ -58,6 +111,16 @@ class KSTCORE_EXPORT UpdateManager : public QObject
     bool _updateInProgress;
     qint64 _serial;
     ObjectStore *_store;
+    int _updateThreads;
+    QThreadPool *_threadPool;
+    bool _backgroundUpdates;
+    QThreadPool *_cycleThread;
+    QMutex _cycleMutex;
+    int _targetLatency;
+    int _adaptivePeriod;
+    int _updateCost;
+    int _decimation;
+    bool _updatePending;
 };
 
 }
@@ -0,0 +1,200 @@
+/***************************************************************************
+             updateprofiler.cpp: where the time in an update goes
+                             -------------------
+    begin                : October, 2012
+    copyright            : (C) 2012 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "updateprofiler.h"
+
+#include <QCoreApplication>
+#include <QStringList>
+
+#define DEFAULT_HISTORY_LENGTH 32
+
+namespace Kst {
+
+static UpdateProfiler *_profiler = 0;
+void UpdateProfiler::cleanup() {
+  delete _profiler;
+  _profiler = 0;
+}
+
+
+UpdateProfiler *UpdateProfiler::self() {
+  if (!_profiler) {
+    _profiler = new UpdateProfiler;
+    qAddPostRoutine(cleanup);
+  }
+  return _profiler;
+}
+
+
+UpdateProfiler::UpdateProfiler() : _next(0), _count(0), _inCycle(false) {
+  _ring.resize(DEFAULT_HISTORY_LENGTH);
+}
+
+
+void UpdateProfiler::startCycle(qint64 serial) {
+  QMutexLocker ml(&_mutex);
+  _current = Cycle();
+  _current.serial = serial;
+  _inCycle = true;
+  _cycleTimer.start();
+}
+
+
+void UpdateProfiler::finishCycle(int deferredLoops) {
+  QMutexLocker ml(&_mutex);
+  if (!_inCycle) {
+    return;
+  }
+  _current.nsecs = _cycleTimer.nsecsElapsed();
+  _current.deferredLoops = deferredLoops;
+
+  _ring[_next] = _current;
+  _next = (_next + 1) % _ring.size();
+  _count = qMin(_count + 1, _ring.size());
+  _current = Cycle();
+  _inCycle = false;
+}
+
+
+UpdateProfiler::Cycle *UpdateProfiler::newestCycle() {
+  if (_count == 0) {
+    return 0;
+  }
+  return &_ring[(_next + _ring.size() - 1) % _ring.size()];
+}
+
+
+void UpdateProfiler::record(Kind kind, const QString &name, const QString &type, qint64 nsecs) {
+  QMutexLocker ml(&_mutex);
+
+  Cycle *cycle = 0;
+  bool late = false;
+  if (kind == Paint || !_inCycle) {
+    cycle = newestCycle();
+    late = true;
+  } else {
+    cycle = &_current;
+  }
+  if (!cycle) {
+    return;
+  }
+
+  if (nsecs < MinimumSample) {
+    ++cycle->quickSamples;
+    cycle->quickNsecs += nsecs;
+    return;
+  }
+
+  Sample sample;
+  sample.kind = kind;
+  sample.name = name;
+  sample.type = type;
+  sample.nsecs = nsecs;
+  if (late) {
+    if (cycle->lateSamples == MaxLateSamples) {
+      cycle->samples.removeAt(cycle->samples.count() - cycle->lateSamples);
+    } else {
+      ++cycle->lateSamples;
+    }
+  }
+  cycle->samples.append(sample);
+}
+
+
+QList<UpdateProfiler::Cycle> UpdateProfiler::history() const {
+  QMutexLocker ml(&_mutex);
+  QList<Cycle> cycles;
+  for (int i = _count; i > 0; --i) {
+    cycles.append(_ring.at((_next + _ring.size() - i) % _ring.size()));
+  }
+  return cycles;
+}
+
+
+UpdateProfiler::Cycle UpdateProfiler::lastCycle() const {
+  QMutexLocker ml(&_mutex);
+  if (_count == 0) {
+    return Cycle();
+  }
+  return _ring.at((_next + _ring.size() - 1) % _ring.size());
+}
+
+
+int UpdateProfiler::historyLength() const {
+  QMutexLocker ml(&_mutex);
+  return _ring.size();
+}
+
+
+void UpdateProfiler::setHistoryLength(int cycles) {
+  cycles = qMax(1, cycles);
+
+  QList<Cycle> keep = history();
+  QMutexLocker ml(&_mutex);
+  while (keep.count() > cycles) {
+    keep.removeFirst();
+  }
+  _ring.clear();
+  _ring.resize(cycles);
+  _count = keep.count();
+  for (int i = 0; i < _count; ++i) {
+    _ring[i] = keep.at(i);
+  }
+  _next = _count % cycles;
+}
+
+
+void UpdateProfiler::clear() {
+  QMutexLocker ml(&_mutex);
+  const int length = _ring.size();
+  _ring.clear();
+  _ring.resize(length);
+  _next = _count = 0;
+}
+
+
+QString UpdateProfiler::kindName(Kind kind) {
+  switch (kind) {
+    case ObjectUpdate:
+      return "update";
+    case DataSourceUpdate:
+      return "datasource";
+    case Paint:
+      return "paint";
+  }
+  return QString();
+}
+
+
+QString UpdateProfiler::report(int cycles) const {
+  QList<Cycle> all = history();
+  QStringList lines;
+  for (int i = qMax(0, all.count() - cycles); i < all.count(); ++i) {
+    const Cycle &cycle = all.at(i);
+    lines << QString("%1 cycle - %2 %3").arg(cycle.serial).arg(cycle.deferredLoops).arg(cycle.nsecs / 1000);
+    foreach (const Sample &sample, cycle.samples) {
+      lines << QString("%1 %2 %3 %4 %5").arg(cycle.serial).arg(kindName(sample.kind))
+                 .arg(sample.name).arg(sample.type).arg(sample.nsecs / 1000);
+    }
+    lines << QString("%1 quick %2 - %3").arg(cycle.serial).arg(cycle.quickSamples).arg(cycle.quickNsecs / 1000);
+  }
+  return lines.join("\n");
+}
+
+}
+
+// vim: ts=2 sw=2 et
@@ -0,0 +1,114 @@
+/***************************************************************************
+              updateprofiler.h: where the time in an update goes
+                             -------------------
+    begin                : October, 2012
+    copyright            : (C) 2012 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef UPDATEPROFILER_H
+#define UPDATEPROFILER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include "kst_export.h"
+
+namespace Kst {
+
+// The UpdateProfiler keeps the timings of the last few update cycles:
+// how long each object which changed took to update, how long each data
+// source took to check its file, how long each plot took to paint the
+// results, and how many times the cycle had to go round again for
+// deferred objects.  The UpdateManager and PlotItem report to it; the
+// debug dialog and the script server read from it.
+//
+// Anything quicker than MinimumSample is only added to the totals for its
+// cycle, which keeps the thousands of statistics scalars out of the way.
+
+class KSTCORE_EXPORT UpdateProfiler
+{
+  public:
+    static UpdateProfiler *self();
+
+    enum Kind { ObjectUpdate = 0, DataSourceUpdate = 1, Paint = 2 };
+
+    enum { MinimumSample = 10000 }; // ns
+    enum { MaxLateSamples = 256 };
+
+    struct Sample {
+      Kind kind;
+      QString name; // short name
+      QString type;
+      qint64 nsecs;
+    };
+
+    struct Cycle {
+      Cycle() : serial(0), nsecs(0), deferredLoops(0), quickSamples(0), quickNsecs(0), lateSamples(0) {}
+      qint64 serial;
+      qint64 nsecs;
+      int deferredLoops;
+      int quickSamples;
+      qint64 quickNsecs;
+      QList<Sample> samples;
+      int lateSamples; // the last of samples, recorded after the cycle finished
+    };
+
+    void startCycle(qint64 serial);
+    void finishCycle(int deferredLoops);
+
+    /** Thread safe.  Paint samples go to the last finished cycle, since
+      * that is what is being drawn; the others to the cycle in progress.
+      * A finished cycle keeps only the last MaxLateSamples of those
+      * recorded after it, so that it doesn't grow while updates are
+      * paused and the plots are still being painted. */
+    void record(Kind kind, const QString &name, const QString &type, qint64 nsecs);
+
+    /** the finished cycles, oldest first */
+    QList<Cycle> history() const;
+    Cycle lastCycle() const;
+
+    int historyLength() const;
+    void setHistoryLength(int cycles);
+    void clear();
+
+    /** The last cycles as text, one line per sample:
+      *   serial kind name type microseconds
+      * with a 'cycle' line (deferred loops in the type column) ahead of
+      * the samples of each cycle. */
+    QString report(int cycles = 1) const;
+
+    static QString kindName(Kind kind);
+
+  private:
+    UpdateProfiler();
+    static void cleanup();
+
+    Cycle *newestCycle();
+
+    mutable QMutex _mutex;
+    QVector<Cycle> _ring;
+    int _next;
+    int _count;
+    Cycle _current;
+    bool _inCycle;
+    QElapsedTimer _cycleTimer;
+};
+
+}
+
+#endif
+
+// vim: ts=2 sw=2 et
@@ -21,6 +21,7 @@
 #include <assert.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <QDebug>
 #include <QApplication>
@@ -28,6 +29,7 @@
 
 #include "kst_i18n.h"
 
+#include "bufferstore.h"
 #include "datacollection.h"
 #include "math_kst.h"
 #include "debug.h"
@@ -50,6 +52,21 @@ Vector::Vector(ObjectStore *store)
   _editable = false;
   NumShifted = 0;
   NumNew = 0;
+  _unchangedSamples = 0;
+  _shiftedSamples = 0;
+  _spareShift = 0;
+  _spareKept = 0;
+  _prefixSize = 0;
+  _rewrites = 0;
+  _updatedSize = 0;
+  _scrolling = false;
+  _vOffset = 0;
+  _f = 0;
+  _floatStorage = false;
+  _expanded = false;
+  _expandWanted = false;
+  _borrowed = false;
+  _snapshotWanted = false;
   _saveData = false;
   _isScalarList = false;
 
@@ -61,13 +78,14 @@ Vector::Vector(ObjectStore *store)
 
   int size = INITSIZE;
 
-  _v = static_cast<double*>(malloc(size * sizeof(double)));
+  _v = static_cast<double*>(BufferStore::self()->allocate(size * sizeof(double)));
   if (!_v) { // Malloc failed
-    _v = static_cast<double*>(malloc(sizeof(double)));
+    _v = static_cast<double*>(BufferStore::self()->allocate(sizeof(double)));
     _size = 1;
   } else {
     _size = size;
   }
+  _vCapacity = _size;
   _is_rising = false;
 
   _scalars.clear();
@@ -88,9 +106,48 @@ void Vector::_initializeShortName() {
 }
 
 Vector::~Vector() {
-  if (_v) {
-    free(_v);
+  releaseBuffers();
+}
+
+
+VectorBuffer::~VectorBuffer() {
+  BufferStore::self()->release(_storage);
+}
+
+
+// everything which is ours
+void Vector::releaseBuffers() {
+  const bool single = (_f != 0);
+  releasePrimary();
+  if (single) {
+    BufferStore::self()->release(_v); // the double copy is always our own
+  }
+  _v = 0;
+  _f = 0;
+  _vOffset = 0;
+  _vCapacity = 0;
+}
+
+
+// What the samples are in is freed here if it is ours alone; if it is lent
+// or borrowed, the last of those holding it frees it.
+void Vector::releasePrimary() {
+  void *primary = _f ? static_cast<void*>(_f) : static_cast<void*>(_v ? _v - _vOffset : 0);
+  {
+    QMutexLocker ml(&_bufferMutex);
+    if (_buffer && !_borrowed && _buffer->_KShared_count() == 1) {
+      _buffer->_storage = 0;
+    } else if (_buffer || _borrowed) {
+      primary = 0;
+    }
+    _buffer = 0;
+  }
+  BufferStore::self()->release(primary);
+  if (_f) {
+    _f = 0;
+  } else {
     _v = 0;
+    _vOffset = 0;
   }
 }
 
@@ -145,6 +202,9 @@ const QString& Vector::typeString() const {
 /** Return v[i], i is sample number, interpolated to have ns_i total
     samples in vector */
 double Vector::interpolate(int in_i, int ns_i) const {
+  if (_f) {
+    return kstInterpolate(_f, _size, in_i, ns_i);
+  }
   GENERATE_INTERPOLATION
 }
 
@@ -153,8 +213,83 @@ double kstInterpolate(double *_v, int _size, int in_i, int ns_i) {
   GENERATE_INTERPOLATION
 }
 
+
+double kstInterpolate(const float *_v, int _size, int in_i, int ns_i) {
+  GENERATE_INTERPOLATION
+}
+
 #undef GENERATE_INTERPOLATION
 
+
+// The same arithmetic as GENERATE_INTERPOLATION, sample for sample, but with
+// the limits worked out once: what is left are plain loops over the
+// samples in between, which the compiler can vectorize.
+template<class T>
+static void interpolateSamples(const T *v, int size, int from, int count, int ns_i, double *out) {
+  assert(size > 0);
+  const int end = from + count;
+  int i = from;
+
+  // before the first sample, or only one sample anyway
+  int stop = (size == 1) ? end : qMin(end, 0);
+  for (; i < stop; ++i) {
+    out[i - from] = v[0];
+  }
+
+  stop = qMax(i, qMin(end, ns_i - 1));
+  if (ns_i == size) {
+    for (; i < stop; ++i) {
+      out[i - from] = v[i];
+    }
+  } else {
+    const double top = double(size - 1);
+    const double bottom = double(ns_i - 1);
+    for (; i < stop; ++i) {
+      const double fj = i * top / bottom;
+      const int j = int(fj);
+      if (v[j + 1] != v[j + 1] || v[j] != v[j]) {
+        out[i - from] = NOPOINT;
+      } else {
+        const double fdj = fj - float(j);
+        out[i - from] = v[j + 1] * fdj + v[j] * (1.0 - fdj);
+      }
+    }
+  }
+
+  // the last sample and on
+  for (; i < end; ++i) {
+    out[i - from] = v[size - 1];
+  }
+}
+
+
+void kstInterpolate(const double *v, int _size, int from, int count, int ns_i, double *out) {
+  interpolateSamples(v, _size, from, count, ns_i, out);
+}
+
+
+void kstInterpolate(const float *v, int _size, int from, int count, int ns_i, double *out) {
+  interpolateSamples(v, _size, from, count, ns_i, out);
+}
+
+
+void Vector::interpolate(int from, int count, int ns_i, double *out) const {
+  if (_f) {
+    interpolateSamples(_f, _size, from, count, ns_i, out);
+  } else {
+    interpolateSamples(_v, _size, from, count, ns_i, out);
+  }
+}
+
+
+const double *Vector::interpolated(int from, int count, int ns_i, double *out) const {
+  if (!_f && ns_i == _size && from >= 0 && from + count <= _size) {
+    return _v + from;
+  }
+  interpolate(from, count, ns_i, out);
+  return out;
+}
+
 #define RETURN_FIRST_NON_HOLE               \
     for (int i = 0; i < _size; ++i) {       \
       if (_v[i] == _v[i]) {                 \
@@ -232,6 +367,9 @@ double kstInterpolate(double *_v, int _size, int in_i, int ns_i) {
 // FIXME: optimize me - possible that floor() (especially) and isnan() are
 //        expensive here.
 double Vector::interpolateNoHoles(int in_i, int ns_i) const {
+  if (_f) {
+    return kstInterpolateNoHoles(_f, _size, in_i, ns_i);
+  }
   GENERATE_INTERPOLATION
 }
 
@@ -240,6 +378,11 @@ double kstInterpolateNoHoles(double *_v, int _size, int in_i, int ns_i) {
   GENERATE_INTERPOLATION
 }
 
+
+double kstInterpolateNoHoles(const float *_v, int _size, int in_i, int ns_i) {
+  GENERATE_INTERPOLATION
+}
+
 #undef FIND_LEFT
 #undef FIND_RIGHT
 #undef RETURN_LAST_NON_HOLE
@@ -250,7 +393,7 @@ double Vector::value(int i) const {
   if (i < 0 || i >= _size) { // can't look before beginning or past end
     return 0.0;
   }
-  return _v[i];
+  return _f ? _f[i] : _v[i];
 }
 
 void Vector::CreateScalars(ObjectStore *store) {
@@ -326,8 +469,11 @@ void Vector::updateScalars() {
 }
 
 double* Vector::realloced(double *memptr, int newSize) {
-  double *old = _v;
+  detachBuffer();
+  double *old = _v - _vOffset;
   _v = memptr;
+  _vOffset = 0;
+  _vCapacity = newSize;
   if (newSize < _size) {
     NumNew = newSize; // all new if we shrunk the vector
   } else {
@@ -340,34 +486,231 @@ double* Vector::realloced(double *memptr, int newSize) {
 
 
 void Vector::setV(double *memptr, int newSize) {
+  _borrowed = false;
   _v = memptr;
+  _vOffset = 0;
+  _vCapacity = newSize;
   NumNew = newSize;
   _size = newSize;
 }
 
 
+void Vector::shift(int n) {
+  n = qBound(0, n, _size - 1);
+  if (n == 0 || !detachBuffer()) {
+    return;
+  }
+  if (_f) {
+    memmove(_f, _f + n, (_size - n)*sizeof(float));
+    _expanded = false;
+  } else if (_scrolling) {
+    _v += n;
+    _vOffset += n;
+  } else {
+    memmove(_v, _v + n, (_size - n)*sizeof(double));
+  }
+  _size -= n;
+  updateScalars();
+}
+
+
+void Vector::setScrolling(bool scrolling) {
+  // single precision vectors are moved about as they are: half the work
+  scrolling = scrolling && !_f;
+  if (scrolling == _scrolling || !detachBuffer()) {
+    return;
+  }
+  _scrolling = scrolling;
+  if (!scrolling) {
+    // back to exactly as much as is needed, starting at the start
+    double *storage = _v - _vOffset;
+    if (_vOffset > 0) {
+      memmove(storage, _v, _size*sizeof(double));
+    }
+    _v = storage;
+    _vOffset = 0;
+    if (_vCapacity != _size && BufferStore::self()->resize(_v, _size*sizeof(double))) {
+      _vCapacity = _size;
+    }
+  }
+}
+
+
 void Vector::zero() {
+  if (!detachBuffer()) {
+    return;
+  }
   _ns_min = _ns_max = 0.0;
-  memset(_v, 0, sizeof(double)*_size);
+  if (_f) {
+    memset(_f, 0, sizeof(float)*_size);
+    _expanded = false;
+  } else {
+    memset(_v, 0, sizeof(double)*_size);
+  }
   updateScalars();
 }
 
 
 void Vector::blank() {
+  if (!detachBuffer()) {
+    return;
+  }
   _ns_min = _ns_max = 0.0;
-  for (int i = 0; i < _size; ++i) {
-    _v[i] = NOPOINT;
+  if (_f) {
+    for (int i = 0; i < _size; ++i) {
+      _f[i] = NOPOINT;
+    }
+    _expanded = false;
+  } else {
+    for (int i = 0; i < _size; ++i) {
+      _v[i] = NOPOINT;
+    }
   }
   updateScalars();
 }
 
 
+void Vector::setStorageType(StorageType type) {
+  if (type == storageType() || !detachBuffer()) {
+    return;
+  }
+
+  QMutexLocker ml(&_expandMutex);
+  if (type == Float32Storage ? !narrow() : !widen()) {
+    qCritical() << "Vector storage change failed";
+    return;
+  }
+  _floatStorage = (type == Float32Storage);
+  _unchangedSamples = 0;
+}
+
+
+bool Vector::narrow() {
+  if (_f) {
+    return true;
+  }
+  setScrolling(false);
+  // _v becomes the double copy, which is only ever our own
+  if (!detachBuffer()) {
+    return false;
+  }
+  float *f = static_cast<float*>(BufferStore::self()->allocate(_size*sizeof(float)));
+  if (!f) {
+    return false;
+  }
+  for (int i = 0; i < _size; ++i) {
+    f[i] = _v[i];
+  }
+  _f = f;
+  // keep the double copy until the next update, in case something is
+  // still holding on to value()
+  _expanded = true;
+  _expandWanted = false;
+  return true;
+}
+
+
+bool Vector::widen() {
+  if (!_f) {
+    return true;
+  }
+  if (_vCapacity < _size) {
+    if (!BufferStore::self()->resize(_v, _size*sizeof(double))) {
+      return false;
+    }
+    _vCapacity = _size;
+  }
+  for (int i = 0; i < _size; ++i) {
+    _v[i] = _f[i];
+  }
+  releasePrimary();
+  _expanded = false;
+  return true;
+}
+
+
+QString Vector::storageTypeName(StorageType type) {
+  switch (type) {
+    case Float32Storage:
+      return "float32";
+    default:
+      return "double";
+  }
+}
+
+
+Vector::StorageType Vector::storageTypeFromName(const QString &name) {
+  if (name == "float32") {
+    return Float32Storage;
+  }
+  return DoubleStorage;
+}
+
+
+double *Vector::expand() {
+  QMutexLocker ml(&_expandMutex);
+  _expandWanted = true;
+  if (!_f || _expanded) {
+    return _v;
+  }
+  if (_vCapacity < _size) {
+    if (!BufferStore::self()->resize(_v, _size*sizeof(double))) {
+      qCritical() << "Vector resize failed";
+      return _v;
+    }
+    _vCapacity = _size;
+  }
+  for (int i = 0; i < _size; ++i) {
+    _v[i] = _f[i];
+  }
+  _expanded = true;
+  return _v;
+}
+
+
 bool Vector::resize(int sz, bool init) {
-  if (sz > 0) {
-    if (!kstrealloc(_v, sz*sizeof(double))){
+  if (sz > 0 && !detachBuffer()) {
+    return false;
+  }
+  if (sz > 0 && _f) {
+    if (!BufferStore::self()->resize(_f, sz*sizeof(float))) {
        qCritical() << "Vector resize failed";
        return false;
     }
+    if (init && _size < sz) {
+      for (int i = _size; i < sz; i++) {
+        _f[i] = NOPOINT;
+      }
+    }
+    _size = sz;
+    _expanded = false;
+    updateScalars();
+  } else if (sz > 0) {
+    if (!_scrolling) {
+      if (!BufferStore::self()->resize(_v, sz*sizeof(double))){
+         qCritical() << "Vector resize failed";
+         return false;
+      }
+      _vCapacity = sz;
+    } else if (_vOffset + sz > _vCapacity) {
+      // out of room: move the data back to the start, and grow with half
+      // as much again to spare.
+      double *storage = _v - _vOffset;
+      if (_vOffset > 0) {
+        memmove(storage, _v, qMin(_size, sz)*sizeof(double));
+        _v = storage;
+        _vOffset = 0;
+      }
+      if (sz > _vCapacity) {
+        const int capacity = sz + sz/2;
+        if (!BufferStore::self()->resize(storage, capacity*sizeof(double))){
+           qCritical() << "Vector resize failed";
+           return false;
+        }
+        _v = storage;
+        _vCapacity = capacity;
+      }
+    }
     if (init && _size < sz) {
       for (int i = _size; i < sz; i++) {
         _v[i] = NOPOINT;
@@ -380,117 +723,245 @@ bool Vector::resize(int sz, bool init) {
 }
 
 
-void Vector::internalUpdate() {
-  int i, i0;
-  double sum, sum2, last, first, v;
-  double last_v;
-  double dv2 = 0.0, dv, no_spike_max_dv;
-  const double epsilon=1e-300;
-
-  _max = _min = sum = sum2 = _minPos = last = first = NOPOINT;
-  _nsum = 0;
+VectorBufferPtr Vector::lendBuffer() const {
+  QMutexLocker ml(&_bufferMutex);
+  if (!_buffer) {
+    _buffer = new VectorBuffer(_f ? static_cast<void*>(_f) : static_cast<void*>(_v - _vOffset));
+  }
+  return _buffer;
+}
 
-  if (_size > 0) {
-    _is_rising = true;
 
-    // Look for a valid (finite) point...
-    for (i = 0; i < _size && !isfinite(_v[i]); i++) {
-      // do nothing
+void Vector::borrowBuffer(const Vector *lender) {
+  VectorBufferPtr buffer = lender->lendBuffer();
+  QMutexLocker ml(&_expandMutex);
+  const bool single = (_f != 0);
+  releasePrimary();
+  if (lender->_f) {
+    // the double copy stays ours, and is made on demand as usual
+    if (!single) {
+      _vCapacity = 0;
     }
+    _f = lender->_f;
+  } else {
+    if (single) {
+      BufferStore::self()->release(_v);
+    }
+    _f = 0;
+    _v = lender->_v;
+    _vCapacity = 0;
+  }
+  {
+    QMutexLocker bl(&_bufferMutex);
+    _buffer = buffer;
+  }
+  _vOffset = 0;
+  _size = lender->_size;
+  _scrolling = false;
+  _expanded = false;
+  _borrowed = true;
+}
 
-    if (i == _size) { // there were no finite points:
-      if (!_isScalarList) {
-        _scalars["sum"]->setValue(sum);
-        _scalars["sumsquared"]->setValue(sum2);
-        _scalars["max"]->setValue(_max);
-        _scalars["min"]->setValue(_min);
-        _scalars["minpos"]->setValue(_minPos);
-        _scalars["last"]->setValue(last);
-        _scalars["first"]->setValue(first);
-      }
-      _ns_max = _ns_min = 0;
 
-      updateScalars();
+bool Vector::detachBuffer() {
+  QMutexLocker ml(&_bufferMutex);
+  if (!_buffer) {
+    return true;
+  }
+  if (!_borrowed && _buffer->_KShared_count() == 1) {
+    // nobody borrows it any more: all ours again
+    _buffer->_storage = 0;
+    _buffer = 0;
+    return true;
+  }
 
-      return;
+  // copy it, and leave the others what they have
+  if (_f) {
+    float *f = static_cast<float*>(BufferStore::self()->allocate(_size*sizeof(float)));
+    if (!f) {
+      qCritical() << "Vector copy failed";
+      return false;
+    }
+    memcpy(f, _f, _size*sizeof(float));
+    _f = f;
+  } else {
+    double *v = static_cast<double*>(BufferStore::self()->allocate(_size*sizeof(double)));
+    if (!v) {
+      qCritical() << "Vector copy failed";
+      return false;
     }
+    memcpy(v, _v, _size*sizeof(double));
+    _v = v;
+    _vOffset = 0;
+    _vCapacity = _size;
+  }
+  _buffer = 0;
+  _borrowed = false;
+  return true;
+}
+
 
-    i0 = i;
+Vector::Statistics::Statistics()
+  : nsStarted(false), nsMin(0.0), nsMax(0.0), nsLast(0.0), nsSkip(0) {
+}
+
+
+template<class T> void Vector::Statistics::add(const T *v, int from, int to) {
+  if (to <= from) {
+    return;
+  }
+
+  RunningStatistics::add(v + from, to - from);
+
+  if (n == 0) {
+    return;
+  }
 
-    if (i0 > 0) {
-      _is_rising = false;
+  // Spike insensitive extremes.  The threshold is taken from all of the
+  // samples seen so far, so samples which were added a while ago were
+  // judged against an older estimate than a full pass would use.
+  const double no_spike_max_dv = 7.0*sqrt(dv2/double(n));
+
+  for (int i = from; i < to; i++) {
+    const double x = v[i];
+
+    if (nsSkip > 0) {
+      // skip 20 samples after a spike, and carry on from the 20th
+      if (--nsSkip == 1) {
+        nsLast = x;
+      }
+      continue;
+    }
+
+    if (!isfinite(x)) {
+      continue;
     }
 
-    _max = _min = _v[i0];
-    sum = sum2 = 0.0;
+    if (!nsStarted) {
+      nsMin = nsMax = nsLast = x;
+      nsStarted = true;
+    }
 
-    if (_v[i0] > epsilon) {
-      _minPos = _v[i0];
+    if (fabs(x - nsLast) < no_spike_max_dv) {
+      if (x > nsMax) {
+        nsMax = x;
+      } else if (x < nsMin) {
+        nsMin = x;
+      }
+      nsLast = x;
     } else {
-      _minPos = 1.0E300;
+      nsSkip = 21;
     }
+  }
+}
 
-    last_v = _v[i0];
 
-    for (i = i0; i < _size; i++) {
-      v = _v[i]; // get rid of redirections
+void Vector::internalUpdate() {
+  double sum, sum2, last, first;
 
-      if (isfinite(v)) {
-        dv = v - last_v;
-        dv2 += dv*dv;
+  _max = _min = sum = sum2 = _minPos = last = first = NOPOINT;
+  _nsum = 0;
 
-        if (v <= last_v) {
-          if (i != i0) {
-            _is_rising = false;
-          }
+  {
+    // A float32 vector whose samples were wanted as doubles since the last
+    // update is held as doubles: floats and a double copy besides would
+    // be half as much again as doubles alone.  Back to floats when
+    // nobody wants them.  Followers go with their leader.
+    QMutexLocker ml(&_expandMutex);
+    if (_floatStorage && !_borrowed && _expandWanted == (_f != 0)) {
+      if (_f ? widen() : narrow()) {
+        _unchangedSamples = 0;
+      }
+    } else if (_f) {
+      // the double copy is out of date, and is let go if nobody wanted it
+      // since the last update
+      _expanded = false;
+      if (!_expandWanted && _vCapacity > 1) {
+        if (BufferStore::self()->resize(_v, sizeof(double))) {
+          _vCapacity = 1;
         }
+      }
+    }
+    _expandWanted = false;
+  }
 
-        last_v = v;
+  // Anything already counted which has changed or moved since means
+  // starting again; otherwise only the samples which are new need to be
+  // looked at.
+  const int shifted = qMax(0, _shiftedSamples);
+  const int kept = qBound(0, _unchangedSamples, _size);
+  const int unchanged = (shifted > 0) ? 0 : kept;
+  _unchangedSamples = 0;
+  _shiftedSamples = 0;
+  if (shifted > 0 || kept < _updatedSize) {
+    ++_rewrites;
+  }
+  _updatedSize = _size;
+  if (unchanged < _prefixSize) {
+    _prefixStats = Statistics();
+    _prefixSize = 0;
+  }
 
-        _nsum++;
-        sum += v;
-        sum2 += v*v;
+  QMutexLocker mml(&_minMaxMutex);
+  if (_minMax) {
+    // a snapshot holding on to the index needs it as it was
+    if (_minMax->_KShared_count() > 1) {
+      _minMax = new MinMaxIndex(*_minMax);
+    }
+    if (_f) {
+      _minMax->update(_f, _size, unchanged);
+    } else {
+      _minMax->update(_v, _size, unchanged);
+    }
+  }
+  mml.unlock();
 
-        if (v > _max) {
-          _max = v;
-        } else if (v < _min) {
-          _min = v;
-        }
-        if (v < _minPos && v > epsilon) {
-          _minPos = v;
-        }
-      } else {
-        _is_rising = false;
-      }
+  if (_size > 0) {
+    Statistics stats;
+    if (_f) {
+      _prefixStats.add(_f, _prefixSize, unchanged);
+      _prefixSize = unchanged;
+      stats = _prefixStats;
+      stats.add(_f, unchanged, _size);
+    } else {
+      _prefixStats.add(_v, _prefixSize, unchanged);
+      _prefixSize = unchanged;
+      stats = _prefixStats;
+      stats.add(_v, unchanged, _size);
     }
 
-    no_spike_max_dv = 7.0*sqrt(dv2/double(_nsum));
-
-    _ns_max = _ns_min = last_v = _v[i0];
-
-    last = _v[_size-1];
-    first = _v[0];
-
-    for (i = i0; i < _size; i++) {
-      v = _v[i]; // get rid of redirections
-      if (isfinite(v)) {
-        if (fabs(v - last_v) < no_spike_max_dv) {
-          if (v > _ns_max) {
-            _ns_max = v;
-          } else if (v < _ns_min) {
-            _ns_min = v;
-          }
-          last_v = v;
-        } else {
-          i += 20;
-          if (i < _size) {
-            last_v = _v[i];
-          }
-          i++;
-        }
+    if (stats.n == 0) { // there were no finite points:
+      _is_rising = true;
+      if (!_isScalarList) {
+        _scalars["sum"]->setValue(sum);
+        _scalars["sumsquared"]->setValue(sum2);
+        _scalars["max"]->setValue(_max);
+        _scalars["min"]->setValue(_min);
+        _scalars["minpos"]->setValue(_minPos);
+        _scalars["last"]->setValue(last);
+        _scalars["first"]->setValue(first);
       }
+      _ns_max = _ns_min = 0;
+
+      updateScalars();
+      publishSnapshot(shifted, kept);
+
+      return;
     }
 
+    _nsum = stats.n;
+    sum = stats.sum;
+    sum2 = stats.sum2;
+    _max = stats.max;
+    _min = stats.min;
+    _minPos = stats.minPos;
+    _is_rising = stats.rising;
+    _ns_max = stats.nsMax;
+    _ns_min = stats.nsMin;
+
+    last = value(_size-1);
+    first = value(0);
+
     if (_isScalarList) {
       _max = _min = _minPos = 0.0;
     } else {
@@ -506,6 +977,8 @@ void Vector::internalUpdate() {
     updateScalars();
 
   }
+
+  publishSnapshot(shifted, kept);
 }
 
 void Vector::save(QXmlStreamWriter &s) {
@@ -518,7 +991,7 @@ void Vector::save(QXmlStreamWriter &s) {
     QDataStream qds(&qba, QIODevice::WriteOnly);
 
     for (int i = 0; i < length(); i++) {
-      qds << _v[i];
+      qds << value(i);
     }
 
     s.writeTextElement("data_v2", qCompress(qba).toBase64());
@@ -533,10 +1006,173 @@ void Vector::setNewAndShift(int inNew, int inShift) {
 }
 
 double *Vector::value() const {
+  if (_f) {
+    return const_cast<Vector*>(this)->expand();
+  }
+  if (_floatStorage) {
+    // held as doubles for the likes of us: see internalUpdate()
+    const_cast<Vector*>(this)->_expandWanted = true;
+  }
   return _v;
 }
 
 
+VectorSnapshotPtr Vector::snapshot() const {
+  if (!UpdateManager::self()->backgroundUpdates()) {
+    VectorSnapshotPtr snapshot;
+    if (_f) {
+      snapshot = new VectorSnapshot(_f, _size, _is_rising, VectorSnapshot::Borrowed);
+    } else {
+      snapshot = new VectorSnapshot(_v, _size, _is_rising, VectorSnapshot::Borrowed);
+    }
+    QMutexLocker mml(&_minMaxMutex);
+    snapshot->setMinMaxIndex(_minMax);
+    return snapshot;
+  }
+
+  QMutexLocker ml(&_snapshotMutex);
+  _snapshotWanted = true;
+  if (_snapshot) {
+    return _snapshot;
+  }
+  ml.unlock();
+
+  // Nobody wanted one at the last update, or there hasn't been one since
+  // background updates were turned on.  The update thread may be busy with
+  // us, so this has to wait for it, but only the first time.  It may also
+  // have just published one.
+  VectorSnapshotPtr snapshot;
+  readLock();
+  ml.relock();
+  if (_snapshot) {
+    snapshot = _snapshot;
+    ml.unlock();
+    unlock();
+    return snapshot;
+  }
+  ml.unlock();
+  if (_f) {
+    snapshot = new VectorSnapshot(_f, _size, _is_rising, VectorSnapshot::Copied);
+  } else {
+    snapshot = new VectorSnapshot(_v, _size, _is_rising, VectorSnapshot::Copied);
+  }
+  {
+    QMutexLocker mml(&_minMaxMutex);
+    snapshot->setMinMaxIndex(_minMax);
+  }
+  ml.relock();
+  if (!_snapshot) {
+    _snapshot = snapshot;
+  }
+  snapshot = _snapshot;
+  ml.unlock();
+  unlock();
+  return snapshot;
+}
+
+
+// Several readers may get here at once, each with only a read lock: the
+// first makes the index, and the rest wait for it.  Nothing has changed
+// since the last update, so its snapshot, which went out without the
+// index, gets it too.
+MinMaxIndexPtr Vector::minMaxIndex() {
+  MinMaxIndexPtr minMax;
+  {
+    QMutexLocker ml(&_minMaxMutex);
+    if (_minMax) {
+      return _minMax;
+    }
+    minMax = new MinMaxIndex;
+    if (_f) {
+      minMax->update(_f, _size);
+    } else {
+      minMax->update(_v, _size);
+    }
+    _minMax = minMax;
+  }
+
+  QMutexLocker ml(&_snapshotMutex);
+  if (_snapshot && _snapshot->length() == _size && !_snapshot->minMaxIndex()) {
+    _snapshot->setMinMaxIndex(minMax);
+  }
+  return minMax;
+}
+
+
+// Called by the update thread once the new contents are in place.  Readers
+// keep whichever snapshot they already had; the swap is all that is locked.
+// Only vectors something is drawn or shown from get one: those which were
+// asked for a snapshot since the last update, or whose last one is still
+// held.  The others go without until asked: see snapshot().
+//
+// Snapshots are double buffered.  The last one, or else the one before it,
+// is brought up to date in place once the renderer has let go of it, so
+// only what changed since is copied.  The whole vector is only copied
+// while the renderer holds on to both.
+void Vector::publishSnapshot(int shift, int kept) {
+  // what the spare still has of the samples now
+  if (_spareSnapshot) {
+    _spareKept = qMax(0, qMin(kept, _spareKept - shift));
+    _spareShift += shift;
+  }
+
+  // Once out of _snapshot, nobody else can get hold of the last one.
+  VectorSnapshotPtr last;
+  bool wanted;
+  _snapshotMutex.lock();
+  wanted = _snapshotWanted || (_snapshot && _snapshot->_KShared_count() > 1);
+  _snapshotWanted = false;
+  last = _snapshot;
+  _snapshot = 0;
+  _snapshotMutex.unlock();
+
+  VectorSnapshotPtr snapshot;
+  if (wanted && UpdateManager::self()->backgroundUpdates()) {
+    if (last && last->_KShared_count() == 1) {
+      if (refreshSnapshot(last, shift, kept)) {
+        snapshot = last;
+      }
+      last = 0;
+    }
+    if (!snapshot && _spareSnapshot && _spareSnapshot->_KShared_count() == 1) {
+      if (refreshSnapshot(_spareSnapshot, _spareShift, _spareKept)) {
+        snapshot = _spareSnapshot;
+      }
+      _spareSnapshot = 0;
+    }
+    if (!snapshot) {
+      if (_f) {
+        snapshot = new VectorSnapshot(_f, _size, _is_rising, VectorSnapshot::Copied);
+      } else {
+        snapshot = new VectorSnapshot(_v, _size, _is_rising, VectorSnapshot::Copied);
+      }
+    }
+    if (last) {
+      _spareSnapshot = last;
+      _spareShift = shift;
+      _spareKept = kept;
+    }
+    QMutexLocker mml(&_minMaxMutex);
+    snapshot->setMinMaxIndex(_minMax);
+  } else {
+    _spareSnapshot = 0;
+  }
+
+  _snapshotMutex.lock();
+  _snapshot = snapshot;
+  _snapshotMutex.unlock();
+  // last is let go after unlocking, since that may have to free it
+}
+
+
+bool Vector::refreshSnapshot(VectorSnapshot *snapshot, int shift, int kept) const {
+  if (_f) {
+    return snapshot->refresh(_f, _size, _is_rising, shift, kept);
+  }
+  return snapshot->refresh(_v, _size, _is_rising, shift, kept);
+}
+
+
 void Vector::newSync() {
   NumNew = NumShifted = 0;
 }
@@ -769,7 +1405,7 @@ QByteArray Vector::getBinaryArray() const {
     QDataStream ds(&ret,QIODevice::WriteOnly);
     ds<<(qint64)_size;
     for(int i=0;i<_size;i++) {
-        ds<<(double)_v[i];
+        ds<<value(i);
     }
     unlock();
     return ret;
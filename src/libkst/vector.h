@@ -20,12 +20,16 @@
 
 #include <math.h>
 
+#include <QMutex>
 #include <QPointer>
 
 #include "primitive.h"
 #include "scalar.h"
 #include "string_kst.h"
 #include "labelinfo.h"
+#include "minmaxindex.h"
+#include "statistics_kst.h"
+#include "vectorsnapshot.h"
 #include "kst_export.h"
 
 class QXmlStreamWriter;
@@ -38,9 +42,28 @@ namespace Kst {
 
 class KstDataObject;
 
+// An allocation of samples which a vector lends to others holding the same
+// samples: see Vector::borrowBuffer().  It goes back to the BufferStore
+// when the last of the lender and the borrowers lets go of it, so a
+// borrower's samples stay where they are whatever the lender does.
+class KSTCORE_EXPORT VectorBuffer : public Shared
+{
+  public:
+    explicit VectorBuffer(void *storage) : _storage(storage) {}
+    ~VectorBuffer();
+
+    void *_storage; // 0 once the lender has it back to itself
+};
+typedef SharedPtr<VectorBuffer> VectorBufferPtr;
+
 // KST::interpolate is still too polluting
 KSTCORE_EXPORT double kstInterpolate(double *v, int _size, int in_i, int ns_i);
 KSTCORE_EXPORT double kstInterpolateNoHoles(double *v, int _size, int in_i, int ns_i);
+KSTCORE_EXPORT double kstInterpolate(const float *v, int _size, int in_i, int ns_i);
+KSTCORE_EXPORT double kstInterpolateNoHoles(const float *v, int _size, int in_i, int ns_i);
+/** kstInterpolate() for count samples from from on, into out */
+KSTCORE_EXPORT void kstInterpolate(const double *v, int _size, int from, int count, int ns_i, double *out);
+KSTCORE_EXPORT void kstInterpolate(const float *v, int _size, int from, int count, int ns_i, double *out);
 
 class Vector;
 typedef SharedPtr<Vector> VectorPtr;
@@ -71,11 +94,35 @@ class KSTCORE_EXPORT Vector : public Primitive
     void change(QByteArray& data);
     void oldChange(QByteArray& data);
 
+    /** How the samples are held.  Single precision halves the memory a
+      * vector needs, for data which doesn't have more than 24 bits to
+      * begin with (ADC counts, floats at the source).  That only holds
+      * while nothing wants all of the samples as doubles from value(): a
+      * float32 vector which is asked for them is held as doubles from its
+      * next update on, until an update goes by without anybody asking. */
+    enum StorageType { DoubleStorage = 0, Float32Storage = 1 };
+
+    StorageType storageType() const { return _floatStorage ? Float32Storage : DoubleStorage; }
+    /** Converts the current contents. */
+    void setStorageType(StorageType type);
+    static QString storageTypeName(StorageType type);
+    static StorageType storageTypeFromName(const QString &name);
+
     inline int length() const { return _size; }
 
     /** Return V[i], interpolated/decimated to have ns_i total samples */
     double interpolate(int i, int ns_i) const;
 
+    /** interpolate() for count samples from from on, into out.  The
+      * checks are made once for the lot, rather than for every sample. */
+    void interpolate(int from, int count, int ns_i, double *out) const;
+
+    /** The same, except that when nothing needs interpolating and the
+      * samples are held in double precision, this returns a pointer into
+      * the vector rather than copying them to out: it is then only good
+      * until the vector next changes. */
+    const double *interpolated(int from, int count, int ns_i, double *out) const;
+
     /** Return V[i], interpolated/decimated to have ns_i total samples, without any holes */
     double interpolateNoHoles(int i, int ns_i) const;
 
@@ -106,6 +153,10 @@ class KSTCORE_EXPORT Vector : public Primitive
     /** Number of samples  shifted since last newSync */
     inline int numShift() const { return NumShifted; }
 
+    /** Number of updates which changed or moved samples the vector already
+      * had.  While it stays the same, updates have only appended. */
+    inline int rewrites() const { return _rewrites; }
+
     inline bool isRising() const { return _is_rising; }
 
     /** reset New Samples and Shifted samples */
@@ -113,6 +164,18 @@ class KSTCORE_EXPORT Vector : public Primitive
 
     virtual bool resize(int sz, bool init = true);
 
+    /** Drop the first n samples, making the vector n shorter.  When
+      * scrolling, this only moves the start of the data. */
+    void shift(int n);
+
+    /** A scrolling vector keeps spare room after its data, so that shift()
+      * followed by resize() back to the old length doesn't have to move
+      * the samples which are kept.  The data is still contiguous, and
+      * value() is a plain array.  Only now and then, when the spare room
+      * runs out, are the samples moved back to the start. */
+    void setScrolling(bool scrolling);
+    bool scrolling() const { return _scrolling; }
+
     virtual void setNewAndShift(int inNew, int inShift);
 
     /** Clear out the vector by setting everything to 0.0 */
@@ -135,9 +198,26 @@ class KSTCORE_EXPORT Vector : public Primitive
     /** Save vector information */
     virtual void save(QXmlStreamWriter &s);
 
-    /** Return a pointer to the raw vector */
+    /** Return a pointer to the raw vector.  With single precision storage
+      * this is a double precision copy, made on demand and kept for as long
+      * as something keeps asking for it once per update. */
     double *value() const;
 
+    /** The contents of the vector as of its last update.  With background
+      * updates this is a copy which can be used while the vector is being
+      * updated on another thread; otherwise it borrows the vector's buffer
+      * and is only valid until the vector changes.  Updates only copy the
+      * vector for as long as something keeps asking for snapshots, so the
+      * first call in a while may wait for an update in progress.  Readers
+      * on the GUI thread go through this rather than value(). */
+    VectorSnapshotPtr snapshot() const;
+
+    /** The smallest and largest samples of blocks of the vector, for the
+      * extremes of any range of it.  Made on the first call and kept up
+      * to date by every update after that; snapshots carry it too.  Call
+      * with the vector at least read locked. */
+    MinMaxIndexPtr minMaxIndex();
+
     /** access functions for _isScalarList */
     bool isScalarList() const { return _isScalarList; }
 
@@ -190,12 +270,28 @@ class KSTCORE_EXPORT Vector : public Primitive
     /** Where the vector is held */
     double *_v;
 
+    /** With Float32Storage, where the vector is held instead, unless
+      * value() is wanted: _v is then only the copy handed out by value(). */
+    float *_f;
+
     /** number of samples shifted since last newSync */
     int NumShifted;
 
     /** number of new samples since last newSync */
     int NumNew;
 
+    /** Set by subclasses before internalUpdate(): this many samples at the
+      * start of the vector are unchanged since the last update, so their
+      * statistics can be reused.  Reset to 0 by every update. */
+    int _unchangedSamples;
+
+    /** Set with _unchangedSamples when the vector first dropped this many
+      * samples from its start: _unchangedSamples then counts the ones
+      * after those, which have only moved.  Their statistics have to be
+      * worked out again, but snapshots keep them.  Reset to 0 by every
+      * update. */
+    int _shiftedSamples;
+
     /** is the vector monotonically rising */
     bool _is_rising : 1;
 
@@ -213,6 +309,13 @@ class KSTCORE_EXPORT Vector : public Primitive
     /** should the vector data be saved? */
     bool _saveData : 1;
 
+    bool _scrolling : 1;
+
+    /** _v is _vOffset doubles into an allocation of _vCapacity doubles.
+      * _vOffset is only ever non zero when scrolling. */
+    int _vOffset;
+    int _vCapacity;
+
     double _min, _max, _mean, _minPos;
 
     /** Scalar Maintenance methods */
@@ -228,10 +331,83 @@ class KSTCORE_EXPORT Vector : public Primitive
     virtual double* realloced(double *memptr, int newSize);
     virtual void setV(double *memptr, int newSize);
 
+    /** Hand the freshly updated contents over to the renderer.  Since the
+      * last update the vector dropped its first shift samples, and kept
+      * the next kept. */
+    void publishSnapshot(int shift, int kept);
+
+    /** Use the samples of lender, which holds exactly what this vector
+      * would, instead of a buffer of our own.  Nothing is copied.  The
+      * buffer is shared through a VectorBuffer: a lender which goes on to
+      * move or change its samples does so in a copy, and leaves the
+      * borrowers what they had until they borrow again.  Anything here
+      * which changes the samples first takes a copy too.  With the lender
+      * at least read locked. */
+    void borrowBuffer(const Vector *lender);
+    /** Make the samples ours to change: copy borrowed ones into a buffer
+      * of our own, or move on from lent ones which are still borrowed.
+      * Returns false if there wasn't the memory, in which case nothing
+      * changes. */
+    bool detachBuffer();
+    bool borrowsBuffer() const { return _borrowed; }
+
     ObjectMap<Scalar> _scalars;
     ObjectMap<String> _strings;
 
-
+    mutable QMutex _snapshotMutex;
+    mutable VectorSnapshotPtr _snapshot;
+    mutable bool _snapshotWanted; // snapshot() called since the last update
+    /** the snapshot published before _snapshot, for publishSnapshot() to
+      * refresh once the renderer lets go of it.  Only the update touches
+      * it. */
+    VectorSnapshotPtr _spareSnapshot;
+    int _spareShift; // as publishSnapshot(), since the spare was current
+    int _spareKept;
+    bool refreshSnapshot(VectorSnapshot *snapshot, int shift, int kept) const;
+
+  private:
+    /** fill _v from _f, if it isn't already */
+    double *expand();
+    /** hold the samples in _f, or in _v alone.  With _expandMutex. */
+    bool narrow();
+    bool widen();
+
+    mutable QMutex _expandMutex;
+    bool _floatStorage; // Float32Storage, whether or not _f is in use
+    bool _expanded;     // _v holds the contents of _f
+    bool _expandWanted; // value() was called since the last update
+
+    /** _v, or _f if set, belongs to another vector: see borrowBuffer().
+      * With _f, _v is still our own. */
+    bool _borrowed;
+    /** set while _f, or else _v, is lent or borrowed */
+    mutable VectorBufferPtr _buffer;
+    mutable QMutex _bufferMutex;
+    VectorBufferPtr lendBuffer() const;
+    void releasePrimary(); // _f, or else _v
+    void releaseBuffers();
+
+    /** 0 until minMaxIndex() is first called */
+    MinMaxIndexPtr _minMax;
+    mutable QMutex _minMaxMutex; // _minMax itself, which readers may make
+
+    // Running statistics over part of the vector, which can be carried on
+    // over samples appended later.
+    struct Statistics : public RunningStatistics {
+      Statistics();
+      template<class T> void add(const T *v, int from, int to);
+
+      bool nsStarted;
+      double nsMin, nsMax, nsLast;
+      int nsSkip; // samples still to skip after a spike
+    };
+
+    /** the statistics of the first _prefixSize samples */
+    Statistics _prefixStats;
+    int _prefixSize;
+
+    int _rewrites;
+    int _updatedSize; // _size as of the last update
 };
 
 
@@ -228,6 +228,7 @@ PrimitivePtr DataVectorFactory::generatePrimitive(ObjectStore *store, QXmlStream
   bool doAve=false;
   QString start_units;
   QString range_units;
+  Vector::StorageType storage = Vector::DoubleStorage;
 
   while (!xml.atEnd()) {
       const QString n = xml.name().toString();
@@ -244,6 +245,7 @@ PrimitivePtr DataVectorFactory::generatePrimitive(ObjectStore *store, QXmlStream
         doAve = attrs.value("doAve").toString() == "true" ? true : false;
         start_units = attrs.value("startUnits").toString();
         range_units = attrs.value("rangeUnits").toString();
+        storage = Vector::storageTypeFromName(attrs.value("storage").toString());
 
         // set overrides if set from command line
         if (!store->override.fileName.isEmpty()) {
@@ -310,6 +312,7 @@ PrimitivePtr DataVectorFactory::generatePrimitive(ObjectStore *store, QXmlStream
   vector->setDescriptiveName(descriptiveName);
   vector->setStartUnits(start_units);
   vector->setRangeUnits(range_units);
+  vector->setStorageType(storage);
   vector->registerChange();
   vector->unlock();
 
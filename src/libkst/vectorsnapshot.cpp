@@ -0,0 +1,149 @@
+/***************************************************************************
+             vectorsnapshot.cpp: the contents of a Vector at one time
+                             -------------------
+    begin                : October, 2012
+    copyright            : (C) 2012 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "vectorsnapshot.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bufferstore.h"
+#include "vector.h"
+
+namespace Kst {
+
+VectorSnapshot::VectorSnapshot(double *v, int size, bool isRising, Ownership ownership)
+  : Shared(), _v(v), _f(0), _storage(0), _offset(0), _capacity(0), _size(size), _isRising(isRising), _owned(false) {
+
+  if (ownership == Copied && size > 0) {
+    _v = static_cast<double*>(BufferStore::self()->allocate(size * sizeof(double), BufferStore::SnapshotData));
+    if (_v) {
+      memcpy(_v, v, size * sizeof(double));
+      _storage = _v;
+      _capacity = size;
+      _owned = true;
+    } else {
+      _size = 0;
+    }
+  }
+}
+
+
+VectorSnapshot::VectorSnapshot(float *f, int size, bool isRising, Ownership ownership)
+  : Shared(), _v(0), _f(f), _storage(0), _offset(0), _capacity(0), _size(size), _isRising(isRising), _owned(false) {
+
+  if (ownership == Copied && size > 0) {
+    _f = static_cast<float*>(BufferStore::self()->allocate(size * sizeof(float), BufferStore::SnapshotData));
+    if (_f) {
+      memcpy(_f, f, size * sizeof(float));
+      _storage = _f;
+      _capacity = size;
+      _owned = true;
+    } else {
+      _size = 0;
+    }
+  }
+}
+
+
+VectorSnapshot::~VectorSnapshot() {
+  if (_owned) {
+    BufferStore::self()->release(_storage);
+  }
+}
+
+
+bool VectorSnapshot::refresh(const double *v, int size, bool isRising, int shift, int kept) {
+  if (!_owned || _f) {
+    return false;
+  }
+  _isRising = isRising;
+  return refresh(v, sizeof(double), size, shift, kept);
+}
+
+
+bool VectorSnapshot::refresh(const float *f, int size, bool isRising, int shift, int kept) {
+  if (!_owned || !_f) {
+    return false;
+  }
+  _isRising = isRising;
+  return refresh(f, sizeof(float), size, shift, kept);
+}
+
+
+// Dropping samples from the start only moves the start along, as with a
+// scrolling Vector, until the copy runs out of room at the end.
+bool VectorSnapshot::refresh(const void *from, size_t sampleSize, int size, int shift, int kept) {
+  if (size <= 0) {
+    return false;
+  }
+  if (shift < 0 || shift > _size) {
+    shift = kept = 0;
+  }
+  kept = qBound(0, kept, qMin(size, _size - shift));
+
+  char *storage = static_cast<char*>(_storage);
+  int offset = _offset + shift;
+  if (offset + size > _capacity) {
+    // out of room: move what is kept back to the start, and when dropping
+    // samples, leave half as much again to drop before the next move
+    memmove(storage, storage + offset*sampleSize, kept*sampleSize);
+    offset = 0;
+    const int capacity = (shift > 0) ? size + size/2 : size;
+    if (capacity > _capacity) {
+      if (!BufferStore::self()->resize(storage, capacity*sampleSize)) {
+        return false;
+      }
+      _storage = storage;
+      _capacity = capacity;
+    }
+  }
+
+  memcpy(storage + (offset + kept)*sampleSize, static_cast<const char*>(from) + kept*sampleSize, (size - kept)*sampleSize);
+  _offset = offset;
+  _size = size;
+  if (_f) {
+    _f = reinterpret_cast<float*>(storage + offset*sampleSize);
+  } else {
+    _v = reinterpret_cast<double*>(storage + offset*sampleSize);
+  }
+  return true;
+}
+
+
+double VectorSnapshot::interpolate(int in_i, int ns_i) const {
+  if (_f) {
+    return kstInterpolate(_f, _size, in_i, ns_i);
+  }
+  return kstInterpolate(_v, _size, in_i, ns_i);
+}
+
+
+const double *VectorSnapshot::interpolated(int from, int count, int ns_i, double *out) const {
+  if (_f) {
+    kstInterpolate(_f, _size, from, count, ns_i, out);
+    return out;
+  }
+  if (ns_i == _size && from >= 0 && from + count <= _size) {
+    return _v + from;
+  }
+  kstInterpolate(_v, _size, from, count, ns_i, out);
+  return out;
+}
+
+}
+
+// vim: ts=2 sw=2 et
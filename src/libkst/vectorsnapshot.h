@@ -0,0 +1,106 @@
+/***************************************************************************
+              vectorsnapshot.h: the contents of a Vector at one time
+                             -------------------
+    begin                : October, 2012
+    copyright            : (C) 2012 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef VECTORSNAPSHOT_H
+#define VECTORSNAPSHOT_H
+
+#include <QMutex>
+
+#include "minmaxindex.h"
+#include "sharedptr.h"
+#include "kst_export.h"
+
+namespace Kst {
+
+// A read only view of the data in a Vector, as it was at the end of an
+// update.  The renderer works from these so that it never has to lock a
+// vector which is being read or recalculated by the update thread.
+//
+// An owning snapshot has its own copy of the data and stays valid for as
+// long as anyone holds a pointer to it.  Once nobody but the vector does,
+// the vector brings it up to date with refresh() rather than copying the
+// whole vector again.  A borrowed snapshot points at the
+// vector's own buffer, and is only good until the vector next changes:
+// that is what Vector::snapshot() hands out when updates are done on the
+// GUI thread, where a copy would be wasted.
+//
+// A snapshot of a single precision vector stays single precision.
+
+class KSTCORE_EXPORT VectorSnapshot : public Shared
+{
+  public:
+    enum Ownership { Borrowed = 0, Copied = 1 };
+
+    VectorSnapshot(double *v, int size, bool isRising, Ownership ownership);
+    VectorSnapshot(float *f, int size, bool isRising, Ownership ownership);
+
+    int length() const { return _size; }
+    bool isRising() const { return _isRising; }
+    bool isCopy() const { return _owned; }
+
+    double value(int i) const { return _f ? _f[i] : _v[i]; }
+    /** 0 for a single precision snapshot */
+    const double *value() const { return _v; }
+    /** the samples, whichever way they are held */
+    const void *data() const { return _f ? static_cast<const void*>(_f) : _v; }
+
+    /** same as Vector::interpolate() */
+    double interpolate(int in_i, int ns_i) const;
+    /** same as Vector::interpolated() */
+    const double *interpolated(int from, int count, int ns_i, double *out) const;
+
+    /** For Vector, on a copy nobody else holds: make it the samples v now
+      * has, given that since the copy was made v dropped its first shift
+      * samples and kept the next kept as they were.  Only what changed is
+      * copied.  Returns false, with the copy no longer good for anything,
+      * if there wasn't the memory or v changed precision. */
+    bool refresh(const double *v, int size, bool isRising, int shift, int kept);
+    bool refresh(const float *f, int size, bool isRising, int shift, int kept);
+
+    /** the vector's MinMaxIndex as of the snapshot, or 0 if it has none */
+    const MinMaxIndex *minMaxIndex() const { QMutexLocker ml(&_minMaxMutex); return _minMax.data(); }
+    /** for Vector, before handing the snapshot out, or once it has made an
+      * index of the very same samples */
+    void setMinMaxIndex(const MinMaxIndexPtr &index) { QMutexLocker ml(&_minMaxMutex); _minMax = index; }
+
+  protected:
+    virtual ~VectorSnapshot();
+
+  private:
+    Q_DISABLE_COPY(VectorSnapshot)
+
+    bool refresh(const void *from, size_t sampleSize, int size, int shift, int kept);
+
+    double *_v;
+    float *_f;
+    void *_storage; // of a copy: the samples are _offset into _capacity
+    int _offset;
+    int _capacity;
+    int _size;
+    bool _isRising;
+    bool _owned;
+    MinMaxIndexPtr _minMax;
+    mutable QMutex _minMaxMutex;
+};
+
+typedef SharedPtr<VectorSnapshot> VectorSnapshotPtr;
+
+}
+
+#endif
+
+// vim: ts=2 sw=2 et
@@ -120,7 +120,7 @@ void VScalar::internalUpdate() {
   if (_file) {
     int f0;
     if (_f0<0) { 
-      f0 = _file->vector().dataInfo(_field).frameCount;
+      f0 = _file->vectorInfo(_field).frameCount;
     } else {
       f0 = _f0;
     }
@@ -131,6 +131,14 @@ void VScalar::internalUpdate() {
   }
 }
 
+QList<ObjectPtr> VScalar::inputObjects() const {
+  QList<ObjectPtr> inputs = Primitive::inputObjects();
+  if (_file) {
+    inputs.append(ObjectPtr(_file.data()));
+  }
+  return inputs;
+}
+
 qint64 VScalar::minInputSerial() const {
   if (_file) {
     return (_file->serial());
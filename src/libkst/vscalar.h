@@ -48,6 +48,7 @@ class KSTCORE_EXPORT VScalar : public Scalar {
 
     /** Update the scalar. */
     virtual void internalUpdate();
+    virtual QList<ObjectPtr> inputObjects() const;
 
     virtual const QString& typeString() const;
     static const QString staticTypeString;
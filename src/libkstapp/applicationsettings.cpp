@@ -13,9 +13,17 @@
 #include "applicationsettings.h"
 
 #include "updatemanager.h"
+#include "blockcache.h"
+#include "bufferstore.h"
 #include "defaultlabelpropertiestab.h"
 
 #include <QCoreApplication>
+#include <QDir>
+#if QT_VERSION >= 0x050000
+#include <QStandardPaths>
+#else
+#include <QDesktopServices>
+#endif
 #ifndef KST_NO_OPENGL
 #include <QGLPixelBuffer>
 #endif
@@ -54,6 +62,12 @@ ApplicationSettings::ApplicationSettings() {
   _useOpenGL = _settings->value("general/opengl", false).toBool(); //QVariant(QGLPixelBuffer::hasOpenGLPbuffers())).toBool();
 
   _maxUpdate = _settings->value("general/minimumupdateperiod", QVariant(200)).toInt();
+  _updateThreads = _settings->value("general/updatethreads", QVariant(1)).toInt();
+  _backgroundUpdates = _settings->value("general/backgroundupdates", QVariant(false)).toBool();
+  _targetLatency = _settings->value("general/targetlatency", QVariant(0)).toInt();
+  _residentBudget = _settings->value("general/residentbudget", QVariant(0)).toInt();
+  _scratchDirectory = _settings->value("general/scratchdirectory", defaultScratchDirectory()).toString();
+  _blockCache = _settings->value("general/blockcache", QVariant(128)).toInt();
 
   _showGrid = _settings->value("grid/showgrid", QVariant(false)).toBool();
   _snapToGrid = _settings->value("grid/snaptogrid", QVariant(false)).toBool();
@@ -181,6 +195,98 @@ void ApplicationSettings::setMinimumUpdatePeriod(const int period) {
 }
 
 
+int ApplicationSettings::updateThreads() const {
+  return _updateThreads;
+}
+
+
+void ApplicationSettings::setUpdateThreads(const int threads) {
+  _updateThreads = threads;
+  _settings->setValue("general/updatethreads", threads);
+
+  UpdateManager::self()->setUpdateThreads(threads);
+}
+
+
+bool ApplicationSettings::backgroundUpdates() const {
+  return _backgroundUpdates;
+}
+
+
+void ApplicationSettings::setBackgroundUpdates(bool background) {
+  _backgroundUpdates = background;
+  _settings->setValue("general/backgroundupdates", background);
+
+  UpdateManager::self()->setBackgroundUpdates(background);
+}
+
+
+int ApplicationSettings::targetLatency() const {
+  return _targetLatency;
+}
+
+
+void ApplicationSettings::setTargetLatency(const int latency) {
+  _targetLatency = latency;
+  _settings->setValue("general/targetlatency", latency);
+
+  UpdateManager::self()->setTargetLatency(latency);
+}
+
+
+int ApplicationSettings::residentBudget() const {
+  return _residentBudget;
+}
+
+
+void ApplicationSettings::setResidentBudget(const int megabytes) {
+  _residentBudget = megabytes;
+  _settings->setValue("general/residentbudget", megabytes);
+
+  BufferStore::self()->setResidentBudget(qint64(megabytes)*1024*1024);
+}
+
+
+QString ApplicationSettings::scratchDirectory() const {
+  return _scratchDirectory;
+}
+
+
+void ApplicationSettings::setScratchDirectory(const QString &directory) {
+  _scratchDirectory = directory.isEmpty() ? defaultScratchDirectory() : directory;
+  _settings->setValue("general/scratchdirectory", _scratchDirectory);
+
+  BufferStore::self()->setScratchDirectory(_scratchDirectory);
+}
+
+
+// The temporary directory is often a tmpfs, which is memory anyway.
+QString ApplicationSettings::defaultScratchDirectory() {
+#if QT_VERSION >= 0x050000
+  const QString cache = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+#else
+  const QString cache = QDesktopServices::storageLocation(QDesktopServices::CacheLocation);
+#endif
+  if (cache.isEmpty()) {
+    return QDir::tempPath();
+  }
+  return cache + QDir::separator() + "scratch";
+}
+
+
+int ApplicationSettings::blockCache() const {
+  return _blockCache;
+}
+
+
+void ApplicationSettings::setBlockCache(const int megabytes) {
+  _blockCache = megabytes;
+  _settings->setValue("general/blockcache", megabytes);
+
+  BlockCache::self()->setCapacity(qint64(megabytes)*1024*1024);
+}
+
+
 bool ApplicationSettings::showGrid() const {
   return _showGrid;
 }
@@ -50,6 +50,28 @@ class ApplicationSettings : public QObject
     int minimumUpdatePeriod() const;
     void setMinimumUpdatePeriod(const int period);
 
+    int updateThreads() const;
+    void setUpdateThreads(const int threads);
+
+    bool backgroundUpdates() const;
+    void setBackgroundUpdates(bool background);
+
+    int targetLatency() const;
+    void setTargetLatency(const int latency);
+
+    /** in MB; 0 for no limit */
+    int residentBudget() const;
+    void setResidentBudget(const int megabytes);
+
+    /** where data past the resident budget goes */
+    QString scratchDirectory() const;
+    void setScratchDirectory(const QString &directory);
+    static QString defaultScratchDirectory();
+
+    /** memory for recently read data, in MB; 0 to keep none */
+    int blockCache() const;
+    void setBlockCache(const int megabytes);
+
     bool showGrid() const;
     void setShowGrid(bool showGrid);
 
@@ -89,6 +111,12 @@ class ApplicationSettings : public QObject
     qreal _refViewHeight;
     qreal _minFontSize;
     int _maxUpdate;
+    int _updateThreads;
+    bool _backgroundUpdates;
+    int _targetLatency;
+    int _residentBudget;
+    QString _scratchDirectory;
+    int _blockCache;
     bool _showGrid;
     bool _snapToGrid;
     qreal _gridHorSpacing;
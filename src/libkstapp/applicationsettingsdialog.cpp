@@ -76,6 +76,12 @@ void ApplicationSettingsDialog::setupGeneral() {
   _generalTab->setUseOpenGL(ApplicationSettings::self()->useOpenGL());
   _generalTab->setTransparentDrag(ApplicationSettings::self()->transparentDrag());
   _generalTab->setMinimumUpdatePeriod(ApplicationSettings::self()->minimumUpdatePeriod());
+  _generalTab->setUpdateThreads(ApplicationSettings::self()->updateThreads());
+  _generalTab->setBackgroundUpdates(ApplicationSettings::self()->backgroundUpdates());
+  _generalTab->setTargetLatency(ApplicationSettings::self()->targetLatency());
+  _generalTab->setResidentBudget(ApplicationSettings::self()->residentBudget());
+  _generalTab->setScratchDirectory(ApplicationSettings::self()->scratchDirectory());
+  _generalTab->setBlockCache(ApplicationSettings::self()->blockCache());
   _generalTab->setAntialiasPlot(ApplicationSettings::self()->antialiasPlots());
 }
 
@@ -109,6 +115,12 @@ void ApplicationSettingsDialog::generalChanged() {
   ApplicationSettings::self()->setTransparentDrag(_generalTab->transparentDrag());
   ApplicationSettings::self()->setUseOpenGL(_generalTab->useOpenGL());
   ApplicationSettings::self()->setMinimumUpdatePeriod(_generalTab->minimumUpdatePeriod());
+  ApplicationSettings::self()->setUpdateThreads(_generalTab->updateThreads());
+  ApplicationSettings::self()->setBackgroundUpdates(_generalTab->backgroundUpdates());
+  ApplicationSettings::self()->setTargetLatency(_generalTab->targetLatency());
+  ApplicationSettings::self()->setResidentBudget(_generalTab->residentBudget());
+  ApplicationSettings::self()->setScratchDirectory(_generalTab->scratchDirectory());
+  ApplicationSettings::self()->setBlockCache(_generalTab->blockCache());
   ApplicationSettings::self()->setAntialiasPlots(_generalTab->antialiasPlot());
   ApplicationSettings::self()->blockSignals(false);
 
@@ -18,6 +18,7 @@
 
 #include "plotitem.h"
 #include "applicationsettings.h"
+#include "updatemanager.h"
 
 namespace Kst {
 
@@ -82,6 +83,7 @@ void CartesianRenderItem::paintRelations(QPainter *painter) {
     context.b_X = b_X;
     context.b_Y = b_Y;
     context.antialias = ApplicationSettings::self()->antialiasPlots();
+    context.decimation = UpdateManager::self()->decimation();
 
     relation->paint(context);
   }
@@ -17,6 +17,7 @@
 #include "logevents.h"
 #include "datasource.h"
 #include "datasourcepluginmanager.h"
+#include "updateprofiler.h"
 #include "kst_i18n.h"
 
 #include <QDebug>
@@ -32,6 +33,7 @@ DebugDialog::DebugDialog(QWidget *parent)
   _logTabLayout->addWidget(_log,0,0);
 
   connect(_clear, SIGNAL(clicked()), this, SLOT(clear()));
+  connect(_refreshProfile, SIGNAL(clicked()), this, SLOT(refreshProfile()));
   connect(_showDebug, SIGNAL(toggled(bool)), _log, SLOT(setShowDebug(bool)));
   connect(_showWarning, SIGNAL(toggled(bool)), _log, SLOT(setShowWarning(bool)));
   connect(_showNotice, SIGNAL(toggled(bool)), _log, SLOT(setShowNotice(bool)));
@@ -89,9 +91,31 @@ void DebugDialog::show() {
   }
 
   _dataSources->header()->resizeSections(QHeaderView::ResizeToContents);
+  refreshProfile();
   QDialog::show();
 }
 
+
+void DebugDialog::refreshProfile() {
+  const UpdateProfiler::Cycle cycle = UpdateProfiler::self()->lastCycle();
+
+  _profile->clear();
+  _profile->setSortingEnabled(false);
+  foreach (const UpdateProfiler::Sample &sample, cycle.samples) {
+    QTreeWidgetItem *item = new QTreeWidgetItem(QStringList() << sample.name << sample.type << UpdateProfiler::kindName(sample.kind));
+    item->setData(3, Qt::DisplayRole, double(sample.nsecs) / 1.0e6);
+    _profile->addTopLevelItem(item);
+  }
+  _profile->setSortingEnabled(true);
+  _profile->sortItems(3, Qt::DescendingOrder);
+  _profile->header()->resizeSections(QHeaderView::ResizeToContents);
+
+  _profileSummary->setText(i18n("Update %1: %2 ms, %3 deferred loops, %4 quick updates taking %5 ms")
+                           .arg(cycle.serial).arg(double(cycle.nsecs) / 1.0e6)
+                           .arg(cycle.deferredLoops).arg(cycle.quickSamples)
+                           .arg(double(cycle.quickNsecs) / 1.0e6));
+}
+
 }
 
 // vim: ts=2 sw=2 et
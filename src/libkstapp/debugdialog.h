@@ -40,6 +40,7 @@ class DebugDialog : public QDialog, Ui::DebugDialog
   public Q_SLOTS:
     void clear();
     void show();
+    void refreshProfile();
 
   protected:
     bool event(QEvent *e);
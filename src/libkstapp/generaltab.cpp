@@ -21,8 +21,16 @@ GeneralTab::GeneralTab(QWidget *parent)
   setupUi(this);
   setTabTitle(tr("General"));
 
+  _scratchDirectory->setMode(QFileDialog::Directory);
+
   connect(_useOpenGL, SIGNAL(stateChanged(int)), this, SIGNAL(modified()));
   connect(_maxUpdate, SIGNAL(valueChanged(int)), this, SIGNAL(modified()));
+  connect(_updateThreads, SIGNAL(valueChanged(int)), this, SIGNAL(modified()));
+  connect(_backgroundUpdates, SIGNAL(stateChanged(int)), this, SIGNAL(modified()));
+  connect(_targetLatency, SIGNAL(valueChanged(int)), this, SIGNAL(modified()));
+  connect(_residentBudget, SIGNAL(valueChanged(int)), this, SIGNAL(modified()));
+  connect(_scratchDirectory, SIGNAL(changed(const QString&)), this, SIGNAL(modified()));
+  connect(_blockCache, SIGNAL(valueChanged(int)), this, SIGNAL(modified()));
   connect(_transparentDrag, SIGNAL(stateChanged(int)), this, SIGNAL(modified()));
   connect(_antialiasPlots, SIGNAL(stateChanged(int)), this, SIGNAL(modified()));
 }
@@ -73,6 +81,66 @@ void GeneralTab::setMinimumUpdatePeriod(const int period) {
   _maxUpdate->setValue(period);
 }
 
+
+int GeneralTab::updateThreads() const {
+  return _updateThreads->value();
+}
+
+
+void GeneralTab::setUpdateThreads(const int threads) {
+  _updateThreads->setValue(threads);
+}
+
+
+bool GeneralTab::backgroundUpdates() const {
+  return _backgroundUpdates->isChecked();
+}
+
+
+void GeneralTab::setBackgroundUpdates(bool background) {
+  _backgroundUpdates->setChecked(background);
+}
+
+
+int GeneralTab::targetLatency() const {
+  return _targetLatency->value();
+}
+
+
+void GeneralTab::setTargetLatency(const int latency) {
+  _targetLatency->setValue(latency);
+}
+
+
+int GeneralTab::residentBudget() const {
+  return _residentBudget->value();
+}
+
+
+void GeneralTab::setResidentBudget(const int megabytes) {
+  _residentBudget->setValue(megabytes);
+}
+
+
+QString GeneralTab::scratchDirectory() const {
+  return _scratchDirectory->file();
+}
+
+
+void GeneralTab::setScratchDirectory(const QString &directory) {
+  _scratchDirectory->setFile(directory);
+}
+
+
+int GeneralTab::blockCache() const {
+  return _blockCache->value();
+}
+
+
+void GeneralTab::setBlockCache(const int megabytes) {
+  _blockCache->setValue(megabytes);
+}
+
 }
 
 // vim: ts=2 sw=2 et
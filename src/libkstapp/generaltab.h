@@ -38,6 +38,24 @@ class GeneralTab : public DialogTab, Ui::GeneralTab {
     int minimumUpdatePeriod() const;
     void setMinimumUpdatePeriod(const int Period);
 
+    int updateThreads() const;
+    void setUpdateThreads(const int threads);
+
+    bool backgroundUpdates() const;
+    void setBackgroundUpdates(bool background);
+
+    int targetLatency() const;
+    void setTargetLatency(const int latency);
+
+    int residentBudget() const;
+    void setResidentBudget(const int megabytes);
+
+    QString scratchDirectory() const;
+    void setScratchDirectory(const QString &directory);
+
+    int blockCache() const;
+    void setBlockCache(const int megabytes);
+
 };
 
 }
@@ -41,6 +41,8 @@
 #include "view.h"
 #include "applicationsettings.h"
 #include "updatemanager.h"
+#include "blockcache.h"
+#include "bufferstore.h"
 #include "datasourcepluginmanager.h"
 #include "pluginmenuitemaction.h"
 
@@ -74,6 +76,7 @@
 #include <QMessageBox>
 #include <QImageWriter>
 #include <QToolBar>
+#include <QTimer>
 
 namespace Kst {
 
@@ -90,7 +93,8 @@ MainWindow::MainWindow() :
     _applicationSettingsDialog(0),
     _themeDialog(0),
     _aboutDialog(0),
-    _highlightPoint(false)
+    _highlightPoint(false),
+    _paintPending(false)
 #if defined(__QNX__)
   , _qnxToolbarsVisible(true)
 #endif 
@@ -121,6 +125,13 @@ MainWindow::MainWindow() :
 
   readSettings();
   connect(UpdateManager::self(), SIGNAL(objectsUpdated(qint64)), this, SLOT(updateViewItems(qint64)));
+  connect(UpdateManager::self(), SIGNAL(decimationChanged(int)), this, SLOT(redrawPlots()));
+
+  // a view which is hidden or minimized may not be painted for a while
+  _paintTimeout = new QTimer(this);
+  _paintTimeout->setSingleShot(true);
+  _paintTimeout->setInterval(1000);
+  connect(_paintTimeout, SIGNAL(timeout()), this, SLOT(viewPaintAbandoned()));
 
   QTimer::singleShot(0, this, SLOT(performHeavyStartupActions()));
 
@@ -148,6 +159,12 @@ MainWindow::~MainWindow() {
 void MainWindow::performHeavyStartupActions() {
   // Set the timer for the UpdateManager.
   UpdateManager::self()->setMinimumUpdatePeriod(ApplicationSettings::self()->minimumUpdatePeriod());
+  UpdateManager::self()->setUpdateThreads(ApplicationSettings::self()->updateThreads());
+  UpdateManager::self()->setBackgroundUpdates(ApplicationSettings::self()->backgroundUpdates());
+  UpdateManager::self()->setTargetLatency(ApplicationSettings::self()->targetLatency());
+  BufferStore::self()->setResidentBudget(qint64(ApplicationSettings::self()->residentBudget())*1024*1024);
+  BufferStore::self()->setScratchDirectory(ApplicationSettings::self()->scratchDirectory());
+  BlockCache::self()->setCapacity(qint64(ApplicationSettings::self()->blockCache())*1024*1024);
   DataObject::init();
   DataSourcePluginManager::init();
 }
@@ -1724,11 +1741,43 @@ void MainWindow::updateViewItems(qint64 serial) {
     changed |= plot->handleChangedInputs(serial);
   }
 
+  // The update is finished once its results have been painted, which is
+  // what its latency is measured up to.
   if (changed) {
-    _tabWidget->currentView()->update();
+    View *view = _tabWidget->currentView();
+    connect(view, SIGNAL(painted()), this, SLOT(viewPainted()), Qt::UniqueConnection);
+    _paintPending = true;
+    _paintTimeout->start();
+    view->update();
+  } else {
+    QTimer::singleShot(0, UpdateManager::self(), SLOT(viewItemUpdateFinished()));
   }
+}
+
+
+void MainWindow::viewPainted() {
+  if (_paintPending) {
+    _paintPending = false;
+    _paintTimeout->stop();
+    UpdateManager::self()->viewItemUpdateFinished();
+  }
+}
 
-  QTimer::singleShot(20, UpdateManager::self(), SLOT(viewItemUpdateFinished()));
+
+void MainWindow::viewPaintAbandoned() {
+  if (_paintPending) {
+    _paintPending = false;
+    UpdateManager::self()->viewItemUpdateAbandoned();
+  }
+}
+
+
+// The curves were drawn with another decimation: see CurveRenderContext.
+void MainWindow::redrawPlots() {
+  foreach (PlotItem *plot, ViewItem::getItems<PlotItem>()) {
+    plot->setPlotPixmapDirty();
+    plot->update();
+  }
 }
 
 void MainWindow::showVectorEditor() {
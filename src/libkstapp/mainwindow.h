@@ -26,6 +26,7 @@ class QAction;
 class QProgressBar;
 class QUndoGroup;
 class QPrinter;
+class QTimer;
 
 namespace Kst {
 
@@ -122,6 +123,10 @@ class MainWindow : public QMainWindow
     void updateRecentDataFiles(const QString& newfilename = QString());
 
   private Q_SLOTS:
+    void viewPainted();
+    void viewPaintAbandoned();
+    void redrawPlots();
+
     void aboutToQuit();
     void about();
     void currentViewChanged();
@@ -214,6 +219,9 @@ class MainWindow : public QMainWindow
 
     bool _highlightPoint;
 
+    bool _paintPending; // the results of an update are still to be drawn
+    QTimer *_paintTimeout;
+
     QMenu *_fileMenu;
     QMenu *_editMenu;
     QMenu *_viewMenu;
@@ -14,6 +14,11 @@
 
 #include "memorywidget.h"
 
+#include <QStringList>
+
+#include "blockcache.h"
+#include "bufferstore.h"
+
 #include <psversion.h>
 #include <sysinfo.h>
 
@@ -32,10 +37,27 @@ MemoryWidget::~MemoryWidget() {
 
 
 void MemoryWidget::updateFreeMemory() {
+  BufferStore *store = BufferStore::self();
+  qint64 inUse = 0;
+  QStringList usage;
+  for (int i = 0; i < BufferStore::UsageCount; ++i) {
+    const BufferStore::Usage u = BufferStore::Usage(i);
+    inUse += store->bytesInUse(u);
+    usage << tr("%1: %2 MB").arg(BufferStore::usageName(u)).arg(store->bytesInUse(u) / (1024 * 1024));
+  }
+  usage << tr("Mapped to scratch files: %1 MB in %2 buffers").arg(store->mappedBytes() / (1024 * 1024)).arg(store->mappedBuffers());
+  usage << tr("Kept for reuse: %1 MB").arg(store->pooledBytes() / (1024 * 1024));
+  BlockCache *cache = BlockCache::self();
+  usage << tr("Recently read: %1 MB in %2 blocks, %3 hits, %4 misses").arg(cache->bytes() / (1024 * 1024))
+           .arg(cache->blocks()).arg(cache->hits()).arg(cache->misses());
+  setToolTip(usage.join("\n"));
+
 #ifdef __linux__
   meminfo();
   unsigned long mi = S(kb_main_free + kb_main_cached);
-  setText(tr("%1 MB available").arg(mi / (1024 * 1024)));
+  setText(tr("%1 MB available, %2 MB of data").arg(mi / (1024 * 1024)).arg(inUse / (1024 * 1024)));
+#else
+  setText(tr("%1 MB of data").arg(inUse / (1024 * 1024)));
 #endif
 }
 
@@ -36,6 +36,7 @@
 
 #include "applicationsettings.h"
 #include "updatemanager.h"
+#include "updateprofiler.h"
 
 #include "math_kst.h"
 
@@ -45,6 +46,7 @@
 #include <QDebug>
 #include <QGraphicsSceneMouseEvent>
 #include <QClipboard>
+#include <QElapsedTimer>
 
 // Benchmark drawing
 // undefined = None, 1 = PlotItem, 2 = More Details
@@ -937,6 +939,8 @@ void PlotItem::paint(QPainter *painter) {
     return;
   }
 
+  QElapsedTimer paintTime;
+  paintTime.start();
 #if BENCHMARK
   QTime bench_time;
   bench_time.start();
@@ -964,6 +968,7 @@ void PlotItem::paint(QPainter *painter) {
   int i = bench_time.elapsed();
   qDebug() << "Total Time to paint " << (void *)this << ": " << i << "ms" << endl;
 #endif
+  UpdateProfiler::self()->record(UpdateProfiler::Paint, shortName(), typeName(), paintTime.nsecsElapsed());
 }
 
 
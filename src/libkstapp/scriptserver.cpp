@@ -55,6 +55,7 @@
 #include "editablematrix.h"
 
 #include <updatemanager.h>
+#include <updateprofiler.h>
 
 #include <QLocalSocket>
 #include <iostream>
@@ -190,6 +191,7 @@ ScriptServer::ScriptServer(ObjectStore *obj) : _server(new QLocalServer(this)),
     _fnMap.insert("readToEnd()",&ScriptServer::readToEnd);
     _fnMap.insert("setPaused()",&ScriptServer::setPaused);
     _fnMap.insert("unsetPaused()",&ScriptServer::unsetPaused);
+    _fnMap.insert("getUpdateProfile()",&ScriptServer::getUpdateProfile);
 
     _fnMap.insert("newMacro()",&ScriptServer::newMacro);
     _fnMap.insert("newMacro_()",&ScriptServer::newMacro_);
@@ -1164,6 +1166,12 @@ QByteArray ScriptServer::unsetPaused(QByteArray&, QLocalSocket* s,ObjectStore*,c
 
 }
 
+QByteArray ScriptServer::getUpdateProfile(QByteArray&, QLocalSocket* s,ObjectStore*,const int&ifMode,
+                                          const QByteArray&ifEqual,IfSI*& _if,VarSI*var) {
+    QString profile = UpdateProfiler::self()->report(UpdateProfiler::self()->historyLength());
+    return handleResponse(profile.toLatin1(),s,ifMode,ifEqual,_if,var);
+}
+
 QByteArray ScriptServer::newMacro(QByteArray&command, QLocalSocket* s,ObjectStore*,const int&,
                                   const QByteArray&,IfSI*& _if,VarSI*) {
     if(_curMac) {
@@ -45,6 +45,7 @@ VectorTab::VectorTab(ObjectStore *store, QWidget *parent)
   connect(_dataRange, SIGNAL(modified()), this, SIGNAL(modified()));
   connect(_numberOfSamples, SIGNAL(valueChanged(int)), this, SIGNAL(modified()));
   connect(_from, SIGNAL(textChanged(const QString&)), this, SIGNAL(modified()));
+  connect(_storageBox, SIGNAL(currentIndexChanged(int)), this, SIGNAL(modified()));
   connect(_to, SIGNAL(textChanged(const QString&)), this, SIGNAL(modified()));
 
   // embed data range in the data source box
@@ -153,6 +154,22 @@ DataRange *VectorTab::dataRange() const {
 }
 
 
+// the items of _storageBox are in the order of Vector::StorageType
+Vector::StorageType VectorTab::storageType() const {
+  return Vector::StorageType(qMax(_storageBox->currentIndex(), 0));
+}
+
+
+void VectorTab::setStorageType(Vector::StorageType type) {
+  _storageBox->setCurrentIndex(int(type));
+}
+
+
+bool VectorTab::storageTypeDirty() const {
+  return _storageBox->currentIndex() >= 0;
+}
+
+
 qreal VectorTab::from() const {
   return _from->text().toDouble();
 }
@@ -243,6 +260,7 @@ void VectorTab::clearTabValues() {
   _from->clear();
   _to->clear();
   _dataRange->clearValues();
+  _storageBox->setCurrentIndex(-1);
 }
 
 
@@ -394,6 +412,7 @@ void VectorDialog::configureTab(ObjectPtr vector) {
     _vectorTab->dataRange()->setSkip(dataVector->skip());
     _vectorTab->dataRange()->setDoSkip(dataVector->doSkip());
     _vectorTab->dataRange()->setDoFilter(dataVector->doAve());
+    _vectorTab->setStorageType(dataVector->storageType());
     _vectorTab->hideGeneratedOptions();
     if (_editMultipleWidget) {
       DataVectorList objects = _document->objectStore()->getObjects<DataVector>();
@@ -476,6 +495,7 @@ ObjectPtr VectorDialog::createNewDataVector() {
 
   vector->setRangeUnits(dataRange->rangeUnits());
   vector->setStartUnits(dataRange->startUnits());
+  vector->setStorageType(_vectorTab->storageType());
 
   if (DataDialog::tagStringAuto()) {
      vector->setDescriptiveName(QString());
@@ -539,6 +559,9 @@ ObjectPtr VectorDialog::editExistingDataObject() const {
           bool doAve = dataRange->doFilterDirty() ?  dataRange->doFilter() : vector->doAve();
           vector->writeLock();
           vector->changeFrames(start, range, skip, doSkip, doAve);
+          if (_vectorTab->storageTypeDirty()) {
+            vector->setStorageType(_vectorTab->storageType());
+          }
           vector->registerChange();
           vector->unlock();
         }
@@ -572,6 +595,7 @@ ObjectPtr VectorDialog::editExistingDataObject() const {
         dataRange->skip(),
         dataRange->doSkip(),
         dataRange->doFilter());
+      dataVector->setStorageType(_vectorTab->storageType());
 
       if (DataDialog::tagStringAuto()) {
         dataVector->setDescriptiveName(QString());
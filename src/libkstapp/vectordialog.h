@@ -23,6 +23,7 @@
 #include "kst_export.h"
 
 #include "datasource.h"
+#include "vector.h"
 
 namespace Kst {
 
@@ -55,6 +56,10 @@ class VectorTab : public DataTab, Ui::VectorTab {
 
     DataRange *dataRange() const;
 
+    Vector::StorageType storageType() const;
+    void setStorageType(Vector::StorageType type);
+    bool storageTypeDirty() const;
+
     //GeneratedVector methods...
     qreal from() const;
     void setFrom(qreal from);
@@ -33,8 +33,10 @@ int VectorModel::columnCount(const QModelIndex&) const {
 }
 
 
+// The view asks from the GUI thread, which may be while the vector is being
+// updated: the snapshot is as of the vector's last update.
 int VectorModel::rowCount(const QModelIndex&) const {
-  return _vector ? _vector->length() : 0;
+  return _vector ? _vector->snapshot()->length() : 0;
 }
 
 
@@ -45,7 +47,10 @@ QVariant VectorModel::data(const QModelIndex& index, int role) const {
         if (index.column() == 0) {
           return QVariant(index.row());
         } else if (index.column() == 1) {
-          return QVariant(_vector->value(index.row()));
+          VectorSnapshotPtr snapshot = _vector->snapshot();
+          if (index.row() < snapshot->length()) {
+            return QVariant(snapshot->value(index.row()));
+          }
         }
         break;
       case Qt::FontRole:
@@ -113,8 +118,13 @@ bool VectorModel::setData(const QModelIndex& index, const QVariant& value, int r
   }
 
   qDebug() << "UGLY!! Add setData API to KstVector!";
+  // locked, as the update thread may be at it; the next update has the
+  // change in the snapshot which data() shows
+  _vector->writeLock();
   double *d = const_cast<double*>(_vector->value());
   d[index.row()] = v;
+  _vector->registerChange();
+  _vector->unlock();
   return true;
 }
 
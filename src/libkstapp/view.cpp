@@ -475,6 +475,12 @@ void View::forceChildResize(QRectF oldRect, QRectF newRect) {
 }
 
 
+void View::paintEvent(QPaintEvent *event) {
+  QGraphicsView::paintEvent(event);
+  emit painted();
+}
+
+
 void View::drawBackground(QPainter *painter, const QRectF &rect) {
   if (isPrinting()) {
     QBrush currentBrush(backgroundBrush());
@@ -133,6 +133,8 @@ class View : public QGraphicsView
     void viewModeChanged(View::ViewMode oldMode);
     void mouseModeChanged(View::MouseMode oldMode);
     void creationPolygonChanged(View::CreationEvent event);
+    /** at the end of each paint of the view */
+    void painted();
 
   public Q_SLOTS:
     void createLayout(bool preserve = true, int columns = 0);
@@ -150,6 +152,7 @@ class View : public QGraphicsView
     bool event(QEvent *event);
     bool eventFilter(QObject *obj, QEvent *event);
     void resizeEvent(QResizeEvent *event=NULL);
+    void paintEvent(QPaintEvent *event);
     void drawBackground(QPainter *painter, const QRectF &rect);
     void addTitle(QMenu *menu) const;
 
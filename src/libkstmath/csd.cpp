@@ -26,6 +26,7 @@
 #include "kst_i18n.h"
 
 #include "dialoglauncher.h"
+#include "bufferstore.h"
 #include "datacollection.h"
 #include "debug.h"
 #include "psdcalculator.h"
@@ -105,7 +106,12 @@ void CSD::internalUpdate() {
   double *tempOutput, *input;
   int tempOutputLen = PSDCalculator::calculateOutputVectorLength(_windowSize, _average, _averageLength);
   _length = tempOutputLen;
-  tempOutput = new double[tempOutputLen];
+  tempOutput = static_cast<double*>(BufferStore::self()->allocate(tempOutputLen*sizeof(double), BufferStore::WorkData));
+  if (!tempOutput) {
+    Debug::self()->log(i18n("Could not allocate sufficient memory for CSD."), Debug::Error);
+    unlockInputsAndOutputs();
+    return;
+  }
 
   input = inVector->value();
 
@@ -134,7 +140,7 @@ void CSD::internalUpdate() {
     xSize++;
   }
 
-  delete[] tempOutput;
+  BufferStore::self()->release(tempOutput);
 
   double frequencyStep = .5*_frequency/(double)(tempOutputLen-1);
 
@@ -32,8 +32,10 @@
 #include "datavector.h"
 #include "ksttimers.h"
 #include "objectstore.h"
+#include "updatemanager.h"
 
 #include <time.h>
+#include <algorithm>
 #include <iostream>
 
 // #define DEBUG_VECTOR_CURVE
@@ -134,6 +136,12 @@ void Curve::internalUpdate() {
 
   NS = qMax(cxV->length(), cyV->length());
 
+  // for drawing curves with many samples to each pixel, and for yRange():
+  // see PixelColumns
+  cyV->minMaxIndex();
+
+  publishPaintData();
+
   unlockInputsAndOutputs();
 
   _redrawRequired = true;
@@ -142,7 +150,74 @@ void Curve::internalUpdate() {
 }
 
 
+static VectorSnapshotPtr snapshotOf(const VectorMap &vectors, const QString &key) {
+  VectorPtr v = vectors.value(key);
+  if (v) {
+    return v->snapshot();
+  }
+  return 0;
+}
+
+
+Curve::PaintData Curve::capturePaintData() const {
+  PaintData data;
+  data.x = snapshotOf(_inputVectors, XVECTOR);
+  data.y = snapshotOf(_inputVectors, YVECTOR);
+  data.ex = snapshotOf(_inputVectors, EXVECTOR);
+  data.ey = snapshotOf(_inputVectors, EYVECTOR);
+  data.exMinus = snapshotOf(_inputVectors, EXMINUSVECTOR);
+  data.eyMinus = snapshotOf(_inputVectors, EYMINUSVECTOR);
+  data.ns = NS;
+  VectorPtr xv = _inputVectors.value(XVECTOR);
+  if (xv) {
+    data.xVector = xv.data();
+    data.xSerial = xv->serialOfLastChange();
+    data.xRewrites = xv->rewrites();
+  }
+  return data;
+}
+
+
+Curve::PaintData Curve::paintData() const {
+  if (UpdateManager::self()->backgroundUpdates()) {
+    QMutexLocker ml(&_paintDataMutex);
+    if (_paintData.x && _paintData.y) {
+      return _paintData;
+    }
+  }
+
+  // not published yet, or updates happen on this thread anyway
+  return capturePaintData();
+}
+
+
+// Called at the end of internalUpdate(), with the inputs still locked.
+void Curve::publishPaintData() {
+  PaintData data;
+  if (UpdateManager::self()->backgroundUpdates()) {
+    data = capturePaintData();
+  }
+
+  QMutexLocker ml(&_paintDataMutex);
+  _paintData = data;
+}
+
+
+// For the GUI thread: see PaintData.  Called once per sample by the likes
+// of PlotMarkers, so with updates on the GUI thread it doesn't bother with
+// snapshots.
 void Curve::point(int i, double &x, double &y) const {
+  if (UpdateManager::self()->backgroundUpdates()) {
+    const PaintData data = paintData();
+    if (data.x) {
+      x = data.x->interpolate(i, data.ns);
+    }
+    if (data.y) {
+      y = data.y->interpolate(i, data.ns);
+    }
+    return;
+  }
+
   VectorPtr xv = xVector();
   if (xv) {
     x = xv->interpolate(i, NS);
@@ -445,7 +520,9 @@ bool Curve::xIsRising() const {
 }
 
 
-inline int indexNearX(double x, VectorPtr& xv, int NS) {
+// works on a VectorPtr or a VectorSnapshotPtr
+template<class V>
+inline int indexNearX(double x, const V& xv, int NS) {
   // monotonically rising: we can do a binary search
   // should be reasonably fast
   if (xv->isRising()) {
@@ -491,48 +568,48 @@ inline int indexNearX(double x, VectorPtr& xv, int NS) {
 
 
 /** getIndexNearXY: return index of point within (or closest too)
-    x +- dx which is closest to y **/
+    x +- dx which is closest to y.  For the GUI thread: see PaintData **/
 int Curve::getIndexNearXY(double x, double dx_per_pix, double y) const {
-  VectorPtr xv = *_inputVectors.find(XVECTOR);
-  VectorPtr yv = *_inputVectors.find(YVECTOR);
-  if (!xv || !yv) {
+  const PaintData data = paintData();
+  const VectorSnapshotPtr &xv = data.x;
+  const VectorSnapshotPtr &yv = data.y;
+  const int ns = data.ns;
+  if (!xv || !yv || ns <= 0) {
     return 0; // anything better we can do?
   }
 
+  if (!xv->isRising()) {
+    return indexNearXYUnordered(data, x, dx_per_pix, y);
+  }
+
   double xi, yi, dx, dxi, dy, dyi;
   bool first = true;
   int i,i0, iN, index;
-  int sc = sampleCount();
 
-  if (xv->isRising()) {
-    iN = i0 = indexNearX(x, xv, NS);
+  iN = i0 = indexNearX(x, xv, ns);
 
-    xi = xv->interpolate(i0, NS);
-    while (i0 > 0 && x-dx_per_pix < xi) {
-      xi = xv->interpolate(--i0, NS);
-    }
+  xi = xv->interpolate(i0, ns);
+  while (i0 > 0 && x-dx_per_pix < xi) {
+    xi = xv->interpolate(--i0, ns);
+  }
 
-    xi = xv->interpolate(iN, NS);
-    while (iN < sc-1 && x+dx_per_pix > xi) {
-      xi = xv->interpolate(++iN, NS);
-    }
-  } else {
-    i0 = 0;
-    iN = sampleCount()-1;
+  xi = xv->interpolate(iN, ns);
+  while (iN < ns-1 && x+dx_per_pix > xi) {
+    xi = xv->interpolate(++iN, ns);
   }
 
   index = i0;
-  xi = xv->interpolate(index, NS);
-  yi = yv->interpolate(index, NS);
+  xi = xv->interpolate(index, ns);
+  yi = yv->interpolate(index, ns);
   dx = fabs(x - xi);
   dy = fabs(y - yi);
 
   for (i = i0 + 1; i <= iN; i++) {
-    xi = xv->interpolate(i, NS);
+    xi = xv->interpolate(i, ns);
     dxi = fabs(x - xi);
     if (dxi < dx_per_pix) {
       dx = dxi;
-      yi = yv->interpolate(i, NS);
+      yi = yv->interpolate(i, ns);
       dyi = fabs(y - yi);
       if (first || dyi < dy) {
         first = false;
@@ -548,6 +625,124 @@ int Curve::getIndexNearXY(double x, double dx_per_pix, double y) const {
 }
 
 
+// samples by x, and by index for the same x
+struct CurveXLessThan {
+  CurveXLessThan(const double *x) : _x(x) {}
+  bool operator()(int a, int b) const {
+    return _x[a] < _x[b] || (_x[a] == _x[b] && a < b);
+  }
+  const double *_x;
+};
+
+
+// With the samples in order of x, those within dx_per_pix of x are next to
+// each other, and found by bisection: of those, the closest in y is the one
+// wanted.  If there are none, the closest in x is one of the two samples
+// either side of where they would be.  Scatter plots of millions of points
+// are then quick enough to follow the mouse, once sorted.
+//
+// When x has only had samples appended since, just those are sorted, and
+// merged in with the rest.
+int Curve::indexNearXYUnordered(const PaintData &data, double x, double dx_per_pix, double y) const {
+  const VectorSnapshotPtr &xv = data.x;
+  const VectorSnapshotPtr &yv = data.y;
+  const int ns = data.ns;
+  QMutexLocker ml(&_xOrderMutex);
+
+  if (_xOrder.vector != data.xVector || _xOrder.serial != data.xSerial ||
+      _xOrder.rewrites != data.xRewrites || _xOrder.ns != ns) {
+    const bool interpolated = !xv->value() || xv->length() != ns;
+    QVector<double> buffer;
+    const double *xs = xv->value();
+    if (interpolated) {
+      buffer.resize(ns);
+      xs = xv->interpolated(0, ns, ns, buffer.data());
+    }
+
+    // Only appended to since it was sorted, as the vector's own count of
+    // rewrites tells: the samples already in order still are.
+    int from = 0;
+    if (_xOrder.vector == data.xVector && _xOrder.rewrites == data.xRewrites &&
+        !_xOrder.interpolated && !interpolated && _xOrder.ns <= ns) {
+      from = _xOrder.ns;
+    }
+
+    QVector<int> added;
+    added.reserve(ns - from);
+    for (int i = from; i < ns; ++i) {
+      if (xs[i] == xs[i]) {
+        added.append(i);
+      }
+    }
+    qSort(added.begin(), added.end(), CurveXLessThan(xs));
+
+    QVector<int> &samples = _xOrder.samples;
+    if (from == 0) {
+      samples = added;
+    } else if (!added.isEmpty()) {
+      QVector<int> merged(samples.size() + added.size());
+      std::merge(samples.constBegin(), samples.constEnd(), added.constBegin(), added.constEnd(),
+                 merged.begin(), CurveXLessThan(xs));
+      samples = merged;
+    }
+
+    _xOrder.vector = data.xVector;
+    _xOrder.serial = data.xSerial;
+    _xOrder.rewrites = data.xRewrites;
+    _xOrder.ns = ns;
+    _xOrder.interpolated = interpolated;
+  }
+
+  const QVector<int> &samples = _xOrder.samples;
+  const int n = samples.size();
+  if (n == 0) {
+    return 0;
+  }
+
+  // the first sample past x - dx_per_pix
+  int lo = 0, hi = n;
+  while (lo < hi) {
+    const int mid = (lo + hi)/2;
+    if (xv->interpolate(samples.at(mid), ns) <= x - dx_per_pix) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  int index = -1;
+  double dy = 0.0;
+  for (int k = lo; k < n; ++k) {
+    const int i = samples.at(k);
+    if (fabs(x - xv->interpolate(i, ns)) >= dx_per_pix) {
+      break;
+    }
+    const double dyi = fabs(y - yv->interpolate(i, ns));
+    if (dyi == dyi && (index < 0 || dyi < dy || (dyi == dy && i < index))) {
+      index = i;
+      dy = dyi;
+    }
+  }
+  if (index >= 0) {
+    return index;
+  }
+
+  if (lo == n) {
+    return samples.at(n - 1);
+  }
+  if (lo == 0) {
+    return samples.at(0);
+  }
+  const int below = samples.at(lo - 1), above = samples.at(lo);
+  const double dxBelow = fabs(x - xv->interpolate(below, ns));
+  const double dxAbove = fabs(x - xv->interpolate(above, ns));
+  if (dxAbove < dxBelow || (dxAbove == dxBelow && above < below)) {
+    return above;
+  }
+  return below;
+}
+
+
 void Curve::setHasPoints(bool in_HasPoints) {
   HasPoints = in_HasPoints;
 }
@@ -737,6 +932,118 @@ void Curve::paintObjects(const CurveRenderContext& context) {
 }
 
 
+// The line drawing in updatePaintObjects() takes each run of samples in
+// the same pixel column down to a vertical line, and only ever uses the
+// first and last sample of the run and the lowest and highest ones.  This
+// hands it just those, finding the ends of each run by bisection and the
+// extremes with the y vector's MinMaxIndex: the lines come out the same as
+// from going through every sample, but the time taken goes with the width
+// of the plot rather than with the number of samples.  Runs with holes in
+// them are still gone through sample by sample.
+//
+// Only for rising x, so that the runs are contiguous.  Runs gone through
+// sample by sample are thinned out by stride, as the drawing is otherwise.
+class PixelColumns {
+  public:
+    PixelColumns(const VectorSnapshot *x, const VectorSnapshot *y, int NS, int iN,
+                 double m_X, double b_X, bool xLog, double xLogBase, int stride)
+      : _x(x), _y(y), _ns(NS), _iN(iN), _m_X(m_X), _b_X(b_X), _xLog(xLog), _xLogBase(xLogBase),
+        _stride(stride), _end(-1), _dense(true), _picks(0) {
+    }
+
+    // exactly as updatePaintObjects() works it out
+    double pixel(int i) const {
+      double rX = _x->interpolate(i, _ns);
+      if (_xLog) {
+        rX = logXLo(rX, _xLogBase);
+      }
+      return _m_X*rX + _b_X;
+    }
+
+    // the next sample after i which the drawing needs
+    int next(int i) {
+      if (i < _end) {
+        if (_dense) {
+          return qMin(i + _stride, _end);
+        }
+        for (int k = 0; k < _picks; ++k) {
+          if (_pick[k] > i) {
+            return _pick[k];
+          }
+        }
+      }
+      return startRun(i + 1);
+    }
+
+  private:
+    enum { MinimumRun = 8 };
+
+    int startRun(int a) {
+      if (a >= _iN) {
+        return _iN;
+      }
+
+      // gallop, then bisect, for the last sample in the same column
+      const double X = pixel(a);
+      int in = a;         // in the column
+      int out = _iN + 1;  // not, or past the end
+      int step = 1;
+      while (in < _iN) {
+        const int j = in + qMin(step, _iN - in);
+        if (!samePixel(pixel(j), X)) {
+          out = j;
+          break;
+        }
+        in = j;
+        if (step <= _iN/2) {
+          step *= 2;
+        }
+      }
+      while (out - in > 1) {
+        const int j = in + (out - in)/2;
+        if (samePixel(pixel(j), X)) {
+          in = j;
+        } else {
+          out = j;
+        }
+      }
+      _end = in;
+
+      int iMin, iMax;
+      bool holes = true;
+      _dense = _end - a < MinimumRun ||
+               !_y->minMaxIndex()->extremes(*_y, a, _end, iMin, iMax, &holes) || holes;
+      if (!_dense) {
+        _picks = 0;
+        addPick(qMin(iMin, iMax));
+        addPick(qMax(iMin, iMax));
+        addPick(_end);
+      }
+      return a;
+    }
+
+    void addPick(int i) {
+      if (_picks == 0 || _pick[_picks - 1] < i) {
+        _pick[_picks++] = i;
+      }
+    }
+
+    const VectorSnapshot *_x;
+    const VectorSnapshot *_y;
+    int _ns;
+    int _iN;
+    double _m_X, _b_X;
+    bool _xLog;
+    double _xLogBase;
+    int _stride;
+
+    int _end;      // last sample of the current run
+    bool _dense;   // go through the run sample by sample
+    int _pick[3];  // or else these, in order, after the first
+    int _picks;
+};
+
+
 void Curve::updatePaintObjects(const CurveRenderContext& context) {
   _polygons.clear();
   _lines.clear();
@@ -744,11 +1051,14 @@ void Curve::updatePaintObjects(const CurveRenderContext& context) {
   _filledRects.clear();
   _rects.clear();
 
-  VectorPtr xv = *_inputVectors.find(XVECTOR);
-  VectorPtr yv = *_inputVectors.find(YVECTOR);
+  // draw from the data as of the last update, even if a new one is under way
+  PaintData data = paintData();
+  VectorSnapshotPtr xv = data.x;
+  VectorSnapshotPtr yv = data.y;
   if (!xv || !yv) {
     return;
   }
+  const int NS = data.ns;
 
   double Lx = context.Lx, Hx = context.Hx, Ly = context.Ly, Hy = context.Hy;
   double m_X = context.m_X, m_Y = context.m_Y;
@@ -781,7 +1091,7 @@ void Curve::updatePaintObjects(const CurveRenderContext& context) {
   //            context.painter->device()->width()/context.painter->device()->logicalDpiX();
 
   double errorFlagDim = pointDim(context.painter->window());
-  if (sampleCount() > 0) {
+  if (NS > 0) {
     int i0, iN;
 
     if (xv->isRising()) {
@@ -790,12 +1100,12 @@ void Curve::updatePaintObjects(const CurveRenderContext& context) {
         --i0;
       }
       iN = indexNearX(XMax, xv, NS);
-      if (iN < sampleCount() - 1) {
+      if (iN < NS - 1) {
         ++iN;
       }
     } else {
       i0 = 0;
-      iN = sampleCount() - 1;
+      iN = NS - 1;
     }
 
 #ifdef BENCHMARK
@@ -844,11 +1154,31 @@ void Curve::updatePaintObjects(const CurveRenderContext& context) {
 
       i_pt = i0;
 
+      // If updates are falling behind, thin out curves which have many
+      // points per pixel anyway.  Enough are kept to find the extremes of
+      // each column approximately.
+      int stride = 1;
+      const int decimation = context.decimation;
+      if (decimation > 0) {
+        const int perPixel = (iN - i0) / qMax(1, int(Hx - Lx));
+        stride = qBound(1, perPixel / 4, 1 << decimation);
+      }
+
+      // With many more samples than pixels, skip those which can't make
+      // any difference.  Very far off screen, int() in samePixel() would
+      // overflow, and columns would stop being contiguous.
+      PixelColumns columns(xv.data(), yv.data(), NS, iN, m_X, b_X, xLog, xLogBase, stride);
+      const MinMaxIndex *minMax = yv->minMaxIndex();
+      const bool byColumn = xv->isRising() && minMax && minMax->size() == NS &&
+                            xv->length() == NS && yv->length() == NS &&
+                            iN - i0 > 8*qMax(1, int(Hx - Lx)) &&
+                            fabs(last_x1) < 1.0E9 && fabs(columns.pixel(iN)) < 1.0E9;
+
       while (i_pt < iN) {
         X2 = last_x1;
         Y2 = last_y1;
 
-        ++i_pt;
+        i_pt = byColumn ? columns.next(i_pt) : qMin(i_pt + stride, iN);
         rX = xv->interpolate(i_pt, NS);
         rY = yv->interpolate(i_pt, NS);
         bool foundNan = false;
@@ -1133,10 +1463,10 @@ qDebug() << "y not in bounds"
     b_1 = benchtmp.elapsed();
 #endif
 
-    VectorPtr exv = _inputVectors.contains(EXVECTOR) ? *_inputVectors.find(EXVECTOR) : 0;
-    VectorPtr eyv = _inputVectors.contains(EYVECTOR) ? *_inputVectors.find(EYVECTOR) : 0;
-    VectorPtr exmv = _inputVectors.contains(EXMINUSVECTOR) ? *_inputVectors.find(EXMINUSVECTOR) : 0;
-    VectorPtr eymv = _inputVectors.contains(EYMINUSVECTOR) ? *_inputVectors.find(EYMINUSVECTOR) : 0;
+    VectorSnapshotPtr exv = data.ex;
+    VectorSnapshotPtr eyv = data.ey;
+    VectorSnapshotPtr exmv = data.exMinus;
+    VectorSnapshotPtr eymv = data.eyMinus;
     // draw the bargraph bars, if any...
     if (hasBars()) {
       bool visible = true;
@@ -1148,7 +1478,7 @@ qDebug() << "y not in bounds"
         // determine the bar position width. NOTE: This is done
         //  only if xv->isRising() as in this case the calculation
         //  is simple...
-        drX = (maxX() - minX())/double(sampleCount());
+        drX = (maxX() - minX())/double(NS);
         if (xv->isRising()) {
           double oldX = 0.0;
 
@@ -1229,25 +1559,32 @@ qDebug() << "y not in bounds"
       QRectF rect(Lx, Ly, w, h);
       QPointF pt, lastPt;
 
-      for (i_pt = i0; i_pt <= iN; ++i_pt) {
-        rX = xv->interpolate(i_pt, NS);
-        rY = yv->interpolate(i_pt, NS);
-        if (xLog) {
-          rX = logXLo(rX, xLogBase);
-        }
-        if (yLog) {
-          rY = logYLo(rY, yLogBase);
-        }
+      const int blockSize = 512;
+      double xBlock[blockSize], yBlock[blockSize];
+      for (int from = i0; from <= iN; from += blockSize) {
+        const int n = qMin(blockSize, iN + 1 - from);
+        const double *xs = xv->interpolated(from, n, NS, xBlock);
+        const double *ys = yv->interpolated(from, n, NS, yBlock);
+        for (int k = 0; k < n; ++k) {
+          rX = xs[k];
+          rY = ys[k];
+          if (xLog) {
+            rX = logXLo(rX, xLogBase);
+          }
+          if (yLog) {
+            rY = logYLo(rY, yLogBase);
+          }
 
-        pt.setX(m_X * rX + b_X);
-        pt.setY(m_Y * rY + b_Y);
-        if (rect.contains(pt) && pt != lastPt &&
-            (lastPt.isNull() || (abs(pt.x() - lastPt.x()) > size) || ((size==0) && (abs(pt.y() - lastPt.y()) > 0)))) {
+          pt.setX(m_X * rX + b_X);
+          pt.setY(m_Y * rY + b_Y);
+          if (rect.contains(pt) && pt != lastPt &&
+              (lastPt.isNull() || (abs(pt.x() - lastPt.x()) > size) || ((size==0) && (abs(pt.y() - lastPt.y()) > 0)))) {
 #ifdef BENCHMARK
-          ++numberOfPointsDrawn;
+            ++numberOfPointsDrawn;
 #endif
-            lastPt = pt;
-            _points.append(pt);
+              lastPt = pt;
+              _points.append(pt);
+          }
         }
       }
     }
@@ -1289,7 +1626,7 @@ qDebug() << "y not in bounds"
       bool errorSame = false;
 
       if (exv && exmv) {
-        if (exv->shortName() == exmv->shortName()) {
+        if (exv->data() == exmv->data()) {
           errorSame = true;
         }
       }
@@ -1379,7 +1716,7 @@ qDebug() << "y not in bounds"
       bool errorSame = false;
 
       if (eyv && eymv) {
-        if (eyv->shortName() == eymv->shortName()) {
+        if (eyv->data() == eymv->data()) {
           errorSame = true;
         }
       }
@@ -1459,7 +1796,7 @@ qDebug() << "y not in bounds"
         }
       }
     } // end if (hasYError())
-  } // end if (sampleCount() > 0)
+  } // end if (NS > 0)
 
 #ifdef BENCHMARK
   b_4 = benchtmp.elapsed();
@@ -1490,38 +1827,62 @@ void Curve::yRange(double xFrom, double xTo, double* yMin, double* yMax) {
     return;
   }
 
-  VectorPtr xv = *_inputVectors.find(XVECTOR);
-  VectorPtr yv = *_inputVectors.find(YVECTOR);
+  PaintData data = paintData();
+  VectorSnapshotPtr xv = data.x;
+  VectorSnapshotPtr yv = data.y;
   if (!xv || !yv) {
     *yMin = *yMax = 0;
     return;
   }
+  const int NS = data.ns;
 
   // get range of the curve to search for min/max
   int i0, iN;
   if (xv->isRising()) {
     i0 = indexNearX(xFrom, xv, NS);
     iN = indexNearX(xTo, xv, NS);
+
+    // The samples in range are all in one run, which is i0 to iN give or
+    // take the ends: the y vector's MinMaxIndex has their extremes without
+    // going through them.  That leaves out anything which isn't finite.
+    const MinMaxIndex *minMax = yv->minMaxIndex();
+    if (minMax && minMax->size() == NS && xv->length() == NS && yv->length() == NS) {
+      const int from = (xv->value(i0) < xFrom) ? i0 + 1 : i0;
+      const int to = (xv->value(iN) > xTo) ? iN - 1 : iN;
+      int iMin, iMax;
+      if (from <= to && minMax->extremes(*yv, from, to, iMin, iMax)) {
+        *yMin = yv->value(iMin);
+        *yMax = yv->value(iMax);
+        return;
+      }
+    }
   } else {
     i0 = 0;
-    iN = sampleCount() - 1;
+    iN = NS - 1;
   }
   // search for min/max
   bool first = true;
   double newYMax = 0, newYMin = 0;
-  for (int i_pt = i0; i_pt <= iN; i_pt++) {
-    double rX = xv->interpolate(i_pt, NS);
-    double rY = yv->interpolate(i_pt, NS);
-    // make sure this point is visible
-    if (rX >= xFrom && rX <= xTo) {
-      // update min/max
-      if (first || rY > newYMax) {
-        newYMax = rY;
-      }
-      if (first || rY < newYMin) {
-        newYMin = rY;
+  const int blockSize = 512;
+  double xBlock[blockSize], yBlock[blockSize];
+  for (int from = i0; from <= iN; from += blockSize) {
+    const int n = qMin(blockSize, iN + 1 - from);
+    const double *xs = xv->interpolated(from, n, NS, xBlock);
+    const double *ys = yv->interpolated(from, n, NS, yBlock);
+    for (int k = 0; k < n; ++k) {
+      double rX = xs[k];
+      double rY = ys[k];
+      // make sure this point is visible
+      if (rX >= xFrom && rX <= xTo) {
+        // update min/max
+        if (first || rY > newYMax) {
+          newYMax = rY;
+        }
+        if (first || rY < newYMin) {
+          newYMin = rY;
+        }
+        first = false;
       }
-      first = false;
     }
   }
   *yMin = newYMin;
@@ -1531,7 +1892,10 @@ void Curve::yRange(double xFrom, double xTo, double* yMin, double* yMax) {
 
 double Curve::distanceToPoint(double xpos, double dx, double ypos) const {
 // find the y distance between the curve and a point. return 1.0E300 if this distance is undefined. i don't want to use -1 because it will make the code which uses this function messy.
-  VectorPtr xv = *_inputVectors.find(XVECTOR);
+// For the GUI thread: see PaintData.
+  const PaintData data = paintData();
+  const VectorSnapshotPtr &xv = data.x;
+  const int ns = data.ns;
   if (!xv) {
     return 1.0E300; // anything better we can do?
   }
@@ -1551,13 +1915,13 @@ double Curve::distanceToPoint(double xpos, double dx, double ypos) const {
     //  the point. if isRising because it is (probably) to slow to use this technique if the data is 
     //  unordered. borrowed from indexNearX. use binary search to find the indices immediately above 
     //  and below our xpos.
-    int i_top = NS - 1;
+    int i_top = ns - 1;
     int i_bot = 0;
 
     while (i_bot + 1 < i_top) {
       int i0 = (i_top + i_bot)/2;
 
-      double rX = xv->interpolate(i0, NS);
+      double rX = xv->interpolate(i0, ns);
       if (xpos < rX) {
         i_top = i0;
       } else {
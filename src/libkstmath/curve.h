@@ -23,7 +23,9 @@
 #include "curvepointsymbol.h"
 #include "kstmath_export.h"
 #include "labelinfo.h"
+#include "vectorsnapshot.h"
 
+#include <QMutex>
 #include <QStack>
 
 /**A class for handling curves for kst
@@ -215,6 +217,42 @@ class KSTMATH_EXPORT Curve: public Relation
     bool _head_valid;
 
     int _width;
+
+    // What the curve is drawn from.  With background updates this is
+    // captured at the end of each update, so painting never has to touch
+    // a vector which the update thread may be changing.  Anything else
+    // done on the GUI thread, such as finding the point under the mouse,
+    // works from it too.
+    struct PaintData {
+      PaintData() : ns(0), xVector(0), xSerial(0), xRewrites(0) {}
+      VectorSnapshotPtr x, y, ex, ey, exMinus, eyMinus;
+      int ns;
+      const Vector *xVector;
+      qint64 xSerial;       // the x vector's serialOfLastChange() as of x
+      int xRewrites;        // and its rewrites()
+    };
+    PaintData capturePaintData() const;
+    PaintData paintData() const;
+    void publishPaintData();
+
+    mutable QMutex _paintDataMutex;
+    PaintData _paintData;
+
+    // The samples in order of x, for getIndexNearXY() when x isn't rising:
+    // sorted when first needed, and again once the x vector has changed.
+    struct XOrder {
+      XOrder() : vector(0), serial(0), rewrites(0), ns(0), interpolated(false) {}
+      QVector<int> samples; // those with a finite x
+      const Vector *vector;
+      qint64 serial;        // the vector's serialOfLastChange()
+      int rewrites;         // and its rewrites(), to tell appends from changes
+      int ns;
+      bool interpolated;    // x was stretched to ns, so appends move it all
+    };
+    int indexNearXYUnordered(const PaintData &data, double x, double dx_per_pix, double y) const;
+
+    mutable QMutex _xOrderMutex;
+    mutable XOrder _xOrder;
 };
 
 typedef SharedPtr<Curve> CurvePtr;
@@ -108,6 +108,17 @@ void DataObject::replaceInput(PrimitivePtr p, PrimitivePtr new_p) {
   }
 }
 
+QList<ObjectPtr> DataObject::inputObjects() const {
+  QList<ObjectPtr> inputs;
+  foreach (PrimitivePtr p, inputPrimitives()) {
+    if (p) {
+      inputs.append(ObjectPtr(p.data()));
+    }
+  }
+  return inputs;
+}
+
+
 PrimitiveList DataObject::inputPrimitives() const {
   PrimitiveList primitive_list;
 
@@ -97,6 +97,7 @@ class KSTMATH_EXPORT DataObject : public Object
     MatrixMap& outputMatrices() { return _outputMatrices; }
 
     virtual PrimitiveList inputPrimitives() const;
+    virtual QList<ObjectPtr> inputObjects() const;
     PrimitiveList outputPrimitives(bool include_descendants = true) const;
 
     virtual void load(const QXmlStreamReader& s);
@@ -416,11 +416,17 @@ bool Equation::FillY(bool force) {
       i0 = 0;
       v_shift = _ns;
     } else {
+      // the outputs scroll along with the input
       VectorPtr xv = _xOutVector;
       VectorPtr yv = _yOutVector;
-      for (int i = v_shift; i < _ns; i++) {
-        yv->value()[i - v_shift] = yv->value()[i];
-        xv->value()[i - v_shift] = xv->value()[i];
+      xv->setScrolling(_xInVector->scrolling());
+      yv->setScrolling(_xInVector->scrolling());
+      xv->shift(v_shift);
+      yv->shift(v_shift);
+      if (!xv->resize(_ns) || !yv->resize(_ns)) {
+        // FIXME: handle error?
+        unlockInputsAndOutputs();
+        return false;
       }
       i0 = _ns - v_shift;
     }
@@ -472,10 +478,17 @@ bool Equation::FillY(bool force) {
     }
   }
 
-  for (ctx.i = i0; ctx.i < _ns; ++ctx.i) {
-    rawxv[ctx.i] = iv->value(ctx.i);
-    ctx.x = iv->interpolate(ctx.i, _ns);
-    rawyv[ctx.i] = _pe->value(&ctx);
+  const int blockSize = 512;
+  double block[blockSize];
+  for (int from = i0; from < _ns; from += blockSize) {
+    const int n = qMin(blockSize, _ns - from);
+    const double *x = iv->interpolated(from, n, _ns, block);
+    for (int k = 0; k < n; ++k) {
+      ctx.i = from + k;
+      rawxv[ctx.i] = iv->value(ctx.i);
+      ctx.x = x[k];
+      rawyv[ctx.i] = _pe->value(&ctx);
+    }
   }
 
   if (!_xOutVector->resize(iv->length())) {
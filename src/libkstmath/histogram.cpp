@@ -141,17 +141,24 @@ void Histogram::internalUpdate() {
 
   memset(_Bins, 0, _NumberOfBins*sizeof(*_Bins));
 
-  ns = _inputVectors[RAWVECTOR]->length();
-  for (i_pt = 0; i_pt < ns ; ++i_pt) {
-    y = _inputVectors[RAWVECTOR]->interpolate(i_pt, ns);
-    i_bin = (int)floor((y-_MinX)/_W);
-    if (i_bin >= 0 && i_bin < _NumberOfBins) {
-      _Bins[i_bin]++;
-    } else {
-      // the top boundary of the top bin is included in the top bin.
-      // for all other bins, the top boundary is included in the next bin
-      if (y == _MaxX) {
-        _Bins[_NumberOfBins-1]++;
+  VectorPtr raw = _inputVectors[RAWVECTOR];
+  ns = raw->length();
+  const int blockSize = 512;
+  double block[blockSize];
+  for (int from = 0; from < ns; from += blockSize) {
+    const int n = qMin(blockSize, ns - from);
+    const double *samples = raw->interpolated(from, n, ns, block);
+    for (i_pt = 0; i_pt < n; ++i_pt) {
+      y = samples[i_pt];
+      i_bin = (int)floor((y-_MinX)/_W);
+      if (i_bin >= 0 && i_bin < _NumberOfBins) {
+        _Bins[i_bin]++;
+      } else {
+        // the top boundary of the top bin is included in the top bin.
+        // for all other bins, the top boundary is included in the next bin
+        if (y == _MaxX) {
+          _Bins[_NumberOfBins-1]++;
+        }
       }
     }
   }
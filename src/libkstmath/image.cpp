@@ -449,6 +449,11 @@ void Image::updatePaintObjects(const CurveRenderContext& context) {
   _lines.clear();
 
   if (_inputMatrices.contains(THEMATRIX)) { // don't paint if we have no matrix
+    // there are no matrix snapshots: with background updates, wait for the
+    // update thread to be done with the matrix.
+    MatrixPtr paintMatrix = _inputMatrices.value(THEMATRIX);
+    paintMatrix->readLock();
+
     image->matrixDimensions(x, y, width, height);
 
     // figure out where the image will be on the plot
@@ -720,6 +725,8 @@ void Image::updatePaintObjects(const CurveRenderContext& context) {
         }
       }
     }
+
+    paintMatrix->unlock();
   }
 #ifdef BENCHMARK
   b_2 = benchtmp.elapsed();
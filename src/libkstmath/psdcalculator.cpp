@@ -24,6 +24,7 @@
 
 #include "kst_i18n.h"
 
+#include "bufferstore.h"
 #include "debug.h"
 #include "vector.h"
 
@@ -54,9 +55,9 @@ PSDCalculator::PSDCalculator()
 
 
 PSDCalculator::~PSDCalculator() {
-  delete[] _w;
+  Kst::BufferStore::self()->release(_w);
   _w = 0L;
-  delete[] _a;
+  Kst::BufferStore::self()->release(_a);
   _a = 0L;
 }
 
@@ -170,15 +171,16 @@ int PSDCalculator::calculatePowerSpectrum(
   }
 
   if (outputLen != _prevOutputLen) {
-    delete[] _a;
-    delete[] _w;
+    if (!Kst::BufferStore::self()->resize(_a, outputLen*2*sizeof(double), Kst::BufferStore::WorkData) ||
+        !Kst::BufferStore::self()->resize(_w, outputLen*2*sizeof(double), Kst::BufferStore::WorkData)) {
+      Kst::Debug::self()->log(i18n("in PSDCalculator::calculatePowerSpectrum: could not allocate the work buffers."), Kst::Debug::Error);
+      _prevOutputLen = 0;
+      return -1;
+    }
 
     _awLen = outputLen*2;
     _prevOutputLen = outputLen;
 
-    _a = new double[_awLen];
-    _w = new double[_awLen];
-
     updateWindowFxn(apodizeFxn, gaussianSigma);
   }
 
@@ -57,6 +57,7 @@ void Relation::commonConstructor() {
   _contextDetails.xLogBase = 0.0;
   _contextDetails.yLogBase = 0.0;
   _contextDetails.penWidth = 0;
+  _contextDetails.decimation = 0;
 }
 
 
@@ -99,7 +100,8 @@ bool Relation::redrawRequired(const CurveRenderContext& context) {
       (_contextDetails.yLog == context.yLog) &&  
       (_contextDetails.xLogBase == context.xLogBase) &&  
       (_contextDetails.yLogBase == context.yLogBase) &&  
-      (_contextDetails.penWidth == context.penWidth) ) {
+      (_contextDetails.penWidth == context.penWidth) &&
+      (_contextDetails.decimation == context.decimation) ) {
     return false;
   } else {
     _contextDetails.Lx = context.Lx;
@@ -117,6 +119,7 @@ bool Relation::redrawRequired(const CurveRenderContext& context) {
     _contextDetails.xLogBase = context.xLogBase;
     _contextDetails.yLogBase = context.yLogBase;
     _contextDetails.penWidth = context.penWidth;
+    _contextDetails.decimation = context.decimation;
     return true;
   }
 }
@@ -438,6 +441,17 @@ bool Relation::uses(ObjectPtr p) const {
 }
 
 
+QList<ObjectPtr> Relation::inputObjects() const {
+  QList<ObjectPtr> inputs;
+  foreach (PrimitivePtr p, inputPrimitives()) {
+    if (p) {
+      inputs.append(ObjectPtr(p.data()));
+    }
+  }
+  return inputs;
+}
+
+
 PrimitiveList Relation::inputPrimitives() const {
   PrimitiveList primitive_list;
 
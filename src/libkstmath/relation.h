@@ -43,7 +43,7 @@ class CurveRenderContext {
                               x_max(0.0), y_max(0.0), x_min(0.0), y_min(0.0),
                               XMin(0.0), YMin(0.0), XMax(0.0), YMax(0.0),
                               xLog(false), yLog(false), xLogBase(0.0),
-                              yLogBase(0.0), penWidth(0), antialias(false)
+                              yLogBase(0.0), penWidth(0), antialias(false), decimation(0)
     {}
 
     QPainter* painter;
@@ -58,6 +58,7 @@ class CurveRenderContext {
     QColor backgroundColor; // plot background color
     int penWidth;
     bool antialias;
+    int decimation; // UpdateManager::decimation() to draw with
 };
 
   struct CurveContextDetails {
@@ -68,6 +69,7 @@ class CurveRenderContext {
     bool xLog, yLog;
     double xLogBase, yLogBase;
     int penWidth;
+    int decimation;
   };
 
 class ObjectStore;
@@ -160,6 +162,7 @@ class KSTMATH_EXPORT Relation : public Object {
     MatrixMap& outputMatrices() { return _outputMatrices; }
 
     PrimitiveList inputPrimitives() const;
+    virtual QList<ObjectPtr> inputObjects() const;
 
     virtual bool invertXHint() const {return false;}
     virtual bool invertYHint() const {return false;}
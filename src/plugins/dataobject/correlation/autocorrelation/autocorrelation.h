@@ -55,7 +55,7 @@ class AutoCorrelationSource : public Kst::BasicPlugin {
 class AutoCorrelationPlugin : public QObject, public Kst::DataObjectPluginInterface {
     Q_OBJECT
     Q_INTERFACES(Kst::DataObjectPluginInterface)
-    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.0")
+    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.1")
   public:
     virtual ~AutoCorrelationPlugin() {}
 
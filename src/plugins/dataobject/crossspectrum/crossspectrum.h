@@ -58,7 +58,7 @@ class CrossSpectrumSource : public Kst::BasicPlugin {
 class CrossSpectrumPlugin : public QObject, public Kst::DataObjectPluginInterface {
     Q_OBJECT
     Q_INTERFACES(Kst::DataObjectPluginInterface)
-    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.0")
+    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.1")
   public:
     virtual ~CrossSpectrumPlugin() {}
 
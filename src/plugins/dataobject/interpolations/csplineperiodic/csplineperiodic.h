@@ -57,7 +57,7 @@ class CubicSplinePeriodicSource : public Kst::BasicPlugin {
 class CubicSplinePeriodicPlugin : public QObject, public Kst::DataObjectPluginInterface {
     Q_OBJECT
     Q_INTERFACES(Kst::DataObjectPluginInterface)
-    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.0")
+    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.1")
   public:
     virtual ~CubicSplinePeriodicPlugin() {}
 
@@ -56,7 +56,7 @@ class NoiseAdditionSource : public Kst::BasicPlugin {
 class NoiseAdditionPlugin : public QObject, public Kst::DataObjectPluginInterface {
     Q_OBJECT
     Q_INTERFACES(Kst::DataObjectPluginInterface)
-    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.0")
+    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.1")
   public:
     virtual ~NoiseAdditionPlugin() {}
 
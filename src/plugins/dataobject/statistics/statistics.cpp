@@ -15,6 +15,8 @@
 
 #include "statistics.h"
 #include "objectstore.h"
+#include "math_kst.h"
+#include "statistics_kst.h"
 #include "ui_statisticsconfig.h"
 
 static const QString& VECTOR_IN = "Vector In";
@@ -163,19 +165,23 @@ bool StatisticsSource::algorithm() {
   double dAbsoluteDeviation = 0.0;
   double dSkewness = 0.0;
   double dKurtosis = 0.0;
-  int iLength = inputVector->length();
-
-  for (int i=0; i<iLength; i++) {
-    if (i == 0 || inputVector->value()[i] < dMinimum) {
-      dMinimum = inputVector->value()[i];
-    }
-    if (i == 0 || inputVector->value()[i] > dMaximum) {
-      dMaximum = inputVector->value()[i];
-    }
-    dTotal += inputVector->value()[i];
-    dSquaredTotal += inputVector->value()[i] * inputVector->value()[i];
+  int iSamples = inputVector->length();
+  const double *pData = inputVector->value();
+
+  // NaNs (missing samples) and infinities are left out.
+  Kst::RunningStatistics stats;
+  stats.add(pData, iSamples);
+  if (stats.n < 1) {
+    _errorString = "Error:  Input Vector has no finite values";
+    return false;
   }
 
+  int iLength = stats.n;
+  dTotal = stats.sum;
+  dSquaredTotal = stats.sum2;
+  dMinimum = stats.min;
+  dMaximum = stats.max;
+
   dMean = dTotal / (double)iLength;
   if (iLength > 1) {
     dVariance  = 1.0 / ( (double)iLength - 1.0 );
@@ -188,10 +194,13 @@ bool StatisticsSource::algorithm() {
     }
   }
 
-  for (int i=0; i<iLength; i++) {
-    dAbsoluteDeviation += fabs( inputVector->value()[i] - dMean );
-    dSkewness               += pow( inputVector->value()[i] - dMean, 3.0 );
-    dKurtosis               += pow( inputVector->value()[i] - dMean, 4.0 );
+  for (int i=0; i<iSamples; i++) {
+    if (!isfinite(pData[i])) {
+      continue;
+    }
+    dAbsoluteDeviation += fabs( pData[i] - dMean );
+    dSkewness               += pow( pData[i] - dMean, 3.0 );
+    dKurtosis               += pow( pData[i] - dMean, 4.0 );
   }
   dAbsoluteDeviation /= (double)iLength;
   dSkewness                 /= (double)iLength * pow( dStandardDeviation, 3.0 );
@@ -203,7 +212,12 @@ bool StatisticsSource::algorithm() {
   */
   pCopy = (double*)calloc( iLength, sizeof( double ) );
   if (pCopy != NULL) {
-    memcpy( pCopy, inputVector->value(), iLength * sizeof( double ) );
+    int iCopied = 0;
+    for (int i=0; i<iSamples; i++) {
+      if (isfinite(pData[i])) {
+        pCopy[iCopied++] = pData[i];
+      }
+    }
     quicksort( pCopy, 0, iLength-1 );
     dMedian = pCopy[ iLength / 2 ];
 
@@ -57,7 +57,7 @@ class FilterButterworthHighPassSource : public Kst::BasicPlugin {
 class ButterworthHighPassPlugin : public QObject, public Kst::DataObjectPluginInterface {
     Q_OBJECT
     Q_INTERFACES(Kst::DataObjectPluginInterface)
-    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.0")
+    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.1")
   public:
     virtual ~ButterworthHighPassPlugin() {}
 
@@ -57,7 +57,7 @@ class CumulativeAverageSource : public Kst::BasicPlugin {
 class CumulativeAveragePlugin : public QObject, public Kst::DataObjectPluginInterface {
     Q_OBJECT
     Q_INTERFACES(Kst::DataObjectPluginInterface)
-    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.0")
+    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.1")
   public:
     virtual ~CumulativeAveragePlugin() {}
 
@@ -58,7 +58,6 @@ bool precursor( Kst::VectorPtr xVector, Kst::VectorPtr yVector, Kst::VectorPtr w
 
   bool bRetVal = false;
   int  iNumCovar = ( iNumParams * ( iNumParams + 1 ) ) / 2;
-  int  i;
 
   pInputs[XVALUES] = 0L;
   pInputs[YVALUES] = 0L;
@@ -78,38 +77,14 @@ bool precursor( Kst::VectorPtr xVector, Kst::VectorPtr yVector, Kst::VectorPtr w
     // do any necessary interpolations...
     //
         pInputs[XVALUES] = (double*)malloc(*piLength * sizeof( double ));
-        if (xVector->length() == *piLength) {
-          for( i=0; i<*piLength; i++) {
-            pInputs[XVALUES][i] = xVector->value()[i];
-          }
-        } else {
-          for( i=0; i<*piLength; i++) {
-            pInputs[XVALUES][i] = interpolate( i, *piLength, xVector->value(), xVector->length() );
-          }
-        }
+        xVector->interpolate(0, *piLength, *piLength, pInputs[XVALUES]);
 
         pInputs[YVALUES] = (double*)malloc(*piLength * sizeof( double ));
-        if (yVector->length() == *piLength) {
-          for( i=0; i<*piLength; i++) {
-            pInputs[YVALUES][i] = yVector->value()[i];
-          }
-        } else {
-          for( i=0; i<*piLength; i++) {
-            pInputs[YVALUES][i] = interpolate( i, *piLength, yVector->value(), yVector->length() );
-          }
-        }
+        yVector->interpolate(0, *piLength, *piLength, pInputs[YVALUES]);
 
         if (bWeighted) {
           pInputs[WEIGHTS] = (double*)malloc(*piLength * sizeof( double ));
-          if (weightsVector->length() == *piLength) {
-            for( i=0; i<*piLength; i++) {
-              pInputs[WEIGHTS][i] = weightsVector->value()[i];
-            }
-          } else {
-            for( i=0; i<*piLength; i++) {
-              pInputs[WEIGHTS][i] = interpolate( i, *piLength, weightsVector->value(), weightsVector->length() );
-            }
-          }
+          weightsVector->interpolate(0, *piLength, *piLength, pInputs[WEIGHTS]);
         }
 
     if( *piLength > iNumParams + 1 ) {
@@ -58,7 +58,7 @@ class FitExponentialUnweightedSource : public Kst::BasicPlugin {
 class FitExponentialUnweightedPlugin : public QObject, public Kst::DataObjectPluginInterface {
     Q_OBJECT
     Q_INTERFACES(Kst::DataObjectPluginInterface)
-    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.0")
+    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.1")
   public:
     virtual ~FitExponentialUnweightedPlugin() {}
 
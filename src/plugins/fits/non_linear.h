@@ -119,26 +119,10 @@ bool kstfit_nonlinear(
     }
 
     pInputX = (double*)malloc(iLength * sizeof( double ));
-    if (xVector->length() == iLength) {
-      for( i=0; i<iLength; i++) {
-        pInputX[i] = xVector->value()[i];
-      }
-    } else {
-      for( i=0; i<iLength; i++) {
-        pInputX[i] = interpolate( i, iLength, xVector->value(), xVector->length() );
-      }
-    }
+    xVector->interpolate(0, iLength, iLength, pInputX);
 
     pInputY = (double*)malloc(iLength * sizeof( double ));
-    if (yVector->length() == iLength) {
-      for( i=0; i<iLength; i++) {
-        pInputY[i] = yVector->value()[i];
-      }
-    } else {
-      for( i=0; i<iLength; i++) {
-        pInputY[i] = interpolate( i, iLength, yVector->value(), yVector->length() );
-      }
-    }
+    yVector->interpolate(0, iLength, iLength, pInputY);
 
     if( iLength > NUM_PARAMS ) {
       vectorOutYFitted->resize(iLength);
@@ -121,37 +121,13 @@ bool kstfit_nonlinear_weighted(
 
     // do any necessary interpolation...
     pInputs[XVALUES] = (double*)malloc(iLength * sizeof( double ));
-    if (xVector->length() == iLength) {
-      for( i=0; i<iLength; i++) {
-        pInputs[XVALUES][i] = xVector->value()[i];
-      }
-    } else {
-      for( i=0; i<iLength; i++) {
-        pInputs[XVALUES][i] = interpolate( i, iLength, xVector->value(), xVector->length() );
-      }
-    }
+    xVector->interpolate(0, iLength, iLength, pInputs[XVALUES]);
 
     pInputs[YVALUES] = (double*)malloc(iLength * sizeof( double ));
-    if (yVector->length() == iLength) {
-      for( i=0; i<iLength; i++) {
-        pInputs[YVALUES][i] = yVector->value()[i];
-      }
-    } else {
-      for( i=0; i<iLength; i++) {
-        pInputs[YVALUES][i] = interpolate( i, iLength, yVector->value(), yVector->length() );
-      }
-    }
+    yVector->interpolate(0, iLength, iLength, pInputs[YVALUES]);
 
     pInputs[WEIGHTS] = (double*)malloc(iLength * sizeof( double ));
-    if (weightsVector->length() == iLength) {
-      for( i=0; i<iLength; i++) {
-        pInputs[WEIGHTS][i] = weightsVector->value()[i];
-      }
-    } else {
-      for( i=0; i<iLength; i++) {
-        pInputs[WEIGHTS][i] = interpolate( i, iLength, weightsVector->value(), weightsVector->length() );
-      }
-    }
+    weightsVector->interpolate(0, iLength, iLength, pInputs[WEIGHTS]);
 
     if( iLength > NUM_PARAMS ) {
       vectorOutYFitted->resize(iLength);
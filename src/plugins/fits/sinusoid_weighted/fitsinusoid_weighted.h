@@ -61,7 +61,7 @@ class FitSinusoidWeightedSource : public Kst::BasicPlugin {
 class FitSinusoidWeightedPlugin : public QObject, public Kst::DataObjectPluginInterface {
     Q_OBJECT
     Q_INTERFACES(Kst::DataObjectPluginInterface)
-    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.0")
+    Q_PLUGIN_METADATA(IID "com.kst.DataObjectPluginInterface/2.1")
   public:
     virtual ~FitSinusoidWeightedPlugin() {}
 
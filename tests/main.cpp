@@ -26,6 +26,8 @@
 #include "testlabelparser.h"
 #include "testeqparser.h"
 #include "testobjectstore.h"
+#include "testsharedptr.h"
+#include "testcurve.h"
 
 int main(int argc, char *argv[]) {
   QCoreApplication app(argc, argv);
@@ -69,6 +71,12 @@ int main(int argc, char *argv[]) {
   TestObjectStore test11;
   QTest::qExec(&test11, argc, argv);
 
+  TestSharedPtr test12;
+  QTest::qExec(&test12, argc, argv);
+
+  TestCurve test13;
+  QTest::qExec(&test13, argc, argv);
+
   return 0;
 }
 
@@ -0,0 +1,205 @@
+/***************************************************************************
+ *                                                                         *
+ *   copyright : (C) 2012 The University of Toronto                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "testcurve.h"
+
+#include <QtTest>
+
+#include <math.h>
+
+#include <curve.h>
+#include <objectstore.h>
+#include <vector.h>
+
+#include "ksttest.h"
+
+static Kst::ObjectStore _store;
+
+// a vector which says how much of it is as it was, as a DataVector does
+class AppendingVector : public Kst::Vector {
+  public:
+    AppendingVector(Kst::ObjectStore *store) : Kst::Vector(store) {}
+
+    void keep(int samples) { _unchangedSamples = samples; }
+};
+
+void TestCurve::cleanupTestCase() {
+  _store.clear();
+}
+
+
+// scattered samples, with repeats and holes
+static void fill(Kst::VectorPtr v, int from, int to, int seed) {
+  double *data = v->value();
+  for (int i = from; i < to; ++i) {
+    data[i] = ((i * 7919 + seed) % 1009) / 10.0;
+    if ((i + seed) % 97 == 0) {
+      data[i] = NAN;
+    }
+  }
+}
+
+
+static void update(Kst::CurvePtr c) {
+  c->writeLock();
+  c->xVector()->writeLock();
+  c->xVector()->internalUpdate();
+  c->xVector()->unlock();
+  c->yVector()->writeLock();
+  c->yVector()->internalUpdate();
+  c->yVector()->unlock();
+  c->internalUpdate();
+  c->unlock();
+}
+
+
+// getIndexNearXY() with x in order of x must find a sample as good as the
+// one going through them all does: the closest in y of those within dx of
+// x, or else the closest in x.
+static void compareNearest(Kst::CurvePtr c) {
+  const double *x = c->xVector()->value();
+  const double *y = c->yVector()->value();
+  const int n = c->xVector()->length();
+  const double dxs[] = {0.05, 0.5, 3.0};
+
+  for (unsigned k = 0; k < sizeof(dxs)/sizeof(dxs[0]); ++k) {
+    for (double px = -2.0; px < 104.0; px += 1.37) {
+      const double py = fmod(px * 3.1, 100.0);
+      const double dx = dxs[k];
+
+      int best = -1;
+      double bestDy = 0.0;
+      int nearest = -1;
+      double nearestDx = 0.0;
+      for (int i = 0; i < n; ++i) {
+        const double dxi = fabs(px - x[i]);
+        if (dxi != dxi) {
+          continue;
+        }
+        if (nearest < 0 || dxi < nearestDx) {
+          nearest = i;
+          nearestDx = dxi;
+        }
+        const double dyi = fabs(py - y[i]);
+        if (dxi < dx && dyi == dyi && (best < 0 || dyi < bestDy)) {
+          best = i;
+          bestDy = dyi;
+        }
+      }
+
+      const int found = c->getIndexNearXY(px, dx, py);
+      QVERIFY(found >= 0 && found < n);
+      if (best >= 0) {
+        QVERIFY(fabs(px - x[found]) < dx);
+        QCOMPARE(fabs(py - y[found]), bestDy);
+      } else {
+        QCOMPARE(fabs(px - x[found]), nearestDx);
+      }
+    }
+  }
+}
+
+
+void TestCurve::testIndexNearXYUnordered() {
+  Kst::SharedPtr<AppendingVector> x = _store.createObject<AppendingVector>();
+  Kst::VectorPtr y = Kst::kst_cast<Kst::Vector>(_store.createObject<Kst::Vector>());
+  x->resize(2000);
+  y->resize(2000);
+  fill(x, 0, 2000, 0);
+  fill(y, 0, 2000, 11);
+
+  Kst::CurvePtr c = Kst::kst_cast<Kst::Curve>(_store.createObject<Kst::Curve>());
+  c->setXVector(x);
+  c->setYVector(y);
+  update(c);
+  QVERIFY(!c->xIsRising());
+  compareNearest(c);
+
+  const int rewrites = x->rewrites();
+
+  // samples appended to x are merged in with those already in order
+  x->resize(3000);
+  y->resize(3000);
+  fill(x, 2000, 3000, 0);
+  fill(y, 2000, 3000, 11);
+  x->keep(2000);
+  update(c);
+  QCOMPARE(x->rewrites(), rewrites);
+  compareNearest(c);
+
+  // anything else means starting again
+  x->resize(2500);
+  y->resize(2500);
+  fill(x, 0, 2500, 5);
+  update(c);
+  QCOMPARE(x->rewrites(), rewrites + 1);
+  compareNearest(c);
+}
+
+
+// yRange() with rising x takes the extremes from the y vector's MinMaxIndex,
+// which leaves out anything which isn't finite; a range with nothing finite
+// in it is left to going through the samples.
+void TestCurve::testYRange() {
+  Kst::VectorPtr x = Kst::kst_cast<Kst::Vector>(_store.createObject<Kst::Vector>());
+  Kst::VectorPtr y = Kst::kst_cast<Kst::Vector>(_store.createObject<Kst::Vector>());
+  x->resize(5000);
+  y->resize(5000);
+  double *xs = x->value();
+  for (int i = 0; i < 5000; ++i) {
+    xs[i] = 0.5 * i;
+  }
+  fill(y, 0, 5000, 3);
+  double *ys = y->value();
+  for (int i = 1000; i < 1400; ++i) {
+    ys[i] = NAN;
+  }
+
+  Kst::CurvePtr c = Kst::kst_cast<Kst::Curve>(_store.createObject<Kst::Curve>());
+  c->setXVector(x);
+  c->setYVector(y);
+  update(c);
+  QVERIFY(c->xIsRising());
+  QVERIFY(y->minMaxIndex());
+
+  const double ranges[][2] = {{0.0, 2499.5}, {10.2, 10.6}, {3.0, 900.0}, {480.0, 520.0},
+                              {499.0, 700.5}, {-50.0, 60.25}, {2400.0, 3000.0}};
+  for (unsigned r = 0; r < sizeof(ranges)/sizeof(ranges[0]); ++r) {
+    const double xFrom = ranges[r][0], xTo = ranges[r][1];
+    bool any = false;
+    double min = 0.0, max = 0.0;
+    for (int i = 0; i < 5000; ++i) {
+      if (xs[i] >= xFrom && xs[i] <= xTo && ys[i] == ys[i]) {
+        min = any ? qMin(min, ys[i]) : ys[i];
+        max = any ? qMax(max, ys[i]) : ys[i];
+        any = true;
+      }
+    }
+    QVERIFY(any);
+
+    double yMin = -1.0, yMax = -1.0;
+    c->yRange(xFrom, xTo, &yMin, &yMax);
+    QCOMPARE(yMin, min);
+    QCOMPARE(yMax, max);
+  }
+
+  // nothing but holes: the samples are gone through, and come out as holes
+  double yMin = 0.0, yMax = 0.0;
+  c->yRange(550.0, 650.0, &yMin, &yMax);
+  QVERIFY(yMin != yMin);
+  QVERIFY(yMax != yMax);
+}
+
+#ifdef KST_USE_QTEST_MAIN
+QTEST_MAIN(TestCurve)
+#endif
+
+// vim: ts=2 sw=2 et
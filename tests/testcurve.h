@@ -0,0 +1,29 @@
+/***************************************************************************
+ *                                                                         *
+ *   copyright : (C) 2012 The University of Toronto                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef TESTCURVE_H
+#define TESTCURVE_H
+
+#include <QObject>
+
+class TestCurve : public QObject
+{
+  Q_OBJECT
+  private Q_SLOTS:
+    void cleanupTestCase();
+
+    void testIndexNearXYUnordered();
+    void testYRange();
+};
+
+#endif
+
+// vim: ts=2 sw=2 et
@@ -21,6 +21,7 @@
 #include "math_kst.h"
 #include "kst_inf.h"
 
+#include "blockcache.h"
 #include "datacollection.h"
 #include "objectstore.h"
 
@@ -179,6 +180,36 @@ void TestDataSource::testAscii() {
     QCOMPARE(rvp->value()[2], 1.0);
     QCOMPARE(rvp->value()[3], 0.0);
 
+    // both columns in one pass, as UpdateManager asks for them
+    QList<Kst::DataSource::VectorRead> reads;
+    Kst::DataSource::VectorRead read;
+    read.startingFrame = 1;
+    read.numberOfFrames = 3;
+    read.field = "2";
+    reads << read;
+    read.field = "1";
+    reads << read;
+    read.field = "INDEX";
+    reads << read;
+
+    dsp->writeLock();
+    QVERIFY(dsp->readsFieldsTogether());
+    dsp->batchVectors(reads);
+    double v[2];
+    Kst::DataVector::ReadInfo p = {v, 2, 2, -1, 0L};
+    QCOMPARE(dsp->readBatchedVector("2", p), 2);
+    QCOMPARE(v[0], 1.0);
+    QCOMPARE(v[1], 0.0);
+    QCOMPARE(dsp->readBatchedVector("1", p), 2);
+    QVERIFY(v[0] == INF);
+    QCOMPARE(v[1], 0.0);
+    QCOMPARE(dsp->readBatchedVector("INDEX", p), 2);
+    QCOMPARE(v[0], 2.0);
+    p.startingFrame = 0;
+    QCOMPARE(dsp->readBatchedVector("1", p), -1);
+    dsp->clearVectorBatch();
+    dsp->unlock();
+
     tf.close();
   }
 
@@ -718,6 +749,336 @@ void TestDataSource::testFITSImage() {
   }
 }
 
+
+void TestDataSource::testBlockCache() {
+  Kst::BlockCache *cache = Kst::BlockCache::self();
+  const qint64 capacity = cache->capacity();
+  cache->setCapacity(0);
+
+  // only identity matters to the cache
+  const Kst::DataSource *a = reinterpret_cast<const Kst::DataSource*>(quintptr(0x1000));
+  const Kst::DataSource *b = reinterpret_cast<const Kst::DataSource*>(quintptr(0x2000));
+  const QVector<double> block(1000, 1.0);
+  QVector<double> samples;
+
+  cache->insert(a, "x", 0, block);
+  QCOMPARE(cache->blocks(), 0);
+
+  cache->setCapacity(3*1000*sizeof(double));
+  cache->insert(a, "x", 0, block);
+  cache->insert(a, "x", 1, block);
+  cache->insert(a, "x", 2, block);
+  QCOMPARE(cache->bytes(), qint64(3*1000*sizeof(double)));
+
+  const qint64 hits = cache->hits();
+  const qint64 misses = cache->misses();
+  QVERIFY(cache->find(a, "x", 0, samples));
+  QCOMPARE(samples.size(), 1000);
+  QVERIFY(!cache->find(a, "y", 0, samples));
+  QVERIFY(!cache->find(b, "x", 0, samples));
+  QCOMPARE(cache->hits(), hits + 1);
+  QCOMPARE(cache->misses(), misses + 2);
+
+  // block 1 is now the least recently used
+  cache->insert(b, "x", 0, block);
+  QCOMPARE(cache->blocks(), 3);
+  QVERIFY(!cache->find(a, "x", 1, samples));
+  QVERIFY(cache->find(a, "x", 0, samples));
+  QVERIFY(cache->find(a, "x", 2, samples));
+
+  cache->invalidate(a, "x", 2);
+  QCOMPARE(cache->blocks(), 2);
+  QVERIFY(cache->find(a, "x", 0, samples));
+  QVERIFY(!cache->find(a, "x", 2, samples));
+
+  cache->invalidate(a, "x");
+  QCOMPARE(cache->blocks(), 1);
+  QVERIFY(cache->find(b, "x", 0, samples));
+  cache->invalidate(b);
+  QCOMPARE(cache->blocks(), 0);
+  QCOMPARE(cache->bytes(), qint64(0));
+
+  cache->setCapacity(capacity);
+}
+
+
+// frames of field x in memory, sample i being i + offset.  An update finds
+// all of them, and says so if there are more or they were rewritten; reads
+// go as far as there are samples.  It may promise to only be appended to.
+class MemorySource : public Kst::DataSource
+{
+  public:
+    MemorySource() : Kst::DataSource(&_store, 0, QString(), QString()), frames(0), offset(0), rewritten(false), appending(false), found(0), reads(0) {
+      setUpdateType(None);
+      setInterface(new Vector(this));
+    }
+
+    ~MemorySource() {
+      stopReadAhead();
+    }
+
+    UpdateType internalDataSourceUpdate() {
+      const bool changed = (found != frames || rewritten);
+      found = frames;
+      rewritten = false;
+      return changed ? Updated : NoChange;
+    }
+
+    bool readsPastFrameCount() const { return true; }
+    bool appendsOnly() const { return appending; }
+
+    int frames;
+    double offset;
+    bool rewritten;
+    bool appending;
+    int found;
+    int reads;
+
+  private:
+    struct Vector : public DataInterface<Kst::DataVector>
+    {
+      Vector(MemorySource *source) : _source(source) {}
+
+      int read(const QString&, Kst::DataVector::ReadInfo &p) {
+        ++_source->reads;
+        const int n = (p.numberOfFrames < 0) ? 1 : qBound(0, _source->frames - p.startingFrame, p.numberOfFrames);
+        for (int i = 0; i < n; ++i) {
+          p.data[i] = p.startingFrame + i + _source->offset;
+        }
+        return n;
+      }
+
+      QStringList list() const { return QStringList("x"); }
+      bool isListComplete() const { return true; }
+      bool isValid(const QString& field) const { return field == "x"; }
+      const Kst::DataVector::DataInfo dataInfo(const QString&) const { return Kst::DataVector::DataInfo(_source->found, 1); }
+      void setDataInfo(const QString&, const Kst::DataVector::DataInfo&) {}
+      QMap<QString, double> metaScalars(const QString&) { return QMap<QString, double>(); }
+      QMap<QString, QString> metaStrings(const QString&) { return QMap<QString, QString>(); }
+
+      MemorySource *_source;
+    };
+};
+
+
+void TestDataSource::testReadAhead() {
+  MemorySource *source = new MemorySource;
+  Kst::DataSourcePtr dsp = source;
+  double v[1000];
+
+  source->frames = 1000;
+  QCOMPARE(dsp->objectUpdate(1), Kst::Object::Updated);
+  QCOMPARE(dsp->vectorInfo("x").frameCount, 1000);
+
+  // the file grows; the read ahead reads on from the follower without
+  // updating the source, so the update in progress doesn't see it
+  dsp->writeLock();
+  dsp->readAhead("x", 999);
+  dsp->unlock();
+  source->frames = 1500;
+  dsp->readAheadNow();
+  QCOMPARE(source->found, 1000);
+  QCOMPARE(dsp->vectorInfo("x").frameCount, 1000);
+  Kst::DataVector::ReadInfo p = {v, 999, 100, -1, 0L};
+  QCOMPARE(dsp->readBatchedVector("x", p), -1);
+
+  // the next update has it, and finds more
+  source->frames = 1600;
+  QCOMPARE(dsp->objectUpdate(2), Kst::Object::Updated);
+  QCOMPARE(dsp->vectorInfo("x").frameCount, 1600);
+  int reads = source->reads;
+  QCOMPARE(dsp->readBatchedVector("x", p), 100);
+  QCOMPARE(v[0], 999.0);
+  QCOMPARE(v[99], 1098.0);
+  QCOMPARE(source->reads, reads);
+
+  // past the end of what was read ahead comes from the source
+  p.startingFrame = 1450;
+  QCOMPARE(dsp->readBatchedVector("x", p), 100);
+  QCOMPARE(v[49], 1499.0);
+  QCOMPARE(v[99], 1549.0);
+  QCOMPARE(source->reads, reads + 1);
+
+  // it moved on 600 frames: twice that is read ahead next
+  dsp->writeLock();
+  dsp->readAhead("x", 1599);
+  dsp->unlock();
+  source->frames = 3000;
+  dsp->readAheadNow();
+  QCOMPARE(dsp->objectUpdate(3), Kst::Object::Updated);
+  reads = source->reads;
+  p.startingFrame = 1599;
+  p.numberOfFrames = 1000;
+  QCOMPARE(dsp->readBatchedVector("x", p), 1000);
+  QCOMPARE(v[999], 2598.0);
+  QCOMPARE(source->reads, reads);
+
+  // and only that update
+  QCOMPARE(dsp->objectUpdate(4), Kst::Object::NoChange);
+  QCOMPARE(dsp->readBatchedVector("x", p), -1);
+}
+
+
+void TestDataSource::testCachedRewrite() {
+  Kst::BlockCache *cache = Kst::BlockCache::self();
+  const qint64 capacity = cache->capacity();
+  cache->setCapacity(16*1024*1024);
+
+  MemorySource *source = new MemorySource;
+  Kst::DataSourcePtr dsp = source;
+  const int blockFrames = Kst::BlockCache::blockFrames(1);
+  QVector<double> v(blockFrames);
+  Kst::DataVector::ReadInfo p = {v.data(), 0, blockFrames, -1, 0L};
+
+  source->frames = 2*blockFrames;
+  QCOMPARE(dsp->objectUpdate(1), Kst::Object::Updated);
+  dsp->writeLock();
+  QCOMPARE(dsp->readCachedVector("x", p), blockFrames);
+  const int reads = source->reads;
+  QCOMPARE(dsp->readCachedVector("x", p), blockFrames);
+  QCOMPARE(source->reads, reads);
+  QCOMPARE(v[10], 10.0);
+  dsp->unlock();
+
+  // the same size, different contents
+  source->offset = 1000.0;
+  source->rewritten = true;
+  QCOMPARE(dsp->objectUpdate(2), Kst::Object::Updated);
+  dsp->writeLock();
+  QCOMPARE(dsp->readCachedVector("x", p), blockFrames);
+  QCOMPARE(source->reads, reads + 1);
+  QCOMPARE(v[10], 1010.0);
+  dsp->unlock();
+
+  cache->setCapacity(capacity);
+}
+
+
+void TestDataSource::testCachedAppend() {
+  Kst::BlockCache *cache = Kst::BlockCache::self();
+  const qint64 capacity = cache->capacity();
+  cache->setCapacity(16*1024*1024);
+  const int blocks = cache->blocks();
+
+  MemorySource *source = new MemorySource;
+  Kst::DataSourcePtr dsp = source;
+  source->appending = true;
+  const int blockFrames = Kst::BlockCache::blockFrames(1);
+  QVector<double> v(2*blockFrames);
+  Kst::DataVector::ReadInfo p = {v.data(), 0, 2*blockFrames, -1, 0L};
+
+  source->frames = 2*blockFrames + 10;
+  QCOMPARE(dsp->objectUpdate(1), Kst::Object::Updated);
+  dsp->writeLock();
+  QCOMPARE(dsp->readCachedVector("x", p), 2*blockFrames);
+  dsp->unlock();
+  QCOMPARE(cache->blocks(), blocks + 2);
+
+  // the file grows: what it had is still cached, and only the new frames
+  // are read
+  source->frames = 4*blockFrames;
+  QCOMPARE(dsp->objectUpdate(2), Kst::Object::Updated);
+  QCOMPARE(cache->blocks(), blocks + 2);
+  const int reads = source->reads;
+  dsp->writeLock();
+  QCOMPARE(dsp->readCachedVector("x", p), 2*blockFrames);
+  QCOMPARE(source->reads, reads);
+  QCOMPARE(v[blockFrames + 10], double(blockFrames + 10));
+  p.startingFrame = blockFrames;
+  QCOMPARE(dsp->readCachedVector("x", p), 2*blockFrames);
+  QCOMPARE(source->reads, reads + 1);
+  QCOMPARE(v[2*blockFrames - 1], double(3*blockFrames - 1));
+  dsp->unlock();
+  QCOMPARE(cache->blocks(), blocks + 3);
+
+  // a reset still drops everything
+  dsp->writeLock();
+  dsp->reset();
+  dsp->unlock();
+  QCOMPARE(cache->blocks(), blocks);
+
+  cache->setCapacity(capacity);
+}
+
+
+void TestDataSource::testDataVectorSharing() {
+  MemorySource *source = new MemorySource;
+  Kst::DataSourcePtr dsp = source;
+  source->frames = 100;
+  QCOMPARE(dsp->objectUpdate(1), Kst::Object::Updated);
+
+  Kst::DataVectorPtr rvp = Kst::kst_cast<Kst::DataVector>(_store.createObject<Kst::DataVector>());
+  rvp->writeLock();
+  rvp->change(dsp, "x", 0, -1, 0, false, false);
+  rvp->unlock();
+
+  // a second vector of the same samples borrows them rather than reading
+  Kst::DataVectorPtr dup = Kst::kst_cast<Kst::DataVector>(_store.createObject<Kst::DataVector>());
+  dup->writeLock();
+  dup->change(dsp, "x", 0, -1, 0, false, false);
+  dup->unlock();
+  QVERIFY(dup->sharesWith() == rvp);
+
+  rvp->writeLock();
+  QCOMPARE(rvp->objectUpdate(1), Kst::Object::Updated);
+  rvp->unlock();
+  dup->writeLock();
+  QCOMPARE(dup->objectUpdate(1), Kst::Object::Updated);
+  dup->unlock();
+  QCOMPARE(dup->length(), 100);
+  QVERIFY(dup->value() == rvp->value());
+  QCOMPARE(dup->value(99), 99.0);
+
+  // the leader grows into a buffer of its own, and what the follower has
+  // stays put until it follows again
+  const double *held = dup->value();
+  source->frames = 100000;
+  QCOMPARE(dsp->objectUpdate(2), Kst::Object::Updated);
+  rvp->writeLock();
+  QCOMPARE(rvp->objectUpdate(2), Kst::Object::Updated);
+  rvp->unlock();
+  QCOMPARE(rvp->length(), 100000);
+  QVERIFY(rvp->value() != held);
+  QCOMPARE(held[0], 0.0);
+  QCOMPARE(held[99], 99.0);
+  QCOMPARE(dup->length(), 100);
+  dup->writeLock();
+  QCOMPARE(dup->objectUpdate(2), Kst::Object::Updated);
+  dup->unlock();
+  QCOMPARE(dup->length(), 100000);
+  QVERIFY(dup->value() == rvp->value());
+  QCOMPARE(dup->value(99999), 99999.0);
+
+  // a changed follower copies them first
+  dup->writeLock();
+  dup->changeFrames(1, -1, 0, false, false);
+  dup->unlock();
+  QVERIFY(!dup->sharesWith());
+  QVERIFY(dup->value() != rvp->value());
+  QCOMPARE(rvp->value(0), 0.0);
+
+  // a changed leader hands its followers over to the first of them, which
+  // keeps what it had until it reads for itself
+  Kst::DataVectorPtr dup2 = Kst::kst_cast<Kst::DataVector>(_store.createObject<Kst::DataVector>());
+  dup2->writeLock();
+  dup2->change(dsp, "x", 0, -1, 0, false, false);
+  QCOMPARE(dup2->objectUpdate(3), Kst::Object::Updated);
+  dup2->unlock();
+  QVERIFY(dup2->sharesWith() == rvp);
+  held = dup2->value();
+  rvp->writeLock();
+  rvp->changeFrames(10, -1, 0, false, false);
+  rvp->unlock();
+  QVERIFY(!dup2->sharesWith());
+  QVERIFY(rvp->value() != held);
+  QCOMPARE(held[99999], 99999.0);
+  dup2->writeLock();
+  QCOMPARE(dup2->objectUpdate(4), Kst::Object::Updated);
+  dup2->unlock();
+  QCOMPARE(dup2->length(), 100000);
+  QCOMPARE(dup2->value(5), 5.0);
+}
+
 #ifdef KST_USE_QTEST_MAIN
 QTEST_MAIN(TestDataSource)
 #endif
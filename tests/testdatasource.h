@@ -33,6 +33,12 @@ class TestDataSource : public QObject
     void testQImageSource();
     void testFITSImage();
 
+    void testBlockCache();
+    void testReadAhead();
+    void testCachedRewrite();
+    void testCachedAppend();
+    void testDataVectorSharing();
+
   private:
     QStringList _plugins;
 };
@@ -12,15 +12,42 @@
 #include "testobjectstore.h"
 
 #include <QtTest>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
 
 #include <datasource.h>
 #include <datavector.h>
 #include <objectstore.h>
 #include <scalar.h>
+#include <updatemanager.h>
+#include <updateprofiler.h>
 #include <vector.h>
 
 using namespace Kst;
 
+namespace {
+
+// holds a read lock until told to let go
+class ReadLockJob : public QRunnable {
+  public:
+    ReadLockJob(Object *o, QSemaphore *held, QSemaphore *go) : _o(o), _held(held), _go(go) {}
+    void run() {
+      _o->readLock();
+      _o->readLock();
+      _held->release();
+      _go->acquire();
+      _o->unlock();
+      _o->unlock();
+    }
+  private:
+    Object *_o;
+    QSemaphore *_held;
+    QSemaphore *_go;
+};
+
+}
+
 void TestObjectStore::cleanupTestCase() {
 }
 
@@ -60,6 +87,220 @@ void TestObjectStore::testObjectStore() {
   QVERIFY(!p);  // make sure object gets deleted when last reference is gone
 }
 
+void TestObjectStore::testTypeIndex() {
+  ObjectStore store;
+
+  ScalarPtr sc = kst_cast<Scalar>(store.createObject<Scalar>());
+  VectorPtr vec = kst_cast<Vector>(store.createObject<Vector>());
+  ScalarPtr sc2 = kst_cast<Scalar>(store.createObject<Scalar>());
+
+  // scalars come back in the order they were made, stats scalars included
+  ObjectList<Scalar> scalars = store.getObjects<Scalar>();
+  QCOMPARE(scalars.count(), vec->scalars().count() + 2);
+  QVERIFY(scalars.first() == sc);
+  QVERIFY(scalars.last() == sc2);
+
+  // a base class finds every kind of primitive, still in order
+  ObjectList<Primitive> primitives = store.getObjects<Primitive>();
+  QCOMPARE(primitives.count(), scalars.count() + 1);
+  QVERIFY(primitives.first() == PrimitivePtr(sc.data()));
+  QVERIFY(primitives.last() == PrimitivePtr(sc2.data()));
+  QVERIFY(primitives.contains(PrimitivePtr(vec.data())));
+
+  QVERIFY(store.retrieveObject(vec->shortName()) == ObjectPtr(vec.data()));
+  QVERIFY(store.retrieveObject(vec->Name()) == ObjectPtr(vec.data()));
+
+  store.removeObject(sc);
+  QCOMPARE(store.getObjects<Scalar>().count(), vec->scalars().count() + 1);
+  QVERIFY(!store.retrieveObject(sc->shortName()));
+
+  store.clear();
+  QCOMPARE(store.getObjects<Primitive>().count(), 0);
+}
+
+void TestObjectStore::testUpdateSchedule() {
+  ObjectStore store;
+
+  VectorPtr vec = kst_cast<Vector>(store.createObject<Vector>());
+  VectorPtr other = kst_cast<Vector>(store.createObject<Vector>());
+  QVERIFY(vec);
+  QVERIFY(other);
+
+  QList<ObjectPtr> seeds;
+  seeds << ObjectPtr(vec.data());
+
+  QList<ObjectPtr> clean;
+  QList<ObjectPtr> schedule = store.updateSchedule(seeds, &clean);
+
+  // the vector and its stats scalars, and nothing else
+  QCOMPARE(schedule.count(), vec->scalars().count() + 1);
+  QVERIFY(schedule.first() == ObjectPtr(vec.data()));
+  QVERIFY(!schedule.contains(ObjectPtr(other.data())));
+  QVERIFY(clean.isEmpty());
+
+  foreach (ScalarPtr sc, vec->scalars()) {
+    QVERIFY(schedule.contains(ObjectPtr(sc.data())));
+  }
+
+  // the scalars only depend on the vector, so they can all go together
+  QList<QList<ObjectPtr> > levels = store.updateLevels(seeds);
+  QCOMPARE(levels.count(), 2);
+  QCOMPARE(levels.at(0).count(), 1);
+  QCOMPARE(levels.at(1).count(), vec->scalars().count());
+
+  // nothing downstream of a scalar
+  seeds.clear();
+  seeds << ObjectPtr(vec->scalars().value("max").data());
+  clean.clear();
+  schedule = store.updateSchedule(seeds, &clean);
+  QCOMPARE(schedule.count(), 1);
+  QCOMPARE(clean.count(), 1);
+  QVERIFY(clean.first() == ObjectPtr(vec.data()));
+
+  store.removeObject(vec);
+  seeds.clear();
+  seeds << ObjectPtr(vec.data());
+  QVERIFY(store.updateSchedule(seeds).isEmpty());
+
+  store.clear();
+}
+
+void TestObjectStore::testObjectLocks() {
+  ObjectStore store;
+  VectorPtr vec = kst_cast<Vector>(store.createObject<Vector>());
+
+  QCOMPARE(vec->myLockStatus(), KstRWLock::UNLOCKED);
+  vec->readLock();
+  vec->readLock();
+  QCOMPARE(vec->myLockStatus(), KstRWLock::READLOCKED);
+  vec->unlock();
+  QCOMPARE(vec->myLockStatus(), KstRWLock::READLOCKED);
+  vec->unlock();
+  QCOMPARE(vec->lockStatus(), KstRWLock::UNLOCKED);
+
+  // a writer may read lock as well
+  vec->writeLock();
+  vec->readLock();
+  QCOMPARE(vec->myLockStatus(), KstRWLock::WRITELOCKED);
+  vec->unlock();
+  vec->unlock();
+  QCOMPARE(vec->lockStatus(), KstRWLock::UNLOCKED);
+
+  // more readers at once than the lock keeps track of in place
+  const int readers = 8;
+  QSemaphore held, go;
+  QThreadPool pool;
+  pool.setMaxThreadCount(readers);
+  for (int i = 0; i < readers; ++i) {
+    pool.start(new ReadLockJob(vec, &held, &go));
+  }
+  held.acquire(readers);
+  QCOMPARE(vec->lockStatus(), KstRWLock::READLOCKED);
+  QCOMPARE(vec->myLockStatus(), KstRWLock::UNLOCKED);
+  go.release(readers);
+  pool.waitForDone();
+  QCOMPARE(vec->lockStatus(), KstRWLock::UNLOCKED);
+
+  store.clear();
+}
+
+void TestObjectStore::testUpdateProfile() {
+  UpdateProfiler *profiler = UpdateProfiler::self();
+  profiler->setHistoryLength(2);
+  profiler->clear();
+  QVERIFY(profiler->history().isEmpty());
+
+  for (int serial = 1; serial <= 3; ++serial) {
+    profiler->startCycle(serial);
+    profiler->record(UpdateProfiler::ObjectUpdate, "V1", "Vector", 1000000);
+    profiler->record(UpdateProfiler::ObjectUpdate, "X1", "Scalar", 10);
+    profiler->finishCycle(serial - 1);
+  }
+  profiler->record(UpdateProfiler::Paint, "P1", "Plot", 2000000);
+
+  // only the last two cycles are kept, oldest first
+  QList<UpdateProfiler::Cycle> history = profiler->history();
+  QCOMPARE(history.count(), 2);
+  QCOMPARE(history.at(0).serial, qint64(2));
+  QCOMPARE(history.at(1).serial, qint64(3));
+  QCOMPARE(history.at(1).deferredLoops, 2);
+
+  // the quick scalar is only counted, the paint goes with the last cycle
+  UpdateProfiler::Cycle last = profiler->lastCycle();
+  QCOMPARE(last.samples.count(), 2);
+  QCOMPARE(last.samples.at(0).name, QString("V1"));
+  QCOMPARE(last.samples.at(1).kind, UpdateProfiler::Paint);
+  QCOMPARE(last.quickSamples, 1);
+  QCOMPARE(history.at(0).samples.count(), 1);
+
+  QCOMPARE(profiler->report(2).split('\n').count(), 2 * 3 + 1);
+
+  // painting while updates are paused only keeps the latest paints
+  for (int i = 0; i < 2*UpdateProfiler::MaxLateSamples; ++i) {
+    profiler->record(UpdateProfiler::Paint, QString("P%1").arg(i), "Plot", 2000000);
+  }
+  last = profiler->lastCycle();
+  QCOMPARE(last.samples.count(), 1 + int(UpdateProfiler::MaxLateSamples));
+  QCOMPARE(last.lateSamples, int(UpdateProfiler::MaxLateSamples));
+  QCOMPARE(last.samples.at(0).name, QString("V1"));
+  QCOMPARE(last.samples.last().name, QString("P%1").arg(2*UpdateProfiler::MaxLateSamples - 1));
+
+  profiler->setHistoryLength(32);
+  profiler->clear();
+}
+
+void TestObjectStore::testAdaptiveUpdates() {
+  UpdateManager *um = UpdateManager::self();
+  um->setTargetLatency(100);
+  QSignalSpy spy(um, SIGNAL(decimationChanged(int)));
+  QCOMPARE(um->decimation(), 0);
+  QCOMPARE(um->updatePeriod(), 50);
+
+  // over half the budget: thin out, and stay as long idle as busy
+  um->adaptUpdatePeriod(80);
+  QCOMPARE(um->decimation(), 1);
+  QCOMPARE(um->updatePeriod(), 80);
+  QCOMPARE(spy.count(), 1);
+  QCOMPARE(spy.at(0).at(0).toInt(), 1);
+
+  for (int i = 0; i < 2*UpdateManager::MaxDecimation; ++i) {
+    um->adaptUpdatePeriod(80);
+  }
+  QCOMPARE(um->decimation(), int(UpdateManager::MaxDecimation));
+  QCOMPARE(spy.count(), int(UpdateManager::MaxDecimation));
+
+  // between a quarter and half of the budget: leave it be
+  um->adaptUpdatePeriod(20); // cost (3*80 + 20)/4 = 65
+  um->adaptUpdatePeriod(0);  // 48
+  QCOMPARE(um->decimation(), int(UpdateManager::MaxDecimation));
+  QCOMPARE(um->updatePeriod(), 100 - 48);
+  um->adaptUpdatePeriod(0);  // 36
+  QCOMPARE(um->decimation(), int(UpdateManager::MaxDecimation));
+
+  // under a quarter: back off one step at a time
+  um->adaptUpdatePeriod(0);  // 27
+  um->adaptUpdatePeriod(0);  // 20
+  QCOMPARE(um->decimation(), int(UpdateManager::MaxDecimation) - 1);
+  QCOMPARE(um->updatePeriod(), 80);
+  QCOMPARE(spy.count(), int(UpdateManager::MaxDecimation) + 1);
+
+  // never faster than the floor
+  um->setTargetLatency(20);
+  QCOMPARE(um->decimation(), 0);
+  QCOMPARE(spy.count(), int(UpdateManager::MaxDecimation) + 2);
+  QCOMPARE(spy.last().at(0).toInt(), 0);
+  um->adaptUpdatePeriod(1);
+  QCOMPARE(um->updatePeriod(), 20);
+
+  // an update which was never drawn does not count
+  um->setTargetLatency(100);
+  um->finishViewItemUpdate(false);
+  QCOMPARE(um->updatePeriod(), 50);
+
+  um->setTargetLatency(0);
+  QCOMPARE(um->decimation(), 0);
+}
+
 #ifdef KST_USE_QTEST_MAIN
 QTEST_MAIN(TestObjectStore)
 #endif
@@ -22,6 +22,16 @@ class TestObjectStore : public QObject
     void cleanupTestCase();
 
     void testObjectStore();
+
+    void testTypeIndex();
+
+    void testUpdateSchedule();
+
+    void testObjectLocks();
+
+    void testUpdateProfile();
+
+    void testAdaptiveUpdates();
 };
 
 #endif
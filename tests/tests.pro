@@ -30,6 +30,7 @@ SOURCES += \
     main.cpp \
     testeditablematrix.cpp \
     testcsd.cpp \
+    testcurve.cpp \
     testdatamatrix.cpp \
     testdatasource.cpp \
     testeqparser.cpp \
@@ -40,11 +41,13 @@ SOURCES += \
     testmatrix.cpp \
     testpsd.cpp \
     testobjectstore.cpp \
+    testsharedptr.cpp \
     testvector.cpp
 
 HEADERS += \
     testeditablematrix.h \
     testcsd.h \
+    testcurve.h \
     testdatamatrix.h \
     testdatasource.h \
     testhistogram.h \
@@ -55,4 +58,5 @@ HEADERS += \
     testmatrix.h \
     testpsd.h \
     testobjectstore.h \
+    testsharedptr.h \
     testvector.h
@@ -0,0 +1,147 @@
+/***************************************************************************
+ *                                                                         *
+ *   copyright : (C) 2012 The University of Toronto                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "testsharedptr.h"
+
+#include <QtTest>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include <objectstore.h>
+#include <sharedptr.h>
+#include <updatemanager.h>
+#include <vector.h>
+
+using namespace Kst;
+
+#define REF_LOOPS 100000
+
+namespace {
+
+class Counted : public Shared {
+  public:
+    Counted(bool *deleted) : _deleted(deleted) { *_deleted = false; }
+  protected:
+    ~Counted() { *_deleted = true; }
+  private:
+    bool *_deleted;
+};
+
+// How Shared used to count, kept here so the benchmarks can compare.
+class SemaphoreCounted {
+  public:
+    SemaphoreCounted() : sem(999999) {}
+    void ref() const { sem.acquire(1); }
+    bool unref() const { sem.release(1); return sem.available() == 999999; }
+  private:
+    mutable QSemaphore sem;
+};
+
+class CopyJob : public QRunnable {
+  public:
+    CopyJob(const SharedPtr<Counted> &p) : _p(p) {}
+    void run() {
+      for (int i = 0; i < REF_LOOPS; ++i) {
+        SharedPtr<Counted> copy = _p;
+      }
+    }
+  private:
+    SharedPtr<Counted> _p;
+};
+
+}
+
+
+void TestSharedPtr::testRefCount() {
+  bool deleted;
+  SharedPtr<Counted> p = new Counted(&deleted);
+  QCOMPARE(p.count(), 1);
+  {
+    SharedPtr<Counted> q = p;
+    QCOMPARE(p.count(), 2);
+  }
+  QCOMPARE(p.count(), 1);
+  QVERIFY(!deleted);
+  p = 0;
+  QVERIFY(deleted);
+}
+
+
+void TestSharedPtr::testConcurrentRefs() {
+  bool deleted;
+  SharedPtr<Counted> p = new Counted(&deleted);
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(4);
+  for (int i = 0; i < 8; ++i) {
+    pool.start(new CopyJob(p));
+  }
+  pool.waitForDone();
+
+  QCOMPARE(p.count(), 1);
+  QVERIFY(!deleted);
+  p = 0;
+  QVERIFY(deleted);
+}
+
+
+void TestSharedPtr::benchmarkRefUnref() {
+  bool deleted;
+  SharedPtr<Counted> p = new Counted(&deleted);
+  QBENCHMARK {
+    for (int i = 0; i < REF_LOOPS; ++i) {
+      SharedPtr<Counted> copy = p;
+    }
+  }
+}
+
+
+void TestSharedPtr::benchmarkSemaphoreRefUnref() {
+  SemaphoreCounted c;
+  QBENCHMARK {
+    for (int i = 0; i < REF_LOOPS; ++i) {
+      c.ref();
+      c.unref();
+    }
+  }
+}
+
+
+// Every vector and all of its stats scalars are updated each cycle, which
+// is about as much pointer copying as a cycle does per sample.
+void TestSharedPtr::benchmarkUpdateCycle() {
+  ObjectStore store;
+  QList<VectorPtr> vectors;
+  for (int i = 0; i < 200; ++i) {
+    VectorPtr v = kst_cast<Vector>(store.createObject<Vector>());
+    v->resize(1000);
+    vectors << v;
+  }
+
+  UpdateManager::self()->setStore(&store);
+  QBENCHMARK {
+    foreach (VectorPtr v, vectors) {
+      v->registerChange();
+    }
+    UpdateManager::self()->doUpdates(true);
+  }
+  UpdateManager::self()->setStore(0);
+
+  vectors.clear();
+  store.clear();
+}
+
+#ifdef KST_USE_QTEST_MAIN
+QTEST_MAIN(TestSharedPtr)
+#endif
+
+// vim: ts=2 sw=2 et
@@ -0,0 +1,32 @@
+/***************************************************************************
+ *                                                                         *
+ *   copyright : (C) 2012 The University of Toronto                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef TESTSHAREDPTR_H
+#define TESTSHAREDPTR_H
+
+#include <QObject>
+
+class TestSharedPtr : public QObject
+{
+  Q_OBJECT
+  private Q_SLOTS:
+    void testRefCount();
+    void testConcurrentRefs();
+
+    // run with -tickcounter or -callgrind for stable numbers
+    void benchmarkRefUnref();
+    void benchmarkSemaphoreRefUnref();
+    void benchmarkUpdateCycle();
+};
+
+#endif
+
+// vim: ts=2 sw=2 et
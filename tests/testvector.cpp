@@ -14,9 +14,72 @@
 #include <vector.h>
 #include <datacollection.h>
 #include <objectstore.h>
+#include <updatemanager.h>
+#include <statistics_kst.h>
+#include <bufferstore.h>
+
+#include <QDir>
+#include <QElapsedTimer>
 
 #include "ksttest.h"
 
+namespace {
+
+// a vector which grows like a DataVector reading a growing file
+class GrowingVector : public Kst::Vector {
+  public:
+    GrowingVector(Kst::ObjectStore *store) : Kst::Vector(store), _filled(0) {}
+
+    void append(const QVector<double> &values) {
+      resize(_filled + values.count());
+      for (int i = 0; i < values.count(); ++i) {
+        _v[_filled + i] = values.at(i);
+      }
+      _unchangedSamples = _filled;
+      _filled += values.count();
+      internalUpdate();
+    }
+
+    // drop the first n samples too, as following the end of a file does
+    void scroll(int n, const QVector<double> &values) {
+      shift(n);
+      _filled -= n;
+      resize(_filled + values.count());
+      for (int i = 0; i < values.count(); ++i) {
+        _v[_filled + i] = values.at(i);
+      }
+      _unchangedSamples = _filled;
+      _shiftedSamples = n;
+      _filled += values.count();
+      internalUpdate();
+    }
+
+  private:
+    int _filled;
+};
+
+QVector<double> ramp(double from, int count) {
+  QVector<double> values;
+  for (int i = 0; i < count; ++i) {
+    values << from + i;
+  }
+  return values;
+}
+
+bool holdsRamp(const Kst::VectorSnapshotPtr &s, double from, int count) {
+  if (s->length() != count) {
+    return false;
+  }
+  for (int i = 0; i < count; ++i) {
+    if (s->value(i) != from + i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}
+
 static Kst::ObjectStore _store;
 
 
@@ -67,6 +130,548 @@ void TestVector::testVector()
   QCOMPARE(v2->interpolate(4, 5), 3.0);
 }
 
+void TestVector::testSnapshot()
+{
+  Kst::VectorPtr v = Kst::kst_cast<Kst::Vector>(_store.createObject<Kst::Vector>());
+  v->resize(3);
+  double *data = v->value();
+  data[0] = 1;
+  data[1] = 2;
+  data[2] = 3;
+
+  // updates happen here, so the snapshot is just the vector's own data
+  Kst::VectorSnapshotPtr s = v->snapshot();
+  QVERIFY(!s->isCopy());
+  QCOMPARE(s->length(), 3);
+  QCOMPARE(s->interpolate(1, 5), 1.5);
+
+  Kst::UpdateManager::self()->setBackgroundUpdates(true);
+  v->writeLock();
+  v->internalUpdate();
+  s = v->snapshot();
+  QVERIFY(s->isCopy());
+  QVERIFY(s->isRising());
+
+  data[1] = 42;
+  QCOMPARE(s->value(1), 2.0);
+  v->internalUpdate();
+  v->unlock();
+  QCOMPARE(v->snapshot()->value(1), 42.0);
+  QCOMPARE(s->value(1), 2.0);
+
+  // once nobody asks for snapshots the updates stop making them, and the
+  // next one is made when asked for
+  s = 0;
+  v->writeLock();
+  v->internalUpdate();
+  v->internalUpdate();
+  data[1] = 7;
+  QCOMPARE(v->snapshot()->value(1), 7.0);
+  v->unlock();
+  Kst::UpdateManager::self()->setBackgroundUpdates(false);
+}
+
+void TestVector::testSnapshotRefresh()
+{
+  Kst::UpdateManager::self()->setBackgroundUpdates(true);
+  Kst::SharedPtr<GrowingVector> v = _store.createObject<GrowingVector>();
+  v->writeLock();
+  v->append(ramp(0, 100));
+  v->unlock();
+
+  // both held: a new copy
+  Kst::VectorSnapshotPtr held = v->snapshot();
+  Kst::VectorSnapshot *a = held.data();
+  v->writeLock();
+  v->append(ramp(100, 50));
+  v->unlock();
+  Kst::VectorSnapshotPtr other = v->snapshot();
+  Kst::VectorSnapshot *b = other.data();
+  QVERIFY(b != a);
+  QVERIFY(holdsRamp(held, 0, 100));
+  QVERIFY(holdsRamp(other, 0, 150));
+
+  // the one before is let go of, and brought up to date
+  held = 0;
+  v->writeLock();
+  v->append(ramp(150, 50));
+  v->unlock();
+  QVERIFY(v->snapshot().data() == a);
+  QVERIFY(holdsRamp(v->snapshot(), 0, 200));
+  QVERIFY(holdsRamp(other, 0, 150));
+
+  // and again when the samples scroll, while the other one is held
+  other = 0;
+  held = v->snapshot();
+  v->writeLock();
+  v->scroll(60, ramp(200, 60));
+  v->unlock();
+  QVERIFY(v->snapshot().data() == b);
+  QVERIFY(holdsRamp(v->snapshot(), 60, 200));
+  QVERIFY(holdsRamp(held, 0, 200));
+
+  held = 0;
+  other = v->snapshot();
+  v->writeLock();
+  v->scroll(20, ramp(260, 20));
+  v->unlock();
+  QVERIFY(v->snapshot().data() == a);
+  QVERIFY(holdsRamp(v->snapshot(), 80, 200));
+  QVERIFY(holdsRamp(other, 60, 200));
+
+  // with room to scroll into by now
+  other = 0;
+  held = v->snapshot();
+  v->writeLock();
+  v->scroll(10, ramp(280, 10));
+  v->unlock();
+  QVERIFY(v->snapshot().data() == b);
+  QVERIFY(holdsRamp(v->snapshot(), 90, 200));
+  QVERIFY(holdsRamp(held, 80, 200));
+
+  held = 0;
+  Kst::UpdateManager::self()->setBackgroundUpdates(false);
+}
+
+// The statistics of a vector grown a chunk at a time must come out as
+// those of one pass over the whole.
+static void compareAppended(Kst::Vector *grown, const QVector<double> &all) {
+  Kst::VectorPtr whole = Kst::kst_cast<Kst::Vector>(_store.createObject<Kst::Vector>());
+  whole->writeLock();
+  whole->resize(all.count());
+  for (int i = 0; i < all.count(); ++i) {
+    whole->value()[i] = all.at(i);
+  }
+  whole->internalUpdate();
+  whole->unlock();
+
+  QCOMPARE(grown->length(), all.count());
+  QCOMPARE(grown->min(), whole->min());
+  QCOMPARE(grown->max(), whole->max());
+  QCOMPARE(grown->mean(), whole->mean());
+  QCOMPARE(grown->ns_min(), whole->ns_min());
+  QCOMPARE(grown->ns_max(), whole->ns_max());
+  QCOMPARE(grown->isRising(), whole->isRising());
+}
+
+void TestVector::testAppendedStatistics()
+{
+  Kst::SharedPtr<GrowingVector> grown = _store.createObject<GrowingVector>();
+
+  QVector<double> all;
+  for (int chunk = 0; chunk < 5; ++chunk) {
+    QVector<double> values;
+    for (int i = 0; i < 100; ++i) {
+      values << double(chunk * 100 + i);
+    }
+    all += values;
+
+    grown->writeLock();
+    grown->append(values);
+    grown->unlock();
+  }
+
+  compareAppended(grown.data(), all);
+  QVERIFY(grown->isRising());
+
+  // something going down in the new samples is still noticed
+  grown->writeLock();
+  grown->append(QVector<double>() << -1.0);
+  grown->unlock();
+  QCOMPARE(grown->min(), -1.0);
+  QVERIFY(!grown->isRising());
+
+  // Spikes and holes.  Samples appended earlier were judged against the
+  // spike threshold as it was then, which a full pass doesn't do; but
+  // with the spikes well clear of it either way, the spike insensitive
+  // extremes are the same.  The spike at 390 is skipped past the end of
+  // its chunk, with a hole in the samples skipped, and the one at 498 is
+  // two samples before the end of its chunk.
+  Kst::SharedPtr<GrowingVector> spiky = _store.createObject<GrowingVector>();
+  all.clear();
+  for (int chunk = 0; chunk < 7; ++chunk) {
+    QVector<double> values;
+    for (int i = chunk * 100; i < (chunk + 1) * 100; ++i) {
+      double x = 50.0 + 5.0 * sin(i * 0.3);
+      if (i == 150 || i == 498) {
+        x = 1000.0;
+      } else if (i == 390) {
+        x = -1000.0;
+      } else if (i == 120 || i == 405 || (i >= 610 && i < 616)) {
+        x = Kst::NOPOINT;
+      }
+      values << x;
+    }
+    all += values;
+
+    spiky->writeLock();
+    spiky->append(values);
+    spiky->unlock();
+
+    compareAppended(spiky.data(), all);
+  }
+
+  QCOMPARE(spiky->max(), 1000.0);
+  QCOMPARE(spiky->min(), -1000.0);
+  QVERIFY(spiky->ns_max() <= 55.0 && spiky->ns_max() > 54.0);
+  QVERIFY(spiky->ns_min() >= 45.0 && spiky->ns_min() < 46.0);
+}
+
+void TestVector::testStatisticsKernels()
+{
+  // runs of finite samples with the odd gap, and a rising stretch
+  QVector<double> data;
+  for (int i = 0; i < 1001; ++i) {
+    if (i % 97 == 13) {
+      data << Kst::NOPOINT;
+    } else if (i < 500) {
+      data << double(i) + 0.25;
+    } else {
+      data << sin(double(i)) * 100.0;
+    }
+  }
+
+  const Kst::RunningStatistics::Kernel best = Kst::RunningStatistics::kernel();
+
+  QVERIFY(Kst::RunningStatistics::setKernel(Kst::RunningStatistics::Scalar));
+  Kst::RunningStatistics expected;
+  expected.add(data.constData(), 300);
+  expected.add(data.constData() + 300, data.count() - 300);
+  QVERIFY(!expected.rising);
+
+  Kst::RunningStatistics::Kernel kernels[] = { Kst::RunningStatistics::SSE2, Kst::RunningStatistics::AVX2 };
+  for (unsigned k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k) {
+    if (!Kst::RunningStatistics::setKernel(kernels[k])) {
+      continue;
+    }
+    Kst::RunningStatistics stats;
+    stats.add(data.constData(), 300);
+    stats.add(data.constData() + 300, data.count() - 300);
+    QCOMPARE(stats.n, expected.n);
+    QCOMPARE(stats.min, expected.min);
+    QCOMPARE(stats.max, expected.max);
+    QCOMPARE(stats.minPos, expected.minPos);
+    QCOMPARE(stats.last, expected.last);
+    QCOMPARE(stats.rising, expected.rising);
+    QCOMPARE(stats.sum, expected.sum);
+    QCOMPARE(stats.sum2, expected.sum2);
+    QCOMPARE(stats.dv2, expected.dv2);
+
+    Kst::RunningStatistics rising;
+    rising.add(data.constData() + 14, 96);
+    QVERIFY(rising.rising);
+
+    double sum = 0.0;
+    QCOMPARE(Kst::RunningStatistics::sumFinite(data.constData() + 1, data.count() - 1, sum), expected.n - 1);
+    QCOMPARE(sum, expected.sum - data[0]);
+  }
+
+  Kst::RunningStatistics::setKernel(best);
+}
+
+void TestVector::testScrolling()
+{
+  Kst::VectorPtr v = Kst::kst_cast<Kst::Vector>(_store.createObject<Kst::Vector>());
+  v->writeLock();
+  v->setScrolling(true);
+  v->resize(100);
+  for (int i = 0; i < 100; ++i) {
+    v->value()[i] = i;
+  }
+
+  // a strip chart: drop 10 samples from the front, add 10 at the end
+  int moves = 0;
+  double *last = v->value();
+  for (int step = 1; step <= 20; ++step) {
+    v->shift(10);
+    QCOMPARE(v->length(), 90);
+    v->resize(100);
+    for (int i = 90; i < 100; ++i) {
+      v->value()[i] = step * 10 + i;
+    }
+    if (v->value() != last + 10) {
+      ++moves;
+    }
+    last = v->value();
+
+    for (int i = 0; i < 100; ++i) {
+      QCOMPARE(v->value(i), double(step * 10 + i));
+    }
+  }
+  // with 50 samples to spare, the data is moved back one update in six
+  QCOMPARE(moves, 3);
+
+  v->setScrolling(false);
+  QCOMPARE(v->length(), 100);
+  QCOMPARE(v->value(0), 200.0);
+  QCOMPARE(v->value(99), 299.0);
+  v->unlock();
+}
+
+void TestVector::testFloat32Storage()
+{
+  Kst::VectorPtr v = Kst::kst_cast<Kst::Vector>(_store.createObject<Kst::Vector>());
+  v->writeLock();
+  v->resize(10);
+  for (int i = 0; i < 10; ++i) {
+    v->value()[i] = i + 0.5;
+  }
+  v->value()[3] = NOPOINT;
+  v->internalUpdate();
+  const double mean = v->mean();
+
+  v->setStorageType(Kst::Vector::Float32Storage);
+  QCOMPARE(v->storageType(), Kst::Vector::Float32Storage);
+  v->internalUpdate();
+  QCOMPARE(v->length(), 10);
+  QCOMPARE(v->value(9), 9.5);
+  QVERIFY(v->value(3) != v->value(3));
+  QCOMPARE(v->interpolate(12, 19), 6.5);
+  QCOMPARE(v->min(), 0.5);
+  QCOMPARE(v->max(), 9.5);
+  QCOMPARE(v->mean(), mean);
+
+  Kst::VectorSnapshotPtr snapshot = v->snapshot();
+  QCOMPARE(snapshot->length(), 10);
+  QVERIFY(!snapshot->value());
+  QCOMPARE(snapshot->value(9), 9.5);
+  QCOMPARE(snapshot->interpolate(0, 19), 0.5);
+
+  // the double copy for those who need one
+  QCOMPARE(v->value()[9], 9.5);
+
+  // which has the vector held as doubles, until an update goes by without
+  // anybody asking
+  v->internalUpdate();
+  QCOMPARE(v->storageType(), Kst::Vector::Float32Storage);
+  QVERIFY(v->snapshot()->value());
+  QCOMPARE(v->value(9), 9.5);
+  QCOMPARE(v->mean(), mean);
+  v->internalUpdate();
+  QVERIFY(!v->snapshot()->value());
+  QCOMPARE(v->value(9), 9.5);
+
+  v->resize(12);
+  QCOMPARE(v->length(), 12);
+  QVERIFY(v->value(11) != v->value(11));
+  v->shift(2);
+  QCOMPARE(v->value(0), 2.5);
+
+  v->setStorageType(Kst::Vector::DoubleStorage);
+  QCOMPARE(v->storageType(), Kst::Vector::DoubleStorage);
+  QCOMPARE(v->value()[0], 2.5);
+  QCOMPARE(v->length(), 10);
+  v->unlock();
+}
+
+void TestVector::testMappedStorage()
+{
+  Kst::BufferStore *store = Kst::BufferStore::self();
+  const qint64 budget = store->residentBudget();
+  store->setResidentBudget(1);
+
+  // the scratch directory is made when it is set
+  const QString scratch = store->scratchDirectory();
+  QDir scratchDir(QDir::tempPath() + QDir::separator() + QString("kst-scratch-%1").arg(QCoreApplication::applicationPid()));
+  QVERIFY(!scratchDir.exists());
+  store->setScratchDirectory(scratchDir.path());
+  QVERIFY(scratchDir.exists());
+
+  Kst::VectorPtr v = Kst::kst_cast<Kst::Vector>(_store.createObject<Kst::Vector>());
+  v->writeLock();
+  const int count = Kst::BufferStore::MinimumMappedSize / sizeof(double) * 2;
+  QVERIFY(v->resize(count));
+  QVERIFY(store->isMapped(v->value()));
+  QVERIFY(store->mappedBytes() >= qint64(count * sizeof(double)));
+  QCOMPARE(scratchDir.entryList(QDir::Files).count(), 1);
+  for (int i = 0; i < count; ++i) {
+    v->value()[i] = i;
+  }
+
+  // grown in place in the scratch file
+  QVERIFY(v->resize(count * 2));
+  QVERIFY(store->isMapped(v->value()));
+  QCOMPARE(v->value(count - 1), double(count - 1));
+  QVERIFY(v->value(count) != v->value(count));
+  v->internalUpdate();
+  QCOMPARE(v->max(), double(count - 1));
+
+  // and shrunk in it
+  QVERIFY(v->resize(count + 1));
+  QVERIFY(store->isMapped(v->value()));
+  QCOMPARE(v->value(count - 1), double(count - 1));
+
+  // work buffers stay on the heap whatever the budget
+  void *work = store->allocate(count * sizeof(double), Kst::BufferStore::WorkData);
+  QVERIFY(work);
+  QVERIFY(!store->isMapped(work));
+  store->release(work);
+
+  // and so do snapshots, which are made on every update
+  void *snapshot = store->allocate(count * sizeof(double), Kst::BufferStore::SnapshotData);
+  QVERIFY(snapshot);
+  QVERIFY(!store->isMapped(snapshot));
+  store->release(snapshot);
+
+  // small enough for the heap again
+  store->setResidentBudget(budget);
+  QVERIFY(v->resize(10));
+  QVERIFY(!store->isMapped(v->value()));
+  QCOMPARE(v->value(9), 9.0);
+  v->unlock();
+
+  QCOMPARE(scratchDir.entryList(QDir::Files).count(), 0);
+  store->setScratchDirectory(scratch);
+  QVERIFY(scratchDir.rmdir(scratchDir.path()));
+}
+
+void TestVector::testBufferPool()
+{
+  Kst::BufferStore *store = Kst::BufferStore::self();
+  const qint64 work = store->bytesInUse(Kst::BufferStore::WorkData);
+
+  double *p = static_cast<double*>(store->allocate(1000 * sizeof(double), Kst::BufferStore::WorkData));
+  QVERIFY(p);
+  QCOMPARE(quintptr(p) % Kst::BufferStore::Alignment, quintptr(0));
+  QCOMPARE(store->bytesInUse(Kst::BufferStore::WorkData), work + qint64(1000 * sizeof(double)));
+  p[999] = 1.0;
+
+  // 8000 bytes is in the 7680 to 8192 class
+  double *q = p;
+  QVERIFY(store->resize(q, 1020 * sizeof(double)));
+  QCOMPARE(q, p);
+  QVERIFY(store->resize(q, 2000 * sizeof(double)));
+  QCOMPARE(quintptr(q) % Kst::BufferStore::Alignment, quintptr(0));
+  QCOMPARE(q[999], 1.0);
+
+  // a freed block is handed out again for the same class
+  store->release(q);
+  QCOMPARE(store->bytesInUse(Kst::BufferStore::WorkData), work);
+  double *r = static_cast<double*>(store->allocate(2000 * sizeof(double), Kst::BufferStore::WorkData));
+  QCOMPARE(r, q);
+  store->release(r);
+}
+
+// The extremes of ranges of samples, from the index, against looking.
+void TestVector::testMinMaxIndex()
+{
+  Kst::VectorPtr v = Kst::kst_cast<Kst::Vector>(_store.createObject<Kst::Vector>());
+  v->resize(5000);
+  double *data = v->value();
+  for (int i = 0; i < v->length(); ++i) {
+    data[i] = (i * 7919) % 1000;
+  }
+  data[1234] = NAN;
+
+  v->writeLock();
+  Kst::MinMaxIndexPtr index = v->minMaxIndex();
+  QCOMPARE(index->size(), 5000);
+  QVERIFY(v->snapshot()->minMaxIndex() == index.data());
+
+  const int ranges[][2] = {{0, 4999}, {0, 0}, {5, 130}, {127, 1025}, {1234, 1234}, {1000, 3333}, {4990, 4999}};
+  for (unsigned r = 0; r < sizeof(ranges)/sizeof(ranges[0]); ++r) {
+    const int from = ranges[r][0], to = ranges[r][1];
+    double min = 1e300, max = -1e300;
+    for (int i = from; i <= to; ++i) {
+      if (i != 1234) {
+        min = qMin(min, data[i]);
+        max = qMax(max, data[i]);
+      }
+    }
+    int iMin = -1, iMax = -1;
+    bool holes = false;
+    const bool found = index->extremes(*v, from, to, iMin, iMax, &holes);
+    QCOMPARE(holes, from <= 1234 && to >= 1234);
+    QCOMPARE(found, from != 1234);
+    if (found) {
+      QVERIFY(iMin >= from && iMin <= to && iMax >= from && iMax <= to);
+      QCOMPARE(data[iMin], min);
+      QCOMPARE(data[iMax], max);
+    }
+  }
+
+  // appended samples are taken in by the update
+  v->resize(6000);
+  data = v->value();
+  data[5500] = -1;
+  v->internalUpdate();
+  index = v->minMaxIndex();
+  int iMin = -1, iMax = -1;
+  QVERIFY(index->extremes(*v, 4000, 5999, iMin, iMax));
+  QCOMPARE(iMin, 5500);
+  v->unlock();
+}
+
+// A run of samples at once, against one at a time.
+void TestVector::testBatchInterpolation()
+{
+  Kst::VectorPtr v = Kst::kst_cast<Kst::Vector>(_store.createObject<Kst::Vector>());
+  v->resize(37);
+  double *data = v->value();
+  for (int i = 0; i < v->length(); ++i) {
+    data[i] = i * i * 0.25;
+  }
+  data[20] = NAN;
+
+  const int lengths[] = {1, 10, 37, 100, 1000};
+  double out[1100];
+  for (unsigned l = 0; l < sizeof(lengths)/sizeof(lengths[0]); ++l) {
+    const int ns = lengths[l];
+    v->interpolate(-3, ns + 6, ns, out);
+    for (int i = -3; i < ns + 3; ++i) {
+      const double one = v->interpolate(i, ns);
+      QVERIFY(out[i + 3] == one || (one != one && out[i + 3] != out[i + 3]));
+    }
+  }
+
+  // nothing to interpolate: straight from the vector
+  QVERIFY(v->interpolated(5, 10, 37, out) == data + 5);
+  QVERIFY(v->interpolated(5, 10, 74, out) == out);
+}
+
+void TestVector::benchmarkStatistics_data()
+{
+  QTest::addColumn<int>("kernel");
+  QTest::newRow("scalar") << int(Kst::RunningStatistics::Scalar);
+  QTest::newRow("sse2") << int(Kst::RunningStatistics::SSE2);
+  QTest::newRow("avx2") << int(Kst::RunningStatistics::AVX2);
+}
+
+// Throughput of the statistics pass over 128 MB of doubles.
+void TestVector::benchmarkStatistics()
+{
+  QFETCH(int, kernel);
+
+  const Kst::RunningStatistics::Kernel best = Kst::RunningStatistics::kernel();
+  if (!Kst::RunningStatistics::setKernel(Kst::RunningStatistics::Kernel(kernel))) {
+    qDebug() << Kst::RunningStatistics::kernelName(Kst::RunningStatistics::Kernel(kernel)) << "is not supported here";
+    return;
+  }
+
+  const int count = 16 * 1024 * 1024;
+  QVector<double> data(count);
+  for (int i = 0; i < count; ++i) {
+    data[i] = sin(i * 0.001);
+  }
+
+  qint64 nsecs = 0;
+  int passes = 0;
+  QBENCHMARK {
+    QElapsedTimer timer;
+    timer.start();
+    Kst::RunningStatistics stats;
+    stats.add(data.constData(), count);
+    nsecs += timer.nsecsElapsed();
+    ++passes;
+  }
+
+  const double gigabytes = double(count) * sizeof(double) * passes / 1.0e9;
+  qDebug() << Kst::RunningStatistics::kernelName(Kst::RunningStatistics::Kernel(kernel))
+           << gigabytes / (nsecs / 1.0e9) << "GB/s";
+
+  Kst::RunningStatistics::setKernel(best);
+}
+
 #ifdef KST_USE_QTEST_MAIN
 QTEST_MAIN(TestVector)
 #endif
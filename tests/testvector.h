@@ -21,6 +21,27 @@ class TestVector : public QObject
     void cleanupTestCase();
 
     void testVector();
+    void testSnapshot();
+
+    void testSnapshotRefresh();
+
+    void testAppendedStatistics();
+
+    void testStatisticsKernels();
+
+    void testScrolling();
+
+    void testFloat32Storage();
+
+    void testMappedStorage();
+    void testBufferPool();
+
+    void testMinMaxIndex();
+
+    void testBatchInterpolation();
+
+    void benchmarkStatistics_data();
+    void benchmarkStatistics();
 };
 
 #endif